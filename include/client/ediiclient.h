@@ -0,0 +1,148 @@
+#ifndef ECHMET_EDII_CLIENT_H
+#define ECHMET_EDII_CLIENT_H
+
+#include "ediiclient_global.h"
+
+#include <QFuture>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+namespace edii {
+
+/*!
+ * Priority class of a load, see <tt>EDII_IPCSockLoadPriority</tt>.
+ */
+enum class Priority : int {
+  INTERACTIVE = 0,
+  BATCH = 1,
+  BACKGROUND = 2
+};
+
+/*!
+ * Description of a trace.
+ */
+class EDIICLIENTSHARED_EXPORT TraceInfo {
+public:
+  QString name;
+  QString dataId;
+  QString path;
+  QString xDescription;
+  QString yDescription;
+  QString xUnit;
+  QString yUnit;
+  qint64 datapoints;        /*!< Number of X and Y values */
+};
+
+/*!
+ * Trace with its values stored in columns.
+ */
+class EDIICLIENTSHARED_EXPORT Trace : public TraceInfo {
+public:
+  QVector<double> xValues;  /*!< Traces of one load with identical X values share the data */
+  QVector<double> yValues;
+};
+
+/*!
+ * Receives values of traces straight into buffers owned by the caller.
+ * The sink is called from a thread of the client.
+ */
+class EDIICLIENTSHARED_EXPORT TraceSink {
+public:
+  virtual ~TraceSink();
+
+  /*!
+   * \brief Called for each trace before its values are read.
+   * \param index Index of the trace in the load.
+   * \param info Description of the trace.
+   * \param xValues Set to a buffer for <tt>info.datapoints</tt> X values or leave null to skip them.
+   * \param yValues Set to a buffer for <tt>info.datapoints</tt> Y values or leave null to skip them.
+   * \return False to abort the load.
+   */
+  virtual bool beginTrace(const int index, const TraceInfo &info, double *&xValues, double *&yValues) = 0;
+};
+
+/*!
+ * Load of a file.
+ */
+class EDIICLIENTSHARED_EXPORT LoadRequest {
+public:
+  LoadRequest();
+  LoadRequest(const QString &tag, const QString &path, const int loadOption = 0, const Priority priority = Priority::INTERACTIVE);
+
+  QString tag;              /*!< Tag of the plugin that reads the file */
+  QString path;
+  int loadOption;
+  Priority priority;
+};
+
+class EDIICLIENTSHARED_EXPORT LoadResult {
+public:
+  LoadResult();
+
+  bool ok;
+  QString error;
+  QVector<Trace> traces;    /*!< Values are left empty when they were passed to a <tt>TraceSink</tt> */
+};
+
+class EDIICLIENTSHARED_EXPORT ClientOptions {
+public:
+  ClientOptions();
+
+  QString serverName;       /*!< Name of the local socket EDII listens on */
+  int connections;          /*!< Number of persistent connections and of loads handled at the same time */
+  int timeout;              /*!< Milliseconds to wait for the server before a load fails */
+  int busyRetries;          /*!< Number of times a load refused by a busy server is sent again */
+  bool sharedMemory;        /*!< Receive values through sealed memory files where supported, each such load makes a connection of its own */
+};
+
+/*!
+ * Client of the local socket interface of EDII.
+ *
+ * Loads are handed to a pool of persistent connections and run in the
+ * background, their results are delivered through futures. The client picks
+ * the transfer by what the server reports when a connection is made: values
+ * are streamed in 64-bit frames with shared axes, servers older than ABI
+ * 0.14 send them as plain datapoints and servers older than ABI 0.8, which
+ * cannot keep connections open, get a connection for each load. Loads
+ * refused by a busy server are sent again after the delay the server asks for.
+ *
+ * Connections are made lazily. The client may be used from any thread.
+ */
+class EDIICLIENTSHARED_EXPORT Client {
+public:
+  explicit Client(const ClientOptions &options = ClientOptions{});
+  ~Client();
+
+  Client(const Client &other) = delete;
+  Client & operator=(const Client &other) = delete;
+
+  /*!
+   * \brief Loads a file into columns.
+   */
+  QFuture<LoadResult> loadPath(const LoadRequest &request);
+
+  /*!
+   * \brief Loads a file and writes the values into buffers provided by the sink.
+   *
+   * The sink must outlive the load.
+   */
+  QFuture<LoadResult> loadPath(const LoadRequest &request, TraceSink *sink);
+
+  /*!
+   * \brief Loads several files in parallel.
+   *
+   * The future has one result per request, result \p i belongs to request \p i
+   * and is available as soon as that load finishes.
+   */
+  QFuture<LoadResult> loadBatch(const QVector<LoadRequest> &requests);
+
+private:
+  class Private;
+
+  std::unique_ptr<Private> d;
+};
+
+} // namespace edii
+
+#endif // ECHMET_EDII_CLIENT_H
@@ -0,0 +1,12 @@
+#ifndef ECHMET_EDII_CLIENT_GLOBAL_H
+#define ECHMET_EDII_CLIENT_GLOBAL_H
+
+#include <QtCore/qglobal.h>
+
+#if defined(EDIICLIENT_LIBRARY)
+#  define EDIICLIENTSHARED_EXPORT Q_DECL_EXPORT
+#else
+#  define EDIICLIENTSHARED_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif // ECHMET_EDII_CLIENT_GLOBAL_H
@@ -0,0 +1,322 @@
+#ifndef ECHMET_EDII_IPC_CODEC_H
+#define ECHMET_EDII_IPC_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*!
+ * Lossless compression of sample arrays used by EDII_IPCS_LOAD_FLAG_COMPRESSED.
+ * The encoders are used by EDII and the decoders are meant for clients.
+ *
+ * EDII_IPCS_CODEC_DOD_XOR:
+ *   X values are stored as delta-of-delta of their IEEE 754 bit patterns.
+ *   Bit patterns of increasing positive doubles grow almost linearly so a
+ *   uniform time axis costs only a few bits per value. Y values are stored as
+ *   XOR of consecutive bit patterns with the leading and trailing zero bits
+ *   left out, which suits slowly changing detector signals. Both streams
+ *   start with the first value verbatim, are written most significant bit
+ *   first and are padded to a whole byte.
+ *
+ * Encoding of delta-of-delta d as z = zigzag(d):
+ *   '0' for z = 0, '10' + 7 bits, '110' + 9 bits, '1110' + 12 bits,
+ *   '11110' + 32 bits and '11111' + 64 bits of z.
+ *
+ * Encoding of XOR x of consecutive values:
+ *   '0' for x = 0, '10' + meaningful bits of x within the previous window,
+ *   '11' + 5 bits of leading zeros + 6 bits of length of the meaningful bits
+ *   (0 stands for 64) + the meaningful bits.
+ */
+enum EDII_IPCSockCodec {
+  EDII_IPCS_CODEC_DOD_XOR = 0x1
+};
+
+#define EDII_CODEC_ERROR ((size_t)-1)
+
+typedef struct {
+  uint8_t *data;
+  size_t pos;
+} EDII_CodecBitWriter;
+
+typedef struct {
+  const uint8_t *data;
+  size_t length;
+  size_t pos;
+  int failed;
+} EDII_CodecBitReader;
+
+/*!
+ * Largest possible size in bytes of one encoded stream of count values.
+ */
+static inline size_t edii_codec_bound(const uint32_t count)
+{
+  return ((size_t)count * 77 + 7) / 8;
+}
+
+static inline uint64_t edii_codec_bits_of(const double v)
+{
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+static inline double edii_codec_double_of(const uint64_t bits)
+{
+  double v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+static inline int edii_codec_clz(const uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+  while (!(x & (UINT64_C(1) << (63 - n))))
+    n++;
+  return n;
+#endif
+}
+
+static inline int edii_codec_ctz(const uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+  while (!(x & (UINT64_C(1) << n)))
+    n++;
+  return n;
+#endif
+}
+
+static inline void edii_codec_put(EDII_CodecBitWriter *w, const uint64_t value, int bits)
+{
+  while (bits > 0) {
+    const size_t byte = w->pos >> 3;
+    const int room = 8 - (int)(w->pos & 7);
+    const int n = bits < room ? bits : room;
+    const uint8_t chunk = (uint8_t)((value >> (bits - n)) & ((1u << n) - 1));
+
+    if (room == 8)
+      w->data[byte] = 0;
+    w->data[byte] |= (uint8_t)(chunk << (room - n));
+    w->pos += n;
+    bits -= n;
+  }
+}
+
+static inline uint64_t edii_codec_get(EDII_CodecBitReader *r, int bits)
+{
+  uint64_t value = 0;
+
+  if (r->failed || r->pos + bits > r->length * 8) {
+    r->failed = 1;
+    return 0;
+  }
+
+  while (bits > 0) {
+    const int avail = 8 - (int)(r->pos & 7);
+    const int n = bits < avail ? bits : avail;
+    const uint8_t b = r->data[r->pos >> 3];
+
+    value = (value << n) | ((uint64_t)(b >> (avail - n)) & ((1u << n) - 1));
+    r->pos += n;
+    bits -= n;
+  }
+
+  return value;
+}
+
+/*!
+ * Encodes count values as delta-of-delta into out that has room for at least
+ * edii_codec_bound(count) bytes. Returns the number of bytes written.
+ */
+static inline size_t edii_codec_encode_dod(const double *values, const uint32_t count, uint8_t *out)
+{
+  EDII_CodecBitWriter w = { out, 0 };
+  uint64_t prev = 0;
+  uint64_t prevDelta = 0;
+  uint32_t idx;
+
+  for (idx = 0; idx < count; idx++) {
+    const uint64_t bits = edii_codec_bits_of(values[idx]);
+
+    if (idx == 0) {
+      edii_codec_put(&w, bits, 64);
+    } else {
+      const uint64_t delta = bits - prev;
+      const uint64_t dod = delta - prevDelta;
+      const uint64_t z = (dod << 1) ^ (0 - (dod >> 63));
+
+      if (z == 0)
+        edii_codec_put(&w, 0x0, 1);
+      else if (z < (UINT64_C(1) << 7))
+        edii_codec_put(&w, (UINT64_C(0x2) << 7) | z, 2 + 7);
+      else if (z < (UINT64_C(1) << 9))
+        edii_codec_put(&w, (UINT64_C(0x6) << 9) | z, 3 + 9);
+      else if (z < (UINT64_C(1) << 12))
+        edii_codec_put(&w, (UINT64_C(0xE) << 12) | z, 4 + 12);
+      else if (z < (UINT64_C(1) << 32))
+        edii_codec_put(&w, (UINT64_C(0x1E) << 32) | z, 5 + 32);
+      else {
+        edii_codec_put(&w, 0x1F, 5);
+        edii_codec_put(&w, z, 64);
+      }
+
+      prevDelta = delta;
+    }
+
+    prev = bits;
+  }
+
+  return (w.pos + 7) / 8;
+}
+
+/*!
+ * Encodes count values as XOR of consecutive values into out that has room for
+ * at least edii_codec_bound(count) bytes. Returns the number of bytes written.
+ */
+static inline size_t edii_codec_encode_xor(const double *values, const uint32_t count, uint8_t *out)
+{
+  EDII_CodecBitWriter w = { out, 0 };
+  uint64_t prev = 0;
+  int prevLead = -1;
+  int prevTrail = 0;
+  uint32_t idx;
+
+  for (idx = 0; idx < count; idx++) {
+    const uint64_t bits = edii_codec_bits_of(values[idx]);
+
+    if (idx == 0) {
+      edii_codec_put(&w, bits, 64);
+    } else {
+      const uint64_t x = bits ^ prev;
+
+      if (x == 0) {
+        edii_codec_put(&w, 0x0, 1);
+      } else {
+        int lead = edii_codec_clz(x);
+        const int trail = edii_codec_ctz(x);
+
+        if (lead > 31)
+          lead = 31;
+
+        if (prevLead >= 0 && lead >= prevLead && trail >= prevTrail) {
+          edii_codec_put(&w, 0x2, 2);
+          edii_codec_put(&w, x >> prevTrail, 64 - prevLead - prevTrail);
+        } else {
+          const int significant = 64 - lead - trail;
+
+          edii_codec_put(&w, 0x3, 2);
+          edii_codec_put(&w, (uint64_t)lead, 5);
+          edii_codec_put(&w, (uint64_t)(significant & 0x3F), 6);
+          edii_codec_put(&w, x >> trail, significant);
+
+          prevLead = lead;
+          prevTrail = trail;
+        }
+      }
+    }
+
+    prev = bits;
+  }
+
+  return (w.pos + 7) / 8;
+}
+
+/*!
+ * Decodes count values encoded by edii_codec_encode_dod(). Returns the number
+ * of bytes consumed or EDII_CODEC_ERROR if the input is malformed or too short.
+ */
+static inline size_t edii_codec_decode_dod(const uint8_t *in, const size_t length, double *values, const uint32_t count)
+{
+  EDII_CodecBitReader r = { in, length, 0, 0 };
+  uint64_t prev = 0;
+  uint64_t delta = 0;
+  uint32_t idx;
+
+  for (idx = 0; idx < count; idx++) {
+    uint64_t bits;
+
+    if (idx == 0) {
+      bits = edii_codec_get(&r, 64);
+    } else {
+      uint64_t z;
+
+      if (edii_codec_get(&r, 1) == 0)
+        z = 0;
+      else if (edii_codec_get(&r, 1) == 0)
+        z = edii_codec_get(&r, 7);
+      else if (edii_codec_get(&r, 1) == 0)
+        z = edii_codec_get(&r, 9);
+      else if (edii_codec_get(&r, 1) == 0)
+        z = edii_codec_get(&r, 12);
+      else if (edii_codec_get(&r, 1) == 0)
+        z = edii_codec_get(&r, 32);
+      else
+        z = edii_codec_get(&r, 64);
+
+      delta += (z >> 1) ^ (0 - (z & 1));
+      bits = prev + delta;
+    }
+
+    if (r.failed)
+      return EDII_CODEC_ERROR;
+
+    values[idx] = edii_codec_double_of(bits);
+    prev = bits;
+  }
+
+  return (r.pos + 7) / 8;
+}
+
+/*!
+ * Decodes count values encoded by edii_codec_encode_xor(). Returns the number
+ * of bytes consumed or EDII_CODEC_ERROR if the input is malformed or too short.
+ */
+static inline size_t edii_codec_decode_xor(const uint8_t *in, const size_t length, double *values, const uint32_t count)
+{
+  EDII_CodecBitReader r = { in, length, 0, 0 };
+  uint64_t prev = 0;
+  int prevLead = -1;
+  int prevTrail = 0;
+  uint32_t idx;
+
+  for (idx = 0; idx < count; idx++) {
+    uint64_t bits;
+
+    if (idx == 0) {
+      bits = edii_codec_get(&r, 64);
+    } else if (edii_codec_get(&r, 1) == 0) {
+      bits = prev;
+    } else if (edii_codec_get(&r, 1) == 0) {
+      if (prevLead < 0)
+        return EDII_CODEC_ERROR;
+      bits = prev ^ (edii_codec_get(&r, 64 - prevLead - prevTrail) << prevTrail);
+    } else {
+      const int lead = (int)edii_codec_get(&r, 5);
+      int significant = (int)edii_codec_get(&r, 6);
+
+      if (significant == 0)
+        significant = 64;
+      if (lead + significant > 64)
+        return EDII_CODEC_ERROR;
+
+      prevLead = lead;
+      prevTrail = 64 - lead - significant;
+      bits = prev ^ (edii_codec_get(&r, significant) << prevTrail);
+    }
+
+    if (r.failed)
+      return EDII_CODEC_ERROR;
+
+    values[idx] = edii_codec_double_of(bits);
+    prev = bits;
+  }
+
+  return (r.pos + 7) / 8;
+}
+
+#endif // ECHMET_EDII_IPC_CODEC_H
@@ -2,6 +2,6 @@
 #define ECHMET_EDII_IPC_COMMON_H
 
 static const int EDII_ABI_VERSION_MAJOR = 0;
-static const int EDII_ABI_VERSION_MINOR = 1;
+static const int EDII_ABI_VERSION_MINOR = 18;
 
 #endif // ECHMET_EDII_IPC_COMMON_H
@@ -16,17 +16,33 @@
 #define EDII_IPCS_SOCKET_NAME "echmet_edii_socket"
 
 static const uint16_t EDII_IPCS_PACKET_MAGIC = 0x091E;
+static const uint16_t EDII_IPCS_FRAME_MAGIC = 0x092E;
 
 enum EDII_IPCSockRequestType {
   EDII_REQUEST_SUPPORTED_FORMATS = 0x1,
   EDII_REQUEST_LOAD_DATA = 0x2,
   EDII_REQUEST_LOAD_DATA_DESCRIPTOR = 0x3,
-  EDII_REQUEST_ABI_VERSION = 0x4
+  EDII_REQUEST_ABI_VERSION = 0x4,
+  EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT = 0x5,
+  EDII_REQUEST_STATS = 0x6,
+  EDII_REQUEST_FLUSH_TRACE = 0x7,
+  EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL = 0x8,
+  EDII_REQUEST_CATALOG_QUERY = 0x9,
+  EDII_REQUEST_CATALOG_QUERY_DESCRIPTOR = 0xA,
+  EDII_REQUEST_ABI_VERSION_EXT = 0xB,
+  EDII_REQUEST_ABI_VERSION_DESCRIPTOR = 0xC,
+  EDII_REQUEST_SUBSCRIBE = 0xD,
+  EDII_REQUEST_SUBSCRIBE_DESCRIPTOR = 0xE,
+  EDII_REQUEST_UNSUBSCRIBE = 0xF,
+  EDII_REQUEST_UNSUBSCRIBE_DESCRIPTOR = 0x10,
+  EDII_REQUEST_LOAD_BATCH = 0x11,
+  EDII_REQUEST_LOAD_BATCH_DESCRIPTOR = 0x12
 };
 
 enum EDII_IPCSockResult {
   EDII_IPCS_SUCCESS = 0x1,
-  EDII_IPCS_FAILURE = 0x2
+  EDII_IPCS_FAILURE = 0x2,
+  EDII_IPCS_BUSY = 0x3
 };
 
 enum EDII_IPCSockResponseType {
@@ -35,7 +51,22 @@ enum EDII_IPCSockResponseType {
   EDII_RESPONSE_SUPPORTED_FORMAT_DESCRIPTOR = 0x3,
   EDII_RESPONSE_LOAD_DATA_DESCRIPTOR = 0x4,
   EDII_RESPONSE_LOAD_OPTION_DESCRIPTOR = 0x5,
-  EDII_RESPONSE_ABI_VERSION = 0x6
+  EDII_RESPONSE_ABI_VERSION = 0x6,
+  EDII_RESPONSE_AXIS_DESCRIPTOR = 0x7,
+  EDII_RESPONSE_STATS = 0x8,
+  EDII_RESPONSE_FLUSH_TRACE = 0x9,
+  EDII_RESPONSE_TAIL_CURSOR = 0xA,
+  EDII_RESPONSE_CATALOG_QUERY = 0xB,
+  EDII_RESPONSE_ABI_VERSION_EXT = 0xC,
+  EDII_RESPONSE_SHARED_MEMORY = 0xD,
+  EDII_RESPONSE_SHARED_MEMORY_TRACE = 0xE,
+  EDII_RESPONSE_COMPRESSED_VALUES = 0xF,
+  EDII_RESPONSE_COMPACT_VALUES = 0x10,
+  EDII_RESPONSE_BUSY = 0x11,
+  EDII_RESPONSE_SUBSCRIPTION = 0x12,
+  EDII_RESPONSE_CHANGE_NOTIFICATION = 0x13,
+  EDII_RESPONSE_LOAD_BATCH_HEADER = 0x14,
+  EDII_RESPONSE_LOAD_BATCH_RESULT = 0x15
 };
 
 enum EDII_IPCSocketLoadDataMode {
@@ -44,6 +75,207 @@ enum EDII_IPCSocketLoadDataMode {
   EDII_IPCS_LOAD_FILE = 0x3
 };
 
+/*
+ * Flags that modify the layout of the load data response.
+ * Flags are passed in the extended load data request descriptor.
+ *
+ * EDII_IPCS_LOAD_FLAG_SHARED_AXES:
+ *   Each load data response descriptor is preceded by an axis descriptor.
+ *   The axis descriptor is followed by valuesLength doubles with the X values
+ *   when the axis is sent for the first time in the response. Subsequent traces
+ *   that use the same axis get an axis descriptor with the same axisId and zero
+ *   valuesLength. The datapoints payload of the load data response descriptor
+ *   contains only datapointsLength doubles with the Y values.
+ *
+ * EDII_IPCS_LOAD_FLAG_SHARED_MEMORY:
+ *   The values are not sent through the socket but placed in a sealed memory
+ *   file whose descriptor is passed to the client as SCM_RIGHTS ancillary data.
+ *   The descriptor is attached to the first byte of the load data response
+ *   header so the client shall receive the response with recvmsg(). When the
+ *   server honours the flag, the header is followed by
+ *   EDII_IPCSockSharedMemoryDescriptor (ahead of the tail cursor descriptor of
+ *   incremental loads) and each load data response descriptor
+ *   and its strings are followed by EDII_IPCSockSharedMemoryTraceDescriptor
+ *   instead of the datapoints. EDII_IPCS_LOAD_FLAG_SHARED_AXES has no effect.
+ *   The server ignores the flag on persistent connections and on platforms
+ *   without sealed memory files, the client tells by the responseType of the
+ *   item that follows the header.
+ *
+ * EDII_IPCS_LOAD_FLAG_COMPRESSED:
+ *   Values are sent compressed by one of the codecs in edii_ipc_codec.h. The
+ *   datapoints payload is replaced by EDII_IPCSockCompressedValuesDescriptor
+ *   followed by compressedLength bytes that hold the encoded X values and
+ *   then the encoded Y values of the trace. With EDII_IPCS_LOAD_FLAG_SHARED_AXES
+ *   the X values of an axis descriptor and the Y values of a trace are each
+ *   sent as their own compressed block. Servers that grant
+ *   EDII_IPCS_CAP_COMPRESSION honour the flag unless values are passed
+ *   through shared memory.
+ *
+ * EDII_IPCS_LOAD_FLAG_COMPACT:
+ *   Values are sent in the smallest of the encodings in EDII_IPCSockXEncoding
+ *   and EDII_IPCSockYEncoding that reproduces them exactly. The datapoints
+ *   payload is replaced by EDII_IPCSockCompactValuesDescriptor followed by
+ *   the X values, if the X encoding carries any, and then by the Y values.
+ *   The flag has no effect together with EDII_IPCS_LOAD_FLAG_SHARED_MEMORY
+ *   or EDII_IPCS_LOAD_FLAG_COMPRESSED.
+ *
+ * EDII_IPCS_LOAD_FLAG_FRAMING_V2:
+ *   The response is sent as a sequence of frames described at
+ *   EDII_IPCSockFrame instead of the items above. The frames use 64-bit
+ *   lengths so traces are not limited to 4 G datapoints.
+ *   EDII_IPCS_LOAD_FLAG_SHARED_AXES is honoured, the other flags have no
+ *   effect. Errors found in the request are reported with frames too.
+ */
+enum EDII_IPCSockLoadDataFlags {
+  EDII_IPCS_LOAD_FLAG_SHARED_AXES = 0x1,
+  EDII_IPCS_LOAD_FLAG_SHARED_MEMORY = 0x2,
+  EDII_IPCS_LOAD_FLAG_COMPRESSED = 0x4,
+  EDII_IPCS_LOAD_FLAG_COMPACT = 0x8,
+  EDII_IPCS_LOAD_FLAG_FRAMING_V2 = 0x10
+};
+
+/*
+ * EDII_IPCS_X_DOUBLE:
+ *   datapointsLength doubles follow.
+ * EDII_IPCS_X_UNIFORM:
+ *   No values follow. X value i is t0 + i * dt evaluated in double precision.
+ * EDII_IPCS_X_UNIFORM_FLOAT:
+ *   No values follow. X value i is (float)t0 + (float)i * (float)dt evaluated
+ *   in single precision and widened to double.
+ * EDII_IPCS_X_AXIS:
+ *   No values follow, the X values were sent with the preceding axis descriptor.
+ *
+ * Uniform grids shall be evaluated without fused multiply-add.
+ */
+enum EDII_IPCSockXEncoding {
+  EDII_IPCS_X_DOUBLE = 0x1,
+  EDII_IPCS_X_UNIFORM = 0x2,
+  EDII_IPCS_X_UNIFORM_FLOAT = 0x3,
+  EDII_IPCS_X_AXIS = 0x4
+};
+
+/*
+ * EDII_IPCS_Y_DOUBLE:
+ *   datapointsLength doubles follow.
+ * EDII_IPCS_Y_FLOAT:
+ *   datapointsLength floats follow.
+ * EDII_IPCS_Y_SCALED_INT32:
+ *   datapointsLength int32_t samples follow, Y value i is sample i * yScale
+ *   evaluated in double precision.
+ */
+enum EDII_IPCSockYEncoding {
+  EDII_IPCS_Y_DOUBLE = 0x1,
+  EDII_IPCS_Y_FLOAT = 0x2,
+  EDII_IPCS_Y_SCALED_INT32 = 0x3
+};
+
+/*
+ * Priority class of a load request is stored in bits 8 - 9 of the flags
+ * field of the extended load data request descriptor. Requests that do not
+ * specify a priority class are treated as interactive.
+ */
+#define EDII_IPCS_LOAD_PRIORITY_SHIFT 8
+#define EDII_IPCS_LOAD_PRIORITY_MASK (0x3 << EDII_IPCS_LOAD_PRIORITY_SHIFT)
+
+enum EDII_IPCSockLoadPriority {
+  EDII_IPCS_PRIORITY_INTERACTIVE = 0x0,
+  EDII_IPCS_PRIORITY_BATCH = 0x1,
+  EDII_IPCS_PRIORITY_BACKGROUND = 0x2
+};
+
+/*
+ * Optional features of the protocol. A client asks for features with
+ * EDII_REQUEST_ABI_VERSION_EXT and the response tells which of them were granted.
+ *
+ * EDII_IPCS_CAP_PERSISTENT:
+ *   The connection stays open after the response to EDII_REQUEST_ABI_VERSION_EXT
+ *   and carries any number of requests. Each request is sent as
+ *   EDII_IPCSockEnvelope of type EDII_ENVELOPE_REQUEST followed by length bytes
+ *   that contain the request exactly as it would be sent on its own connection
+ *   (request header, descriptors and payload). Every request is answered with
+ *   EDII_IPCSockEnvelope of type EDII_ENVELOPE_RESPONSE that carries the same
+ *   requestId and is followed by length bytes of the usual response. Requests
+ *   are handled concurrently, responses are sent as soon as they are ready and
+ *   may come in a different order than the requests. Requests that cannot be
+ *   read are answered with status EDII_IPCS_FAILURE and possibly an empty body.
+ *   The server closes the connection when it receives a malformed envelope.
+ *
+ * EDII_IPCS_CAP_STREAMING:
+ *   Granted only together with EDII_IPCS_CAP_PERSISTENT. Responses are sent
+ *   in parts as they are serialized instead of all at once. Each part comes
+ *   in an envelope of type EDII_ENVELOPE_RESPONSE_PART and the last part in
+ *   an envelope of type EDII_ENVELOPE_RESPONSE, all with the requestId of the
+ *   request. The response is the concatenation of the parts. Parts of
+ *   different responses may interleave. The server stops serializing
+ *   responses while the client has not read the configured send window.
+ *
+ * EDII_IPCS_CAP_COMPRESSION:
+ *   The server understands EDII_IPCS_LOAD_FLAG_COMPRESSED. The capability may
+ *   be asked for on a connection that is not persistent just to learn whether
+ *   the server supports it.
+ *
+ * EDII_IPCS_CAP_SUBSCRIPTIONS:
+ *   Granted only together with EDII_IPCS_CAP_PERSISTENT. The client may
+ *   subscribe to changes of files with EDII_REQUEST_SUBSCRIBE. Each change
+ *   is pushed in an envelope of type EDII_ENVELOPE_NOTIFICATION whose
+ *   requestId is the subscriptionId and which is followed by
+ *   EDII_IPCSockChangeNotification. Notifications are never sent in parts.
+ */
+enum EDII_IPCSockCapabilities {
+  EDII_IPCS_CAP_PERSISTENT = 0x1,
+  EDII_IPCS_CAP_STREAMING = 0x2,
+  EDII_IPCS_CAP_COMPRESSION = 0x4,
+  EDII_IPCS_CAP_SUBSCRIPTIONS = 0x8
+};
+
+enum EDII_IPCSockEnvelopeType {
+  EDII_ENVELOPE_REQUEST = 0x1,
+  EDII_ENVELOPE_RESPONSE = 0x2,
+  EDII_ENVELOPE_RESPONSE_PART = 0x3,
+  EDII_ENVELOPE_NOTIFICATION = 0x4
+};
+
+/*
+ * EDII_IPCS_SUBSCRIBE_FLAG_DATA:
+ *   Notifications carry the datapoints appended since the previous
+ *   notification. The file is read incrementally as described at
+ *   EDII_IPCSockLoadDataRequestDescriptorTail, so the format must support
+ *   unattended loading.
+ */
+enum EDII_IPCSockSubscribeFlags {
+  EDII_IPCS_SUBSCRIBE_FLAG_DATA = 0x1
+};
+
+/*
+ * EDII_IPCS_CHANGE_FLAG_REMOVED:
+ *   The file was removed or renamed. The subscription stays, another
+ *   notification follows when a file appears at the path again.
+ * EDII_IPCS_CHANGE_FLAG_DATA:
+ *   The notification is followed by a load data response.
+ */
+enum EDII_IPCSockChangeFlags {
+  EDII_IPCS_CHANGE_FLAG_REMOVED = 0x1,
+  EDII_IPCS_CHANGE_FLAG_DATA = 0x2
+};
+
+/*
+ * length is the number of bytes of the message that follows the envelope,
+ * so one envelope carries at most 4 GiB - 1 bytes. Longer responses are
+ * sent in EDII_ENVELOPE_RESPONSE_PART envelopes on connections that were
+ * granted EDII_IPCS_CAP_STREAMING. On other connections such a response is
+ * replaced by an EDII_ENVELOPE_RESPONSE with status EDII_IPCS_FAILURE and
+ * no message; clients that load large files shall request streaming.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockEnvelope {
+  uint16_t magic;
+  uint8_t envelopeType;
+  uint8_t status;                       /* Unused in requests */
+
+  uint32_t requestId;                   /* Chosen by the client */
+  uint32_t length;
+};
+EDII_PACKED_STRUCT_END
+
 EDII_PACKED_STRUCT_BEGIN EDII_IPCSockRequestHeader {
   uint16_t magic;
   uint8_t requestType;
@@ -71,6 +303,131 @@ EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadDataRequestDescriptor {
 };
 EDII_PACKED_STRUCT_END
 
+/*
+ * Sent instead of EDII_IPCSockLoadDataRequestDescriptor by clients that want
+ * to pass additional flags. requestType shall be EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadDataRequestDescriptorExt {
+  uint16_t magic;
+  uint8_t requestType;
+  uint8_t mode;
+
+  int32_t loadOption;
+  uint32_t tagLength;
+  uint32_t filePathLength;
+
+  uint32_t flags;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Sent instead of EDII_IPCSockLoadDataRequestDescriptor by clients that read
+ * a file that is still being written. requestType shall be
+ * EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL and mode shall be EDII_IPCS_LOAD_FILE.
+ *
+ * cursor is zero for the first request for a file and the cursor returned
+ * by the previous response afterwards. Successful load data response header
+ * is followed by EDII_IPCSockTailCursorDescriptor and then by the usual items
+ * that contain only the datapoints appended since the cursor.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadDataRequestDescriptorTail {
+  uint16_t magic;
+  uint8_t requestType;
+  uint8_t mode;
+
+  int32_t loadOption;
+  uint32_t tagLength;
+  uint32_t filePathLength;
+
+  uint32_t flags;
+  uint64_t cursor;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Follows the request header of EDII_REQUEST_LOAD_BATCH. requestType shall be
+ * EDII_REQUEST_LOAD_BATCH_DESCRIPTOR. The descriptor is followed by
+ * entriesLength bytes that hold entries times
+ * EDII_IPCSockLoadBatchEntryDescriptor, each followed by its format tag
+ * and path. flags apply to every entry as in
+ * EDII_IPCSockLoadDataRequestDescriptorExt, EDII_IPCS_LOAD_FLAG_SHARED_MEMORY
+ * has no effect.
+ *
+ * The response starts with EDII_IPCSockResponseHeader of type
+ * EDII_RESPONSE_LOAD_BATCH_HEADER. If the batch was accepted, items is the
+ * number of entries and the header is followed by one
+ * EDII_IPCSockLoadBatchResultDescriptor per entry in the order in which the
+ * loads finish. Otherwise the header is followed by the error message.
+ * Entries are loaded in parallel, a persistent connection with
+ * EDII_IPCS_CAP_STREAMING and a connection that is not persistent get each
+ * result as soon as it is ready.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadBatchRequestDescriptor {
+  uint16_t magic;
+  uint8_t requestType;
+
+  uint32_t flags;
+  uint32_t entries;
+  uint32_t entriesLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * mode shall be EDII_IPCS_LOAD_FILE, loads that need the user are not
+ * batched. The tag and the path are UTF-8 encoded.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadBatchEntryDescriptor {
+  uint8_t mode;
+
+  int32_t loadOption;
+  uint32_t tagLength;
+  uint32_t filePathLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Follows the request header of EDII_REQUEST_SUBSCRIBE. requestType shall be
+ * EDII_REQUEST_SUBSCRIBE_DESCRIPTOR, flags is a combination of
+ * EDII_IPCSockSubscribeFlags. The descriptor is followed by tagLength bytes
+ * of the format tag and filePathLength bytes of the path, both UTF-8 encoded.
+ *
+ * The tag, loadOption, loadFlags and cursor matter only with
+ * EDII_IPCS_SUBSCRIBE_FLAG_DATA. The appended datapoints are read as if the
+ * client sent EDII_IPCSockLoadDataRequestDescriptorTail with these fields,
+ * the first time with the given cursor and then with the cursor of the
+ * previous notification. EDII_IPCS_LOAD_FLAG_SHARED_MEMORY has no effect.
+ *
+ * Changes that come in quick succession are reported together once the file
+ * has been quiet for a while or when it has been changing for too long, see
+ * the configuration of the server.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockSubscribeRequestDescriptor {
+  uint16_t magic;
+  uint8_t requestType;
+  uint8_t flags;
+
+  int32_t loadOption;
+  uint32_t tagLength;
+  uint32_t filePathLength;
+
+  uint32_t loadFlags;
+  uint64_t cursor;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Follows the request header of EDII_REQUEST_UNSUBSCRIBE. requestType shall be
+ * EDII_REQUEST_UNSUBSCRIBE_DESCRIPTOR. Notifications that were already under
+ * way may still arrive after the response.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockUnsubscribeRequestDescriptor {
+  uint16_t magic;
+  uint8_t requestType;
+
+  uint32_t subscriptionId;
+};
+EDII_PACKED_STRUCT_END
+
 EDII_PACKED_STRUCT_BEGIN EDII_IPCSockSupportedFormatResponseDescriptor {
   uint16_t magic;
   uint8_t responseType;
@@ -108,6 +465,190 @@ EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadDataResponseDescriptor {
 };
 EDII_PACKED_STRUCT_END
 
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockAxisDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t axisId;
+  uint32_t valuesLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * EDII_IPCS_TAIL_FLAG_RESET:
+ *   The cursor passed with the request was unknown or the file was truncated
+ *   or replaced. The response contains all data from the beginning of the file
+ *   and the client shall discard the data it has received before.
+ */
+enum EDII_IPCSockTailFlags {
+  EDII_IPCS_TAIL_FLAG_RESET = 0x1
+};
+
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockTailCursorDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t flags;
+  uint64_t cursor;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Describes the memory file passed with a load data response.
+ * size is the size of the file in bytes.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockSharedMemoryDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint64_t size;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Location of the values of one trace in the memory file. Both offsets point
+ * to datapointsLength doubles in native byte order and are aligned to 64 bytes.
+ * Traces with identical X values have the same xOffset.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockSharedMemoryTraceDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint64_t xOffset;
+  uint64_t yOffset;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Precedes a block of compressed values. codec is one of EDII_IPCSockCodec.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockCompressedValuesDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t codec;
+  uint32_t compressedLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * States the encodings of the values of a trace sent with
+ * EDII_IPCS_LOAD_FLAG_COMPACT. t0 and dt are set for uniform X encodings,
+ * yScale for EDII_IPCS_Y_SCALED_INT32.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockCompactValuesDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint8_t xEncoding;
+  uint8_t yEncoding;
+  uint16_t reserved;
+  double t0;
+  double dt;
+  double yScale;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Load data response framing selected by EDII_IPCS_LOAD_FLAG_FRAMING_V2.
+ *
+ * Every frame starts with EDII_IPCSockFrame. The header is followed by length
+ * bytes of payload and by zero padding up to the next multiple of 8 bytes.
+ * Frames therefore start at multiples of 8 bytes from the start of the
+ * response and arrays of values can be read straight into their final,
+ * aligned buffers. Readers shall skip frames of unknown types. Descriptors
+ * in payloads start with their own length so that fields added later can be
+ * skipped as well.
+ *
+ * A response consists of
+ *   EDII_FRAME_LOAD_DATA_HEADER, or EDII_FRAME_ERROR with the UTF-8 encoded
+ *   message and status EDII_IPCS_FAILURE when the load failed,
+ *   EDII_FRAME_TAIL_CURSOR for incremental loads,
+ *   for each trace
+ *     EDII_FRAME_AXIS with the X values if the trace uses an axis that was
+ *     not sent yet, only with EDII_IPCS_LOAD_FLAG_SHARED_AXES,
+ *     EDII_FRAME_TRACE,
+ *     EDII_FRAME_X_VALUES unless the trace refers to an axis,
+ *     EDII_FRAME_Y_VALUES,
+ *   EDII_FRAME_END.
+ *
+ * Values are doubles in native byte order, the number of values is the
+ * payload length divided by 8.
+ */
+enum EDII_IPCSockFrameType {
+  EDII_FRAME_LOAD_DATA_HEADER = 0x1,
+  EDII_FRAME_ERROR = 0x2,
+  EDII_FRAME_TAIL_CURSOR = 0x3,
+  EDII_FRAME_AXIS = 0x4,
+  EDII_FRAME_TRACE = 0x5,
+  EDII_FRAME_X_VALUES = 0x6,
+  EDII_FRAME_Y_VALUES = 0x7,
+  EDII_FRAME_END = 0x8
+};
+
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockFrame {
+  uint16_t magic;                       /* EDII_IPCS_FRAME_MAGIC */
+  uint16_t frameType;
+  uint16_t status;
+  uint16_t reserved;
+
+  uint64_t length;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Payload of EDII_FRAME_LOAD_DATA_HEADER. items is the number of traces.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadDataHeaderV2 {
+  uint32_t descriptorLength;
+  uint32_t reserved;
+
+  uint64_t items;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Payload of EDII_FRAME_TAIL_CURSOR, see EDII_IPCSockTailCursorDescriptor.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockTailCursorV2 {
+  uint32_t descriptorLength;
+  uint32_t flags;
+
+  uint64_t cursor;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Payload of EDII_FRAME_TRACE. The UTF-8 encoded strings follow descriptorLength
+ * bytes from the start of the payload in the order of their lengths. Axes
+ * are numbered from zero in the order they are sent, axisId is
+ * EDII_IPCS_NO_AXIS if the X values of the trace follow in
+ * EDII_FRAME_X_VALUES.
+ */
+static const uint64_t EDII_IPCS_NO_AXIS = UINT64_MAX;
+
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockTraceDescriptorV2 {
+  uint32_t descriptorLength;
+  uint32_t reserved;
+
+  uint64_t datapoints;
+  uint64_t axisId;
+  uint64_t nameLength;
+  uint64_t dataIdLength;
+  uint64_t pathLength;
+  uint64_t xDescriptionLength;
+  uint64_t yDescriptionLength;
+  uint64_t xUnitLength;
+  uint64_t yUnitLength;
+};
+EDII_PACKED_STRUCT_END
+
 EDII_PACKED_STRUCT_BEGIN EDII_IPCSockDatapoint {
   double x;
   double y;
@@ -124,4 +665,160 @@ EDII_PACKED_STRUCT_BEGIN EDII_IPCSockResponseABIVersion {
 };
 EDII_PACKED_STRUCT_END
 
+/*
+ * Follows the request header of EDII_REQUEST_ABI_VERSION_EXT. requestType shall
+ * be EDII_REQUEST_ABI_VERSION_DESCRIPTOR, capabilities is a combination of
+ * EDII_IPCSockCapabilities the client wants to use.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockABIVersionRequestDescriptor {
+  uint16_t magic;
+  uint8_t requestType;
+
+  uint32_t capabilities;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Response to EDII_REQUEST_ABI_VERSION_EXT. capabilities lists the requested
+ * features that the server supports and that are in effect from now on.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockResponseABIVersionExt {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  int32_t major;
+  int32_t minor;
+  uint32_t capabilities;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Sent with status EDII_IPCS_BUSY instead of the response when EDII has too
+ * many requests waiting or the client has too many requests in progress.
+ * The request was not handled and may be sent again after retryAfter
+ * milliseconds. A connection that is not persistent is closed afterwards,
+ * on a persistent connection the envelope of the response has status
+ * EDII_IPCS_BUSY too.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockBusyResponse {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t retryAfter;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Response to EDII_REQUEST_STATS. The descriptor is followed by statsLength
+ * bytes of UTF-8 encoded JSON object with service statistics.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockStatsResponseDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t statsLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Response to EDII_REQUEST_FLUSH_TRACE. The descriptor is followed by
+ * messageLength bytes of UTF-8 encoded text. The text is the path to the
+ * written trace file on success and the error message on failure.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockFlushTraceResponseDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t eventsWritten;
+  uint32_t messageLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Follows the request header of EDII_REQUEST_CATALOG_QUERY. requestType shall be
+ * EDII_REQUEST_CATALOG_QUERY_DESCRIPTOR. The descriptor is followed by queryLength
+ * bytes of UTF-8 encoded query. Zero maxResults returns all matches.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockCatalogQueryRequestDescriptor {
+  uint16_t magic;
+  uint8_t requestType;
+
+  uint32_t maxResults;
+  uint32_t queryLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Response to EDII_REQUEST_CATALOG_QUERY. The descriptor is followed by
+ * resultLength bytes of UTF-8 encoded text. On success the text is a JSON
+ * array of matching files, each an object with "path", "tag", "modified" and
+ * "metadata" members, most recently modified files first. On failure the
+ * text is the error message.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockCatalogQueryResponseDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t matches;
+  uint32_t resultLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Result of one entry of EDII_REQUEST_LOAD_BATCH. entry is the index of the
+ * entry in the request. The descriptor is followed by length bytes of the
+ * load data response exactly as it would be sent for the entry alone, the
+ * outcome of the load is reported there. status is EDII_IPCS_FAILURE and
+ * length may be zero only if the entry could not be handled at all.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockLoadBatchResultDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t entry;
+  uint64_t length;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Response to EDII_REQUEST_SUBSCRIBE and EDII_REQUEST_UNSUBSCRIBE. The
+ * descriptor is followed by errorLength bytes of UTF-8 encoded error message.
+ * subscriptionId is assigned by the server and is unique within the
+ * connection. Subscriptions end when the connection is closed.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockSubscriptionResponseDescriptor {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t subscriptionId;
+  uint32_t errorLength;
+};
+EDII_PACKED_STRUCT_END
+
+/*
+ * Payload of EDII_ENVELOPE_NOTIFICATION. flags is a combination of
+ * EDII_IPCSockChangeFlags, size and modified (milliseconds since the epoch)
+ * describe the file after the change. With EDII_IPCS_CHANGE_FLAG_DATA the
+ * notification is followed by the response to the incremental load,
+ * laid out according to the loadFlags of the subscription. A failed load
+ * does not end the subscription.
+ */
+EDII_PACKED_STRUCT_BEGIN EDII_IPCSockChangeNotification {
+  uint16_t magic;
+  uint8_t responseType;
+  uint8_t status;
+
+  uint32_t flags;
+  int64_t size;
+  int64_t modified;
+};
+EDII_PACKED_STRUCT_END
+
 #endif // ECHMET_EDII_IPC_NETWORK_H
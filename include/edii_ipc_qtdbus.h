@@ -7,9 +7,11 @@
 #include <QVector>
 #include <QtDBus/QDBusArgument>
 #include <QtDBus/QDBusMetaType>
+#include <QtDBus/QDBusUnixFileDescriptor>
 
 #define EDII_DBUS_SERVICE_NAME "cz.cuni.natur.echmet.edii"
 #define EDII_DBUS_OBJECT_PATH "/EDII"
+#define EDII_DBUS_INTERFACE_NAME "edii.loader"
 
 namespace EDII {
 namespace IPCQtDBus {
@@ -179,6 +181,532 @@ Q_DECLARE_METATYPE(EDII::IPCQtDBus::DataPack)
 namespace EDII {
 namespace IPCQtDBus {
 
+/*
+ * Result of an incremental load of a growing file. The pack contains only the datapoints
+ * appended since the cursor passed with the request. Cursor shall be passed with the next
+ * request for the same file. Reset is true if the data start at the beginning of the file
+ * and the data received before shall be discarded.
+ */
+class TailDataPack {
+public:
+  explicit TailDataPack() :
+    cursor{0},
+    reset{false}
+  {}
+
+  quint64 cursor;
+  bool reset;
+  DataPack pack;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const TailDataPack &tailPack)
+  {
+    argument.beginStructure();
+    argument << tailPack.cursor;
+    argument << tailPack.reset;
+    argument << tailPack.pack;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, TailDataPack &tailPack)
+  {
+    argument.beginStructure();
+    argument >> tailPack.cursor;
+    argument >> tailPack.reset;
+    argument >> tailPack.pack;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::TailDataPack)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class AxisVec : public QVector<QVector<double>> {
+public:
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const AxisVec &vec)
+  {
+    argument.beginArray(qMetaTypeId<QVector<double>>());
+    for (const auto &item : vec)
+      argument << item;
+    argument.endArray();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, AxisVec &vec)
+  {
+    argument.beginArray();
+    while (!argument.atEnd()) {
+      QVector<double> axis;
+      argument >> axis;
+      vec.append(axis);
+    }
+    argument.endArray();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::AxisVec)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class SharedAxisData {
+public:
+  explicit SharedAxisData() :
+    axis{-1}
+  {}
+
+  QString path;
+  QString dataId;
+  QString name;
+
+  QString xDescription;
+  QString yDescription;
+  QString xUnit;
+  QString yUnit;
+
+  int32_t axis;                 /* Index of the X axis in SharedAxesDataPack::axes */
+  QVector<double> yValues;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const SharedAxisData &result)
+  {
+    argument.beginStructure();
+    argument << result.path;
+    argument << result.dataId;
+    argument << result.name;
+    argument << result.xDescription;
+    argument << result.yDescription;
+    argument << result.xUnit;
+    argument << result.yUnit;
+    argument << result.axis;
+    argument << result.yValues;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, SharedAxisData &result)
+  {
+    argument.beginStructure();
+    argument >> result.path;
+    argument >> result.dataId;
+    argument >> result.name;
+    argument >> result.xDescription;
+    argument >> result.yDescription;
+    argument >> result.xUnit;
+    argument >> result.yUnit;
+    argument >> result.axis;
+    argument >> result.yValues;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::SharedAxisData)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class SharedAxisDataVec : public QVector<EDII::IPCQtDBus::SharedAxisData> {
+public:
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const SharedAxisDataVec &vec)
+  {
+    argument.beginArray(qMetaTypeId<EDII::IPCQtDBus::SharedAxisData>());
+    for (const auto &item : vec)
+      argument << item;
+    argument.endArray();
+
+    return argument;
+  }
+
+  friend const  QDBusArgument & operator>>(const QDBusArgument &argument, SharedAxisDataVec &vec)
+  {
+    argument.beginArray();
+    while (!argument.atEnd()) {
+      EDII::IPCQtDBus::SharedAxisData d;
+      argument >> d;
+      vec.append(d);
+    }
+    argument.endArray();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::SharedAxisDataVec)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class SharedAxesDataPack {
+public:
+  explicit SharedAxesDataPack() :
+    success{false},
+    error{"Empty response"}
+  {}
+
+  bool success;
+  QString error;
+  AxisVec axes;
+  SharedAxisDataVec data;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const SharedAxesDataPack &pack)
+  {
+    argument.beginStructure();
+    argument << pack.success;
+    argument << pack.error;
+    argument << pack.axes;
+    argument << pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, SharedAxesDataPack &pack)
+  {
+    argument.beginStructure();
+    argument >> pack.success;
+    argument >> pack.error;
+    argument >> pack.axes;
+    argument >> pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::SharedAxesDataPack)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+/*
+ * Description of a trace whose values are passed in a file. Values are stored
+ * as native doubles, offsets are in bytes from the beginning of the file.
+ */
+class FdTraceInfo {
+public:
+  explicit FdTraceInfo() :
+    datapoints{0},
+    xOffset{0},
+    yOffset{0}
+  {}
+
+  QString path;
+  QString dataId;
+  QString name;
+
+  QString xDescription;
+  QString yDescription;
+  QString xUnit;
+  QString yUnit;
+
+  quint64 datapoints;
+  quint64 xOffset;              /* Traces with identical X values share the offset */
+  quint64 yOffset;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const FdTraceInfo &result)
+  {
+    argument.beginStructure();
+    argument << result.path;
+    argument << result.dataId;
+    argument << result.name;
+    argument << result.xDescription;
+    argument << result.yDescription;
+    argument << result.xUnit;
+    argument << result.yUnit;
+    argument << result.datapoints;
+    argument << result.xOffset;
+    argument << result.yOffset;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, FdTraceInfo &result)
+  {
+    argument.beginStructure();
+    argument >> result.path;
+    argument >> result.dataId;
+    argument >> result.name;
+    argument >> result.xDescription;
+    argument >> result.yDescription;
+    argument >> result.xUnit;
+    argument >> result.yUnit;
+    argument >> result.datapoints;
+    argument >> result.xOffset;
+    argument >> result.yOffset;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::FdTraceInfo)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class FdTraceInfoVec : public QVector<EDII::IPCQtDBus::FdTraceInfo> {
+public:
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const FdTraceInfoVec &vec)
+  {
+    argument.beginArray(qMetaTypeId<EDII::IPCQtDBus::FdTraceInfo>());
+    for (const auto &item : vec)
+      argument << item;
+    argument.endArray();
+
+    return argument;
+  }
+
+  friend const  QDBusArgument & operator>>(const QDBusArgument &argument, FdTraceInfoVec &vec)
+  {
+    argument.beginArray();
+    while (!argument.atEnd()) {
+      EDII::IPCQtDBus::FdTraceInfo d;
+      argument >> d;
+      vec.append(d);
+    }
+    argument.endArray();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::FdTraceInfoVec)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+/*
+ * Result of a load whose values are passed in a sealed memory file rather than
+ * in the message. The client maps the file read-only and finds the values of each
+ * trace at the offsets given in its description. D-Bus cannot pass an invalid
+ * descriptor so a failed load carries a descriptor of an empty file.
+ */
+class FdDataPack {
+public:
+  explicit FdDataPack() :
+    success{false},
+    error{"Empty response"},
+    size{0}
+  {}
+
+  bool success;
+  QString error;
+  QDBusUnixFileDescriptor values;
+  quint64 size;                 /* Size of the file in bytes */
+  FdTraceInfoVec data;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const FdDataPack &pack)
+  {
+    argument.beginStructure();
+    argument << pack.success;
+    argument << pack.error;
+    argument << pack.values;
+    argument << pack.size;
+    argument << pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, FdDataPack &pack)
+  {
+    argument.beginStructure();
+    argument >> pack.success;
+    argument >> pack.error;
+    argument >> pack.values;
+    argument >> pack.size;
+    argument >> pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::FdDataPack)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+/*
+ * Trace with its X and Y values in separate arrays. X values that lie on a uniform
+ * grid are not sent, value i is then t0 + i * dt computed in double precision.
+ */
+class ColumnarData {
+public:
+  explicit ColumnarData() :
+    uniformX{false},
+    t0{0.0},
+    dt{0.0}
+  {}
+
+  QString path;
+  QString dataId;
+  QString name;
+
+  QString xDescription;
+  QString yDescription;
+  QString xUnit;
+  QString yUnit;
+
+  bool uniformX;                /* xValues is empty, t0 and dt describe the X values */
+  double t0;
+  double dt;
+  QVector<double> xValues;
+  QVector<double> yValues;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const ColumnarData &result)
+  {
+    argument.beginStructure();
+    argument << result.path;
+    argument << result.dataId;
+    argument << result.name;
+    argument << result.xDescription;
+    argument << result.yDescription;
+    argument << result.xUnit;
+    argument << result.yUnit;
+    argument << result.uniformX;
+    argument.beginStructure();
+    argument << result.t0;
+    argument << result.dt;
+    argument.endStructure();
+    argument << result.xValues;
+    argument << result.yValues;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, ColumnarData &result)
+  {
+    argument.beginStructure();
+    argument >> result.path;
+    argument >> result.dataId;
+    argument >> result.name;
+    argument >> result.xDescription;
+    argument >> result.yDescription;
+    argument >> result.xUnit;
+    argument >> result.yUnit;
+    argument >> result.uniformX;
+    argument.beginStructure();
+    argument >> result.t0;
+    argument >> result.dt;
+    argument.endStructure();
+    argument >> result.xValues;
+    argument >> result.yValues;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::ColumnarData)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class ColumnarDataVec : public QVector<EDII::IPCQtDBus::ColumnarData> {
+public:
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const ColumnarDataVec &vec)
+  {
+    argument.beginArray(qMetaTypeId<EDII::IPCQtDBus::ColumnarData>());
+    for (const auto &item : vec)
+      argument << item;
+    argument.endArray();
+
+    return argument;
+  }
+
+  friend const  QDBusArgument & operator>>(const QDBusArgument &argument, ColumnarDataVec &vec)
+  {
+    argument.beginArray();
+    while (!argument.atEnd()) {
+      EDII::IPCQtDBus::ColumnarData d;
+      argument >> d;
+      vec.append(d);
+    }
+    argument.endArray();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::ColumnarDataVec)
+
+namespace EDII {
+namespace IPCQtDBus {
+
+class ColumnarDataPack {
+public:
+  explicit ColumnarDataPack() :
+    success{false},
+    error{"Empty response"}
+  {}
+
+  bool success;
+  QString error;
+  ColumnarDataVec data;
+
+  friend QDBusArgument & operator<<(QDBusArgument &argument, const ColumnarDataPack &pack)
+  {
+    argument.beginStructure();
+    argument << pack.success;
+    argument << pack.error;
+    argument << pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+
+  friend const QDBusArgument & operator>>(const QDBusArgument &argument, ColumnarDataPack &pack)
+  {
+    argument.beginStructure();
+    argument >> pack.success;
+    argument >> pack.error;
+    argument >> pack.data;
+    argument.endStructure();
+
+    return argument;
+  }
+};
+
+}
+}
+Q_DECLARE_METATYPE(EDII::IPCQtDBus::ColumnarDataPack)
+
+namespace EDII {
+namespace IPCQtDBus {
+
 class LoadOptionsVec : public QVector<QString>
 {
 public:
@@ -337,6 +865,28 @@ public:
     qDBusRegisterMetaType<DataVec>();
     qRegisterMetaType<DataPack>("EDII::IPCQtDBus::DataPack");
     qDBusRegisterMetaType<DataPack>();
+    qRegisterMetaType<TailDataPack>("EDII::IPCQtDBus::TailDataPack");
+    qDBusRegisterMetaType<TailDataPack>();
+    qRegisterMetaType<AxisVec>("EDII::IPCQtDBus::AxisVec");
+    qDBusRegisterMetaType<AxisVec>();
+    qRegisterMetaType<SharedAxisData>("EDII::IPCQtDBus::SharedAxisData");
+    qDBusRegisterMetaType<SharedAxisData>();
+    qRegisterMetaType<SharedAxisDataVec>("EDII::IPCQtDBus::SharedAxisDataVec");
+    qDBusRegisterMetaType<SharedAxisDataVec>();
+    qRegisterMetaType<SharedAxesDataPack>("EDII::IPCQtDBus::SharedAxesDataPack");
+    qDBusRegisterMetaType<SharedAxesDataPack>();
+    qRegisterMetaType<FdTraceInfo>("EDII::IPCQtDBus::FdTraceInfo");
+    qDBusRegisterMetaType<FdTraceInfo>();
+    qRegisterMetaType<FdTraceInfoVec>("EDII::IPCQtDBus::FdTraceInfoVec");
+    qDBusRegisterMetaType<FdTraceInfoVec>();
+    qRegisterMetaType<FdDataPack>("EDII::IPCQtDBus::FdDataPack");
+    qDBusRegisterMetaType<FdDataPack>();
+    qRegisterMetaType<ColumnarData>("EDII::IPCQtDBus::ColumnarData");
+    qDBusRegisterMetaType<ColumnarData>();
+    qRegisterMetaType<ColumnarDataVec>("EDII::IPCQtDBus::ColumnarDataVec");
+    qDBusRegisterMetaType<ColumnarDataVec>();
+    qRegisterMetaType<ColumnarDataPack>("EDII::IPCQtDBus::ColumnarDataPack");
+    qDBusRegisterMetaType<ColumnarDataPack>();
     qRegisterMetaType<LoadOptionsVec>("EDII:IPCQtDBus::LoadOptionsVec");
     qDBusRegisterMetaType<LoadOptionsVec>();
     qRegisterMetaType<SupportedFileFormat>("EDII::IPCQtDBus::SupportedFileFormat");
@@ -1,16 +1,27 @@
 #ifndef ECHMET_EDII_PLUGININTERFACE_H
 #define ECHMET_EDII_PLUGININTERFACE_H
 
+#include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 class UIPlugin;
 
 namespace plugin {
 
+/*!
+ * \brief X values that may be shared by several <tt>Data</tt> objects.
+ */
+typedef std::shared_ptr<const std::vector<double>> SharedAxis;
+
 /*!
  * \brief Class representing the loaded data.
+ *
+ * Datapoints may be passed either as [X, Y] tuples or as a <tt>SharedAxis</tt> with
+ * a separate vector of Y values. The latter allows all traces read from one file
+ * to reference the same X values instead of carrying a copy each.
  */
 class Data {
 public:
@@ -28,6 +39,16 @@ public:
   {
   }
 
+  Data(std::string _name, std::string _dataId, std::string _path,
+       std::string _xDesc, std::string _yDesc, std::string _xUnit, std::string _yUnit,
+       SharedAxis _xAxis, std::vector<double> _yValues) noexcept :
+    name{std::move(_name)}, dataId{std::move(_dataId)}, path{std::move(_path)},
+    xDescription{std::move(_xDesc)}, yDescription{std::move(_yDesc)},
+    xUnit{std::move(_xUnit)}, yUnit{std::move(_yUnit)},
+    xAxis{std::move(_xAxis)}, yValues{std::move(_yValues)}
+  {
+  }
+
   const std::string name;                                     /*!< Name of the source file */
   const std::string dataId;                                   /*!< Optional identifier of the data block */
   const std::string path;                                     /*!< Absolute path to the source file */
@@ -36,8 +57,19 @@ public:
   const std::string xUnit;                                    /*!< Units of data on X axis */
   const std::string yUnit;                                    /*!< Units of data on Y axis */
   const std::vector<std::tuple<double, double>> datapoints;   /*!< [X, Y] tuples of datapoints */
+  const SharedAxis xAxis;                                     /*!< X values of datapoints, used instead of <tt>datapoints</tt> when set */
+  const std::vector<double> yValues;                          /*!< Y values of datapoints, used together with <tt>xAxis</tt> */
 };
 
+/*!
+ * \brief Descriptive information about a data file as key-value pairs.
+ *
+ * Plugins should use the following keys where applicable so that files of different formats can be searched alike:
+ * <tt>sample</tt>, <tt>operator</tt>, <tt>method</tt>, <tt>acquired</tt> (date and time in ISO 8601 format),
+ * <tt>signal</tt>, <tt>wavelength</tt> (in nm), <tt>units</tt> and <tt>instrument</tt>. Other keys may be used freely.
+ */
+typedef std::vector<std::pair<std::string, std::string>> Metadata;
+
 /*!
  * Identifier of a specific backed
  */
@@ -49,6 +81,19 @@ public:
   const std::vector<std::string> loadOptions;   /*!< Description of each modifier of loading behavior */
 };
 
+/*!
+ * \brief Parser state that allows a backend to resume reading of a file that is still being written.
+ *
+ * Backends derive their own checkpoint types from this class. A checkpoint is never modified
+ * once it has been handed out, EDII may keep several checkpoints for the same file.
+ */
+class TailCheckpoint {
+public:
+  virtual ~TailCheckpoint()
+  {
+  }
+};
+
 class EDIIPlugin {
 public:
   /*!
@@ -84,6 +129,86 @@ public:
    * \return Vector of <tt>Data</tt> objects, each corresponding to one loaded data file.
    */
   virtual std::vector<Data> loadPath(const std::string &path, const int option) = 0;
+
+  /*!
+   * \brief Tells whether the backend can load data without any interaction with the user.
+   * \return True if <tt>loadPathUnattended()</tt> is implemented, false otherwise.
+   */
+  virtual bool unattendedLoadSupported() const
+  {
+    return false;
+  }
+
+  /*!
+   * \brief Loads data from a given path without displaying any UI, not even error messages.
+   *        EDII uses this to decode files in background before the user asks for them.
+   * \param path Path to a file where to load data from.
+   * \param option Loading behavior modifier.
+   * \return Vector of <tt>Data</tt> objects, empty if the file cannot be loaded.
+   */
+  virtual std::vector<Data> loadPathUnattended(const std::string &path, const int option)
+  {
+    (void)path;
+    (void)option;
+
+    return {};
+  }
+
+  /*!
+   * \brief Tells whether the backend can read metadata of data files.
+   * \return True if <tt>readMetadata()</tt> is implemented, false otherwise.
+   */
+  virtual bool metadataSupported() const
+  {
+    return false;
+  }
+
+  /*!
+   * \brief Reads metadata of a data file without displaying any UI. Implementations should read
+   *        as little of the file as possible, EDII uses this to index whole directory trees.
+   * \param path Path to a file where to read metadata from.
+   * \param metadata Filled with the metadata of the file.
+   * \return True if the file was recognized and its metadata were read, false otherwise.
+   */
+  virtual bool readMetadata(const std::string &path, Metadata &metadata)
+  {
+    (void)path;
+    (void)metadata;
+
+    return false;
+  }
+
+  /*!
+   * \brief Tells whether the backend can read files incrementally as they grow.
+   * \return True if <tt>loadPathTail()</tt> is implemented, false otherwise.
+   */
+  virtual bool tailLoadSupported() const
+  {
+    return false;
+  }
+
+  /*!
+   * \brief Loads data that were appended to a file since the given checkpoint.
+   * \param path Path to a file where to load data from.
+   * \param option Loading behavior modifier.
+   * \param checkpoint Checkpoint returned by a previous call for the same file and option or <tt>nullptr</tt>
+   *        to read the file from the beginning. On return it is replaced by a new checkpoint that describes
+   *        the state after this call or by <tt>nullptr</tt> if the file cannot be loaded.
+   * \param restarted Set to true if the file could not be resumed from the passed checkpoint
+   *        (it was truncated or replaced) and was read from the beginning instead.
+   * \return Vector of <tt>Data</tt> objects with only the datapoints that were not returned before.
+   *         The vector is empty if no complete datapoints were appended.
+   */
+  virtual std::vector<Data> loadPathTail(const std::string &path, const int option,
+                                         std::shared_ptr<const TailCheckpoint> &checkpoint, bool &restarted)
+  {
+    (void)path;
+    (void)option;
+
+    checkpoint = nullptr;
+    restarted = false;
+    return {};
+  }
 protected:
   virtual ~EDIIPlugin() = 0;
 };
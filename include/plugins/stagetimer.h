@@ -0,0 +1,77 @@
+#ifndef ECHMET_EDII_STAGETIMER_H
+#define ECHMET_EDII_STAGETIMER_H
+
+#include "uiplugin.h"
+
+#include <chrono>
+
+namespace plugin {
+
+/*!
+ * Stages of a data load whose duration is tracked by EDII.
+ */
+enum class LoadStage : int {
+  FILE_IO = 0,          /*!< Reading raw data from the source */
+  TEXT_DECODING = 1,    /*!< Conversion of raw bytes to text and splitting it into lines */
+  PARSING = 2,          /*!< Conversion of text or binary records to numbers */
+  PACKAGING = 3,        /*!< Conversion of plugin output to the internal representation (done by EDII) */
+  SERIALIZATION = 4,    /*!< Conversion of the internal representation to the IPC format (done by EDII) */
+  SOCKET_WRITE = 5,     /*!< Waiting for the client to receive the data (done by EDII) */
+  TOTAL = 6             /*!< Whole request as seen by the IPC interface (done by EDII) */
+};
+
+static const int NUM_LOAD_STAGES = 7;
+
+/*!
+ * Measures time spent in a stage of data load and reports it to EDII when it goes out of scope.
+ */
+class StageTimer {
+public:
+  /*!
+   * \brief Starts the measurement.
+   * \param plugin <tt>UIPlugin</tt> object passed to the plugin on initialization.
+   * \param tag Tag of the plugin as given in its <tt>Identifier</tt>. The string must outlive the timer.
+   * \param stage Stage being measured.
+   */
+  explicit StageTimer(UIPlugin *plugin, const char *tag, const LoadStage stage) :
+    m_plugin{plugin},
+    m_tag{tag},
+    m_stage{stage},
+    m_start{std::chrono::steady_clock::now()},
+    m_running{true}
+  {}
+
+  StageTimer(const StageTimer &other) = delete;
+  StageTimer & operator=(const StageTimer &other) = delete;
+
+  ~StageTimer()
+  {
+    stop();
+  }
+
+  /*!
+   * \brief Ends the measurement before the timer goes out of scope.
+   */
+  void stop()
+  {
+    if (!m_running)
+      return;
+    m_running = false;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+
+    if (m_plugin != nullptr)
+      m_plugin->reportStageTime(m_tag, static_cast<int>(m_stage), elapsed.count());
+  }
+
+private:
+  UIPlugin *const m_plugin;
+  const char *const m_tag;
+  const LoadStage m_stage;
+  const std::chrono::steady_clock::time_point m_start;
+  bool m_running;
+};
+
+} // namespace plugin
+
+#endif // ECHMET_EDII_STAGETIMER_H
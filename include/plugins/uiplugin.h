@@ -16,6 +16,10 @@ public slots:
   virtual void createInstance(ThreadedDialogBase *disp);
   virtual void display(ThreadedDialogBase *disp);
 
+public:
+  /* Used by plugin::StageTimer to report how long a stage of data load took */
+  virtual void reportStageTime(const char *tag, const int stage, const qint64 nsecs);
+
 private:
   explicit UIPlugin(QObject *parent = nullptr);
 
@@ -0,0 +1,25 @@
+#ifndef BENCHFIXTURE_H
+#define BENCHFIXTURE_H
+
+#include <cstdint>
+
+/*
+ * Layout of the fixture files that edii-bench generates and the bench
+ * fixture plugin reads. The header is followed by the X values shared by
+ * all traces and then by the Y values of each trace, all of them doubles
+ * in native byte order. Fixtures are generated on the machine they are
+ * read on so there is no need for a portable encoding.
+ */
+
+#define BENCH_FIXTURE_TAG "EDIIBENCH"
+#define BENCH_FIXTURE_MAGIC "EDIIBFX1"
+#define BENCH_FIXTURE_SUFFIX ".ebfx"
+
+struct BenchFixtureHeader {
+  char magic[8];
+  uint32_t traces;
+  uint32_t reserved;
+  uint64_t points;
+};
+
+#endif // BENCHFIXTURE_H
@@ -0,0 +1,114 @@
+#include <edii_ipc_codec.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QVector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Measures the compression ratio and the encoding and decoding throughput
+ * of EDII_IPCS_CODEC_DOD_XOR on a synthetic chromatogram: a uniform time
+ * axis and a drifting baseline with Gaussian peaks and detector noise
+ * quantized the way detectors report their readings.
+ *
+ * Usage: edii-codec-bench [points] [repeats]
+ */
+
+static
+void makeTrace(QVector<double> &xValues, QVector<double> &yValues, const int points)
+{
+  static const double SAMPLING_RATE = 10.0; /* Hz */
+  static const double QUANTUM = 1.0e-4;     /* mAU */
+  QRandomGenerator rng{42};
+
+  for (int idx = 0; idx < points; idx++) {
+    const double t = idx / SAMPLING_RATE / 60.0;
+    double signal = 0.5 + 0.02 * t;
+
+    for (int peak = 1; peak <= 12; peak++) {
+      const double center = peak * (points / SAMPLING_RATE / 60.0) / 13.0;
+      signal += 50.0 * peak * std::exp(-std::pow((t - center) / 0.05, 2));
+    }
+    signal += (rng.generateDouble() - 0.5) * 0.01;
+
+    xValues[idx] = t;
+    yValues[idx] = std::round(signal / QUANTUM) * QUANTUM;
+  }
+}
+
+static
+double mibPerSecond(const qint64 bytes, const qint64 ns)
+{
+  return bytes / (ns / 1.0e9) / (1024.0 * 1024.0);
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app{argc, argv};
+
+  const QStringList args = app.arguments();
+  const int points = args.size() > 1 ? args.at(1).toInt() : 1000000;
+  const int repeats = args.size() > 2 ? args.at(2).toInt() : 5;
+
+  if (points < 1 || repeats < 1) {
+    std::fprintf(stderr, "Usage: %s [points] [repeats]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  QVector<double> xValues(points);
+  QVector<double> yValues(points);
+  QVector<double> xDecoded(points);
+  QVector<double> yDecoded(points);
+  makeTrace(xValues, yValues, points);
+
+  QByteArray buffer{static_cast<qsizetype>(2 * edii_codec_bound(points)), Qt::Uninitialized};
+  uint8_t *out = reinterpret_cast<uint8_t *>(buffer.data());
+  size_t xLength = 0;
+  size_t yLength = 0;
+  qint64 bestEncode = -1;
+  qint64 bestDecode = -1;
+
+  for (int r = 0; r < repeats; r++) {
+    QElapsedTimer timer;
+
+    timer.start();
+    xLength = edii_codec_encode_dod(xValues.constData(), points, out);
+    yLength = edii_codec_encode_xor(yValues.constData(), points, out + xLength);
+    const qint64 encode = timer.nsecsElapsed();
+
+    timer.restart();
+    const size_t xRead = edii_codec_decode_dod(out, xLength + yLength, xDecoded.data(), points);
+    if (xRead == EDII_CODEC_ERROR ||
+        edii_codec_decode_xor(out + xRead, xLength + yLength - xRead, yDecoded.data(), points) == EDII_CODEC_ERROR) {
+      std::fprintf(stderr, "Decoding failed\n");
+      return EXIT_FAILURE;
+    }
+    const qint64 decode = timer.nsecsElapsed();
+
+    if (bestEncode < 0 || encode < bestEncode)
+      bestEncode = encode;
+    if (bestDecode < 0 || decode < bestDecode)
+      bestDecode = decode;
+  }
+
+  if (std::memcmp(xValues.constData(), xDecoded.constData(), sizeof(double) * points) != 0 ||
+      std::memcmp(yValues.constData(), yDecoded.constData(), sizeof(double) * points) != 0) {
+    std::fprintf(stderr, "Decoded values differ from the original ones\n");
+    return EXIT_FAILURE;
+  }
+
+  const qint64 raw = static_cast<qint64>(2 * sizeof(double)) * points;
+
+  std::printf("%-10s %10d points %12lld bytes\n", "raw", points, static_cast<long long>(raw));
+  std::printf("%-10s %10d points %12zu bytes %8.2f bits/value\n", "x", points, xLength, 8.0 * xLength / points);
+  std::printf("%-10s %10d points %12zu bytes %8.2f bits/value\n", "y", points, yLength, 8.0 * yLength / points);
+  std::printf("ratio      %.2fx\n", static_cast<double>(raw) / (xLength + yLength));
+  std::printf("encode     %10.1f MiB/s\n", mibPerSecond(raw, bestEncode));
+  std::printf("decode     %10.1f MiB/s\n", mibPerSecond(raw, bestDecode));
+
+  return EXIT_SUCCESS;
+}
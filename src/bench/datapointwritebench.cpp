@@ -0,0 +1,203 @@
+#include "datapointpacker.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <QVector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+/*
+ * Compares the throughput of writing datapoints of a load data response
+ * to a local socket one EDII_IPCSockDatapoint at a time, as EDII used to,
+ * with writing blocks of datapoints prepared by DatapointPacker.
+ *
+ * Usage: edii-datapoint-write-bench [points] [repeats]
+ */
+
+#define BENCH_SOCKET_NAME "echmet_edii_datapoint_write_bench"
+#define HANDLING_TIMEOUT 30000
+#define READ_CHUNK_SIZE (1024 * 1024)
+
+typedef std::function<bool (QLocalSocket *, const QVector<double> &, const QVector<double> &)> Writer;
+
+static
+bool finalize(QLocalSocket *socket)
+{
+  do {
+    if (!socket->waitForBytesWritten(HANDLING_TIMEOUT))
+      return false;
+  } while (socket->bytesToWrite());
+  return true;
+}
+
+static
+bool writePerPoint(QLocalSocket *socket, const QVector<double> &xValues, const QVector<double> &yValues)
+{
+  for (int idx = 0; idx < yValues.size(); idx++) {
+    EDII_IPCSockDatapoint dp;
+
+    dp.x = xValues.at(idx);
+    dp.y = yValues.at(idx);
+
+    if (socket->write(reinterpret_cast<const char *>(&dp), sizeof(dp)) != sizeof(dp))
+      return false;
+  }
+
+  return true;
+}
+
+static
+bool writeBlocks(QLocalSocket *socket, const QVector<double> &xValues, const QVector<double> &yValues)
+{
+  return DatapointPacker::write(xValues.constData(), yValues.constData(), yValues.size(),
+                                [socket](const char *block, const qint64 size) {
+                                  return socket->write(block, size) == size;
+                                });
+}
+
+class WriterThread : public QThread
+{
+public:
+  WriterThread(Writer writer, const QVector<double> &xValues, const QVector<double> &yValues) :
+    m_writer{std::move(writer)},
+    h_xValues{xValues},
+    h_yValues{yValues},
+    m_elapsed{-1}
+  {}
+
+  qint64 elapsed() const
+  {
+    return m_elapsed;
+  }
+
+protected:
+  virtual void run() override
+  {
+    QLocalSocket socket{};
+    QElapsedTimer timer;
+
+    socket.connectToServer(BENCH_SOCKET_NAME);
+    if (!socket.waitForConnected(HANDLING_TIMEOUT))
+      return;
+
+    timer.start();
+    if (m_writer(&socket, h_xValues, h_yValues) && finalize(&socket))
+      m_elapsed = timer.nsecsElapsed();
+
+    socket.disconnectFromServer();
+  }
+
+private:
+  const Writer m_writer;
+  const QVector<double> &h_xValues;
+  const QVector<double> &h_yValues;
+  qint64 m_elapsed;
+};
+
+/* Returns the time in nanoseconds the writer needed to hand all datapoints over to the socket, -1 on failure */
+static
+qint64 runOnce(QLocalServer &server, const Writer &writer, const QVector<double> &xValues, const QVector<double> &yValues)
+{
+  const qint64 expected = static_cast<qint64>(sizeof(EDII_IPCSockDatapoint)) * yValues.size();
+  WriterThread thread{writer, xValues, yValues};
+
+  thread.start();
+
+  if (!server.waitForNewConnection(HANDLING_TIMEOUT)) {
+    thread.wait();
+    return -1;
+  }
+
+  QLocalSocket *peer = server.nextPendingConnection();
+  QByteArray buffer{READ_CHUNK_SIZE, Qt::Uninitialized};
+  qint64 received = 0;
+
+  while (received < expected) {
+    if (!peer->bytesAvailable() && !peer->waitForReadyRead(HANDLING_TIMEOUT))
+      break;
+
+    const qint64 r = peer->read(buffer.data(), buffer.size());
+    if (r < 0)
+      break;
+    received += r;
+  }
+
+  thread.wait();
+  delete peer;
+
+  if (received != expected)
+    return -1;
+  return thread.elapsed();
+}
+
+static
+qint64 best(QLocalServer &server, const Writer &writer, const QVector<double> &xValues, const QVector<double> &yValues, const int repeats)
+{
+  qint64 bestTime = -1;
+
+  for (int idx = 0; idx < repeats; idx++) {
+    const qint64 t = runOnce(server, writer, xValues, yValues);
+    if (t < 0)
+      return -1;
+    if (bestTime < 0 || t < bestTime)
+      bestTime = t;
+  }
+
+  return bestTime;
+}
+
+static
+void report(const char *name, const qint64 ns, const int points)
+{
+  const double bytes = static_cast<double>(sizeof(EDII_IPCSockDatapoint)) * points;
+  const double seconds = ns / 1.0e9;
+
+  std::printf("%-10s %10d points %10.2f ms %10.1f MiB/s\n", name, points, ns / 1.0e6, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app{argc, argv};
+
+  const QStringList args = app.arguments();
+  const int points = args.size() > 1 ? args.at(1).toInt() : 1000000;
+  const int repeats = args.size() > 2 ? args.at(2).toInt() : 5;
+
+  if (points < 1 || repeats < 1) {
+    std::fprintf(stderr, "Usage: %s [points] [repeats]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  QVector<double> xValues(points);
+  QVector<double> yValues(points);
+  for (int idx = 0; idx < points; idx++) {
+    xValues[idx] = idx * 0.001;
+    yValues[idx] = std::sin(xValues[idx]);
+  }
+
+  QLocalServer::removeServer(BENCH_SOCKET_NAME);
+  QLocalServer server{};
+  if (!server.listen(BENCH_SOCKET_NAME)) {
+    std::fprintf(stderr, "Cannot listen on local socket: %s\n", server.errorString().toUtf8().constData());
+    return EXIT_FAILURE;
+  }
+
+  const qint64 perPoint = best(server, writePerPoint, xValues, yValues, repeats);
+  const qint64 blocks = best(server, writeBlocks, xValues, yValues, repeats);
+
+  if (perPoint < 0 || blocks < 0) {
+    std::fprintf(stderr, "Benchmark failed\n");
+    return EXIT_FAILURE;
+  }
+
+  report("per-point", perPoint, points);
+  report("blocks", blocks, points);
+  std::printf("speedup    %.1fx\n", static_cast<double>(perPoint) / blocks);
+
+  return EXIT_SUCCESS;
+}
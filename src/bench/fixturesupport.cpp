@@ -0,0 +1,137 @@
+#include "fixturesupport.h"
+#include "benchfixture.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <plugins/stagetimer.h>
+#include <cstring>
+
+namespace plugin {
+
+const Identifier FixtureSupport::s_identifier{"Synthetic traces generated by edii-bench", "Bench fixture", BENCH_FIXTURE_TAG, {}};
+FixtureSupport *FixtureSupport::s_me{nullptr};
+
+static
+bool readValues(QFile &file, double *values, const uint64_t count)
+{
+  const qint64 bytes = sizeof(double) * count;
+
+  return file.read(reinterpret_cast<char *>(values), bytes) == bytes;
+}
+
+static
+std::vector<Data> loadFixture(UIPlugin *plugin, const std::string &path)
+{
+  StageTimer ioTimer{plugin, BENCH_FIXTURE_TAG, LoadStage::FILE_IO};
+
+  QFile file{QString::fromStdString(path)};
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+
+  BenchFixtureHeader header;
+  if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header) ||
+      std::memcmp(header.magic, BENCH_FIXTURE_MAGIC, sizeof(header.magic)) != 0)
+    return {};
+
+  const qint64 expected = sizeof(header) + sizeof(double) * header.points * (header.traces + 1);
+  if (header.traces < 1 || file.size() != expected)
+    return {};
+
+  auto xValues = std::make_shared<std::vector<double>>(header.points);
+  if (!readValues(file, xValues->data(), header.points))
+    return {};
+
+  std::vector<std::vector<double>> yValues{header.traces};
+  for (auto &trace : yValues) {
+    trace.resize(header.points);
+    if (!readValues(file, trace.data(), header.points))
+      return {};
+  }
+  ioTimer.stop();
+
+  StageTimer parsingTimer{plugin, BENCH_FIXTURE_TAG, LoadStage::PARSING};
+  const std::string name = QFileInfo{file.fileName()}.fileName().toStdString();
+  const SharedAxis axis = xValues;
+  std::vector<Data> data;
+
+  for (uint32_t idx = 0; idx < header.traces; idx++) {
+    data.emplace_back(name, "Trace " + std::to_string(idx), path,
+                      "Time", "Signal", "minute", "mAU",
+                      axis, std::move(yValues[idx]));
+  }
+
+  return data;
+}
+
+EDIIPlugin::~EDIIPlugin()
+{
+}
+
+FixtureSupport::FixtureSupport(UIPlugin *plugin) :
+  m_uiPlugin{plugin}
+{
+}
+
+FixtureSupport::~FixtureSupport()
+{
+}
+
+void FixtureSupport::destroy()
+{
+  delete s_me;
+}
+
+Identifier FixtureSupport::identifier() const
+{
+  return s_identifier;
+}
+
+FixtureSupport * FixtureSupport::initialize(UIPlugin *plugin)
+{
+  if (s_me == nullptr)
+    s_me = new (std::nothrow) FixtureSupport{plugin};
+
+  return s_me;
+}
+
+/* Fixtures are only ever loaded by path */
+std::vector<Data> FixtureSupport::load(const int option)
+{
+  (void)option;
+
+  return {};
+}
+
+std::vector<Data> FixtureSupport::loadHint(const std::string &hintPath, const int option)
+{
+  (void)hintPath;
+  (void)option;
+
+  return {};
+}
+
+std::vector<Data> FixtureSupport::loadPath(const std::string &path, const int option)
+{
+  (void)option;
+
+  return loadFixture(m_uiPlugin, path);
+}
+
+std::vector<Data> FixtureSupport::loadPathUnattended(const std::string &path, const int option)
+{
+  (void)option;
+
+  return loadFixture(m_uiPlugin, path);
+}
+
+bool FixtureSupport::unattendedLoadSupported() const
+{
+  return true;
+}
+
+EDIIPlugin * initialize(UIPlugin *plugin)
+{
+  return FixtureSupport::initialize(plugin);
+}
+
+} // namespace plugin
@@ -0,0 +1,43 @@
+#ifndef FIXTURESUPPORT_H
+#define FIXTURESUPPORT_H
+
+#include "fixturesupport_global.h"
+#include <plugins/plugininterface.h>
+
+namespace plugin {
+
+/*
+ * Reads fixture files generated by edii-bench, see benchfixture.h. The
+ * plugin never displays any UI so that EDII can be benchmarked without
+ * anybody around. It is not installed with EDII.
+ */
+class FIXTURESUPPORTSHARED_EXPORT FixtureSupport : public EDIIPlugin
+{
+public:
+  virtual Identifier identifier() const override;
+  virtual void destroy() override;
+  virtual std::vector<Data> load(const int option) override;
+  virtual std::vector<Data> loadHint(const std::string &hintPath, const int option) override;
+  virtual std::vector<Data> loadPath(const std::string &path, const int option) override;
+  virtual bool unattendedLoadSupported() const override;
+  virtual std::vector<Data> loadPathUnattended(const std::string &path, const int option) override;
+
+  static FixtureSupport *initialize(UIPlugin *backend);
+
+private:
+  FixtureSupport(UIPlugin *backend);
+  virtual ~FixtureSupport() override;
+
+  UIPlugin *m_uiPlugin;
+
+  static const Identifier s_identifier;
+  static FixtureSupport *s_me;
+};
+
+extern "C" {
+  FIXTURESUPPORTSHARED_EXPORT EDIIPlugin * initialize(UIPlugin *backend);
+}
+
+} // namespace plugin
+
+#endif // FIXTURESUPPORT_H
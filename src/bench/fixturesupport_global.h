@@ -0,0 +1,12 @@
+#ifndef FIXTURESUPPORT_GLOBAL_H
+#define FIXTURESUPPORT_GLOBAL_H
+
+#include <QtCore/qglobal.h>
+
+#if defined(FIXTURESUPPORT_LIBRARY)
+#  define FIXTURESUPPORTSHARED_EXPORT Q_DECL_EXPORT
+#else
+#  define FIXTURESUPPORTSHARED_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif // FIXTURESUPPORT_GLOBAL_H
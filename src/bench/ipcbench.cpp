@@ -0,0 +1,866 @@
+#include "benchfixture.h"
+
+#include <client/ediiclient.h>
+#include <edii_ipc_network.h>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+
+#ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+  #include <edii_ipc_qtdbus.h>
+  #include <QtDBus/QDBusConnection>
+  #include <QtDBus/QDBusConnectionInterface>
+  #include <QtDBus/QDBusMessage>
+#endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+
+#ifdef Q_OS_LINUX
+  #include <unistd.h>
+#endif // Q_OS_LINUX
+
+/*
+ * Measures how EDII copes with concurrent clients. The benchmark generates
+ * fixture files, starts its own EDII with a private configuration and lets
+ * simulated clients replay a mix of requests against it as fast as EDII
+ * answers them, first over the local socket and then over D-Bus on a
+ * private session bus. It reports throughput and latency percentiles of
+ * each kind of request and the CPU time and memory EDII consumed.
+ *
+ * Everything runs offline in a temporary directory. Fixtures are read by
+ * the bench fixture plugin, which is the only plugin the benchmarked EDII
+ * loads, so the results do not depend on the plugins installed.
+ *
+ * Usage: edii-bench [options], see edii-bench --help
+ */
+
+#define DBUS_INTERFACE_NAME "edii.loader"
+#define DEFAULT_SERVER_NAME EDII_IPCS_SOCKET_NAME
+#define STARTUP_TIMEOUT 30000
+#define SAMPLING_INTERVAL_MS 100
+
+enum Operation {
+  OP_FORMATS = 0,
+  OP_SMALL = 1,
+  OP_LARGE = 2,
+  NUM_OPERATIONS = 3
+};
+
+static const char *OPERATION_NAMES[NUM_OPERATIONS] = { "formats", "small", "large" };
+
+class Workload {
+public:
+  int clients;
+  int durationMs;
+  int warmupMs;
+  int timeoutMs;
+  int weights[NUM_OPERATIONS];
+  QStringList smallFiles;
+  QStringList largeFiles;
+  bool sharedMemory;
+  QString dbusMethod;
+};
+
+class Measurements {
+public:
+  Measurements() :
+    errors{0, 0, 0}
+  {}
+
+  QVector<qint64> latencies[NUM_OPERATIONS];  /* Nanoseconds */
+  int errors[NUM_OPERATIONS];
+  QString lastError;
+};
+
+/* A simulated client issues one request at a time over its own connection */
+class Transport {
+public:
+  virtual ~Transport() {}
+  virtual bool load(const QString &path, QString &error) = 0;
+  virtual bool supportedFormats(QString &error) = 0;
+};
+
+static
+bool readSocket(QLocalSocket &socket, char *data, qint64 length, const int timeout)
+{
+  while (length > 0) {
+    if (socket.bytesAvailable() < 1 && !socket.waitForReadyRead(timeout))
+      return false;
+
+    const qint64 r = socket.read(data, length);
+    if (r < 0)
+      return false;
+    data += r;
+    length -= r;
+  }
+
+  return true;
+}
+
+template <typename T>
+static
+bool readRaw(QLocalSocket &socket, T &t, const int timeout)
+{
+  return readSocket(socket, reinterpret_cast<char *>(&t), sizeof(T), timeout);
+}
+
+static
+bool skipSocket(QLocalSocket &socket, const qint64 length, const int timeout)
+{
+  QByteArray buffer{length, Qt::Uninitialized};
+
+  return readSocket(socket, buffer.data(), length, timeout);
+}
+
+class SocketTransport : public Transport {
+public:
+  SocketTransport(const QString &serverName, const Workload &workload) :
+    m_serverName{serverName},
+    m_timeout{workload.timeoutMs},
+    m_client{[&]() {
+      edii::ClientOptions options{};
+
+      options.serverName = serverName;
+      options.connections = 1;
+      options.timeout = workload.timeoutMs;
+      options.sharedMemory = workload.sharedMemory;
+
+      return options;
+    }()}
+  {}
+
+  virtual bool load(const QString &path, QString &error) override
+  {
+    const edii::LoadResult result = m_client.loadPath(edii::LoadRequest{BENCH_FIXTURE_TAG, path}).result();
+
+    if (!result.ok)
+      error = result.error;
+    return result.ok;
+  }
+
+  /* The client library does not list formats, the request is made over a connection of its own */
+  virtual bool supportedFormats(QString &error) override
+  {
+    QLocalSocket socket{};
+
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(m_timeout)) {
+      error = socket.errorString();
+      return false;
+    }
+
+    EDII_IPCSockRequestHeader req;
+    req.magic = EDII_IPCS_PACKET_MAGIC;
+    req.requestType = EDII_REQUEST_SUPPORTED_FORMATS;
+    socket.write(reinterpret_cast<const char *>(&req), sizeof(req));
+
+    EDII_IPCSockResponseHeader header;
+    if (!readRaw(socket, header, m_timeout) || header.magic != EDII_IPCS_PACKET_MAGIC) {
+      error = "Malformed response";
+      return false;
+    }
+    if (header.responseType == EDII_RESPONSE_BUSY) {
+      error = "Server is busy";
+      return false;
+    }
+    if (header.status != EDII_IPCS_SUCCESS) {
+      error = "Request failed";
+      return false;
+    }
+
+    for (int idx = 0; idx < header.items; idx++) {
+      EDII_IPCSockSupportedFormatResponseDescriptor desc;
+
+      if (!readRaw(socket, desc, m_timeout) ||
+          !skipSocket(socket, static_cast<qint64>(desc.longDescriptionLength) + desc.shortDescriptionLength + desc.tagLength, m_timeout)) {
+        error = "Malformed response";
+        return false;
+      }
+
+      for (uint32_t opt = 0; opt < desc.loadOptionsLength; opt++) {
+        EDII_IPCSockLoadOptionDescriptor loDesc;
+
+        if (!readRaw(socket, loDesc, m_timeout) || !skipSocket(socket, loDesc.optionLength, m_timeout)) {
+          error = "Malformed response";
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+private:
+  const QString m_serverName;
+  const int m_timeout;
+  edii::Client m_client;
+};
+
+#ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+class DBusTransport : public Transport {
+public:
+  DBusTransport(const QString &busAddress, const int index, const Workload &workload) :
+    m_connectionName{QString{"edii-bench-%1"}.arg(index)},
+    m_bus{QDBusConnection::connectToBus(busAddress, m_connectionName)},
+    m_method{workload.dbusMethod},
+    m_timeout{workload.timeoutMs}
+  {}
+
+  virtual ~DBusTransport() override
+  {
+    QDBusConnection::disconnectFromBus(m_connectionName);
+  }
+
+  /* Only the success flag at the beginning of the pack is read, the values stay undecoded */
+  virtual bool load(const QString &path, QString &error) override
+  {
+    QDBusMessage reply;
+
+    if (!call(m_method, { QString{BENCH_FIXTURE_TAG}, path, 0 }, reply, error))
+      return false;
+
+    const QDBusArgument pack = reply.arguments().value(0).value<QDBusArgument>();
+    bool success = false;
+    QString message;
+
+    pack.beginStructure();
+    pack >> success >> message;
+    if (!success)
+      error = message;
+    return success;
+  }
+
+  virtual bool supportedFormats(QString &error) override
+  {
+    QDBusMessage reply;
+
+    return call("supportedFileFormats", {}, reply, error);
+  }
+
+private:
+  bool call(const QString &method, const QList<QVariant> &arguments, QDBusMessage &reply, QString &error)
+  {
+    QDBusMessage msg = QDBusMessage::createMethodCall(EDII_DBUS_SERVICE_NAME, EDII_DBUS_OBJECT_PATH, DBUS_INTERFACE_NAME, method);
+
+    msg.setArguments(arguments);
+    reply = m_bus.call(msg, QDBus::Block, m_timeout);
+    if (reply.type() != QDBusMessage::ReplyMessage) {
+      error = reply.errorMessage();
+      return false;
+    }
+
+    return true;
+  }
+
+  const QString m_connectionName;
+  QDBusConnection m_bus;
+  const QString m_method;
+  const int m_timeout;
+};
+#endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+
+typedef std::function<Transport * (const int index)> TransportFactory;
+
+class ClientThread : public QThread {
+public:
+  ClientThread(const int index, const Workload &workload, const TransportFactory &factory, const QDeadlineTimer &warmup, const QDeadlineTimer &deadline) :
+    m_index{index},
+    h_workload{workload},
+    h_factory{factory},
+    m_warmup{warmup},
+    m_deadline{deadline}
+  {}
+
+  const Measurements & measurements() const
+  {
+    return m_measurements;
+  }
+
+protected:
+  virtual void run() override
+  {
+    std::unique_ptr<Transport> transport{h_factory(m_index)};
+    QRandomGenerator rng{static_cast<quint32>(m_index + 1)};
+    const int totalWeight = h_workload.weights[OP_FORMATS] + h_workload.weights[OP_SMALL] + h_workload.weights[OP_LARGE];
+
+    while (!m_deadline.hasExpired()) {
+      int pick = rng.bounded(totalWeight);
+      int op = 0;
+      while (pick >= h_workload.weights[op])
+        pick -= h_workload.weights[op++];
+
+      QString error;
+      QElapsedTimer timer;
+      bool ok;
+
+      timer.start();
+      if (op == OP_FORMATS) {
+        ok = transport->supportedFormats(error);
+      } else {
+        const QStringList &files = op == OP_SMALL ? h_workload.smallFiles : h_workload.largeFiles;
+        ok = transport->load(files.at(rng.bounded(files.size())), error);
+      }
+      const qint64 elapsed = timer.nsecsElapsed();
+
+      if (!m_warmup.hasExpired())
+        continue;
+
+      if (ok) {
+        m_measurements.latencies[op].append(elapsed);
+      } else {
+        m_measurements.errors[op]++;
+        m_measurements.lastError = error;
+      }
+    }
+  }
+
+private:
+  const int m_index;
+  const Workload &h_workload;
+  const TransportFactory &h_factory;
+  const QDeadlineTimer m_warmup;
+  const QDeadlineTimer m_deadline;
+  Measurements m_measurements;
+};
+
+/* Samples CPU time and resident memory of the server, only on Linux */
+class ResourceSampler {
+public:
+  explicit ResourceSampler(const qint64 pid) :
+    m_pid{pid},
+    m_cpuStart{-1},
+    m_cpuEnd{-1},
+    m_rssPeak{-1},
+    m_wallMs{0}
+  {}
+
+  void start()
+  {
+    m_cpuStart = cpuTicks();
+    m_wall.start();
+  }
+
+  void sample()
+  {
+    m_rssPeak = std::max(m_rssPeak, residentKiB());
+  }
+
+  void stop()
+  {
+    sample();
+    m_cpuEnd = cpuTicks();
+    m_wallMs = m_wall.elapsed();
+  }
+
+  /* Percent of one core, -1 if not available */
+  double cpuPercent() const
+  {
+#ifdef Q_OS_LINUX
+    if (m_cpuStart < 0 || m_cpuEnd < 0 || m_wallMs < 1)
+      return -1.0;
+    return 100.0 * (m_cpuEnd - m_cpuStart) / sysconf(_SC_CLK_TCK) / (m_wallMs / 1000.0);
+#else
+    return -1.0;
+#endif // Q_OS_LINUX
+  }
+
+  qint64 rssPeakKiB() const
+  {
+    return m_rssPeak;
+  }
+
+private:
+  qint64 cpuTicks() const
+  {
+    QFile f{QString{"/proc/%1/stat"}.arg(m_pid)};
+    if (!f.open(QIODevice::ReadOnly))
+      return -1;
+
+    /* The process name may contain spaces, fields are counted from its closing parenthesis */
+    const QByteArray stat = f.readAll();
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13)
+      return -1;
+
+    return fields.at(11).toLongLong() + fields.at(12).toLongLong(); /* utime + stime */
+  }
+
+  qint64 residentKiB() const
+  {
+    QFile f{QString{"/proc/%1/status"}.arg(m_pid)};
+    if (!f.open(QIODevice::ReadOnly))
+      return -1;
+
+    for (const QByteArray &line : f.readAll().split('\n')) {
+      if (line.startsWith("VmRSS:"))
+        return line.mid(6).trimmed().split(' ').at(0).toLongLong();
+    }
+
+    return -1;
+  }
+
+  const qint64 m_pid;
+  qint64 m_cpuStart;
+  qint64 m_cpuEnd;
+  qint64 m_rssPeak;
+  QElapsedTimer m_wall;
+  qint64 m_wallMs;
+};
+
+static
+double percentileMs(const QVector<qint64> &sorted, const double p)
+{
+  if (sorted.isEmpty())
+    return 0.0;
+
+  const int idx = std::clamp(static_cast<int>(std::ceil(p * sorted.size())) - 1, 0, static_cast<int>(sorted.size()) - 1);
+  return sorted.at(idx) / 1.0e6;
+}
+
+static
+QJsonObject report(const QString &transport, const QVector<ClientThread *> &threads, const ResourceSampler &sampler, const Workload &workload)
+{
+  const double seconds = (workload.durationMs - workload.warmupMs) / 1000.0;
+  QJsonObject operations;
+  QVector<qint64> all;
+  int allErrors = 0;
+  QString lastError;
+
+  std::printf("\n%s: %d clients, %.1f s\n", transport.toUtf8().constData(), workload.clients, seconds);
+  std::printf("%-10s %10s %8s %10s %10s %10s %10s\n", "operation", "requests", "errors", "req/s", "p50 ms", "p99 ms", "p99.9 ms");
+
+  auto row = [&](const char *name, QVector<qint64> &latencies, const int errors) {
+    std::sort(latencies.begin(), latencies.end());
+
+    const QJsonObject obj{
+      { "requests", latencies.size() },
+      { "errors", errors },
+      { "throughput", latencies.size() / seconds },
+      { "p50Ms", percentileMs(latencies, 0.5) },
+      { "p99Ms", percentileMs(latencies, 0.99) },
+      { "p999Ms", percentileMs(latencies, 0.999) }
+    };
+
+    std::printf("%-10s %10lld %8d %10.1f %10.2f %10.2f %10.2f\n", name, static_cast<long long>(latencies.size()), errors,
+                latencies.size() / seconds, percentileMs(latencies, 0.5), percentileMs(latencies, 0.99), percentileMs(latencies, 0.999));
+    return obj;
+  };
+
+  for (int op = 0; op < NUM_OPERATIONS; op++) {
+    if (workload.weights[op] < 1)
+      continue;
+
+    QVector<qint64> latencies;
+    int errors = 0;
+    for (const ClientThread *t : threads) {
+      latencies += t->measurements().latencies[op];
+      errors += t->measurements().errors[op];
+      if (!t->measurements().lastError.isEmpty())
+        lastError = t->measurements().lastError;
+    }
+
+    all += latencies;
+    allErrors += errors;
+    operations.insert(OPERATION_NAMES[op], row(OPERATION_NAMES[op], latencies, errors));
+  }
+  const QJsonObject total = row("total", all, allErrors);
+
+  QJsonObject server;
+  if (sampler.cpuPercent() >= 0.0) {
+    std::printf("server CPU %.1f %%, peak RSS %.1f MiB\n", sampler.cpuPercent(), sampler.rssPeakKiB() / 1024.0);
+    server.insert("cpuPercent", sampler.cpuPercent());
+    server.insert("rssPeakKiB", sampler.rssPeakKiB());
+  } else {
+    std::printf("server CPU and memory usage are not available on this platform\n");
+  }
+  if (!lastError.isEmpty())
+    std::printf("last error: %s\n", lastError.toUtf8().constData());
+
+  return QJsonObject{
+    { "transport", transport },
+    { "clients", workload.clients },
+    { "seconds", seconds },
+    { "operations", operations },
+    { "total", total },
+    { "server", server }
+  };
+}
+
+static
+QVector<double> makeSignal(const quint64 points, const quint32 seed)
+{
+  QRandomGenerator rng{seed};
+  QVector<double> values(points);
+
+  for (quint64 idx = 0; idx < points; idx++) {
+    const double t = static_cast<double>(idx) / points;
+    double signal = 0.5 + 0.02 * t;
+
+    for (int peak = 1; peak <= 8; peak++)
+      signal += 50.0 * peak * std::exp(-std::pow((t - peak / 9.0) / 0.005, 2));
+    signal += (rng.generateDouble() - 0.5) * 0.01;
+
+    values[idx] = std::round(signal / 1.0e-4) * 1.0e-4;
+  }
+
+  return values;
+}
+
+static
+bool writeFixture(const QString &path, const quint64 points, const quint32 traces, const quint32 seed)
+{
+  QFile file{path};
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  BenchFixtureHeader header;
+  std::memcpy(header.magic, BENCH_FIXTURE_MAGIC, sizeof(header.magic));
+  header.traces = traces;
+  header.reserved = 0;
+  header.points = points;
+
+  QVector<double> xValues(points);
+  for (quint64 idx = 0; idx < points; idx++)
+    xValues[idx] = idx / 600.0; /* 10 Hz in minutes */
+
+  if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header) ||
+      file.write(reinterpret_cast<const char *>(xValues.constData()), sizeof(double) * points) != static_cast<qint64>(sizeof(double) * points))
+    return false;
+
+  for (quint32 idx = 0; idx < traces; idx++) {
+    const QVector<double> yValues = makeSignal(points, seed * 31 + idx);
+    if (file.write(reinterpret_cast<const char *>(yValues.constData()), sizeof(double) * points) != static_cast<qint64>(sizeof(double) * points))
+      return false;
+  }
+
+  return true;
+}
+
+static
+bool makeFixtures(const QDir &dir, const QString &prefix, const int count, const quint64 points, const quint32 traces, QStringList &files)
+{
+  for (int idx = 0; idx < count; idx++) {
+    const QString path = dir.filePath(QString{"%1-%2%3"}.arg(prefix).arg(idx).arg(BENCH_FIXTURE_SUFFIX));
+
+    if (!writeFixture(path, points, traces, idx))
+      return false;
+    files.append(path);
+  }
+
+  return true;
+}
+
+static
+bool parseMix(const QString &mix, int weights[NUM_OPERATIONS])
+{
+  std::fill(weights, weights + NUM_OPERATIONS, 0);
+
+  for (const QString &item : mix.split(',', Qt::SkipEmptyParts)) {
+    const QStringList kv = item.split('=');
+    if (kv.size() != 2)
+      return false;
+
+    bool ok;
+    const int w = kv.at(1).toInt(&ok);
+    if (!ok || w < 0)
+      return false;
+
+    const auto it = std::find_if(OPERATION_NAMES, OPERATION_NAMES + NUM_OPERATIONS,
+                                 [&kv](const char *name) { return kv.at(0).trimmed() == name; });
+    if (it == OPERATION_NAMES + NUM_OPERATIONS)
+      return false;
+    weights[it - OPERATION_NAMES] = w;
+  }
+
+  return std::accumulate(weights, weights + NUM_OPERATIONS, 0) > 0;
+}
+
+/* Runs EDII in the benchmark directory, the plugin directory and the configuration are private to it */
+static
+bool startServer(QProcess &server, const QString &program, const QDir &root, const QString &busAddress)
+{
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+
+  env.insert("XDG_CONFIG_HOME", root.filePath("config"));
+  env.insert("TMPDIR", root.filePath("run"));
+  env.insert("QT_QPA_PLATFORM", "offscreen");
+  /* Without a session bus EDII falls back to the local socket */
+  env.insert("DBUS_SESSION_BUS_ADDRESS", busAddress.isEmpty() ? "unix:path=" + root.filePath("no-bus") : busAddress);
+
+  server.setProcessEnvironment(env);
+  server.setWorkingDirectory(root.path());
+  server.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  server.start(program, { QString::number(QCoreApplication::applicationPid()) });
+
+  return server.waitForStarted(STARTUP_TIMEOUT);
+}
+
+static
+void stopServer(QProcess &server)
+{
+  server.terminate();
+  if (!server.waitForFinished(STARTUP_TIMEOUT))
+    server.kill();
+  server.waitForFinished();
+}
+
+static
+bool waitForSocket(const QString &serverName, QProcess &server)
+{
+  QDeadlineTimer deadline{STARTUP_TIMEOUT};
+
+  while (!deadline.hasExpired() && server.state() == QProcess::Running) {
+    QLocalSocket probe{};
+
+    probe.connectToServer(serverName);
+    if (probe.waitForConnected(100))
+      return true;
+    QThread::msleep(100);
+  }
+
+  return false;
+}
+
+#ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+static
+bool startBus(QProcess &bus, QString &address)
+{
+  bus.start("dbus-daemon", { "--session", "--nofork", "--nopidfile", "--print-address=1" });
+  if (!bus.waitForStarted(STARTUP_TIMEOUT))
+    return false;
+
+  while (!bus.canReadLine()) {
+    if (!bus.waitForReadyRead(STARTUP_TIMEOUT))
+      return false;
+  }
+
+  address = QString::fromUtf8(bus.readLine()).trimmed();
+  return !address.isEmpty();
+}
+
+static
+bool waitForService(const QString &busAddress, QProcess &server)
+{
+  static const QString PROBE_NAME{"edii-bench-probe"};
+  QDeadlineTimer deadline{STARTUP_TIMEOUT};
+  bool registered = false;
+
+  {
+    QDBusConnection bus = QDBusConnection::connectToBus(busAddress, PROBE_NAME);
+
+    while (bus.isConnected() && !registered && !deadline.hasExpired() && server.state() == QProcess::Running) {
+      registered = bus.interface()->isServiceRegistered(EDII_DBUS_SERVICE_NAME);
+      if (!registered)
+        QThread::msleep(100);
+    }
+  }
+  QDBusConnection::disconnectFromBus(PROBE_NAME);
+
+  return registered;
+}
+#endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+
+static
+QJsonObject runClients(const QString &transport, const Workload &workload, const TransportFactory &factory, const qint64 serverPid)
+{
+  const QDeadlineTimer warmup{workload.warmupMs};
+  const QDeadlineTimer deadline{workload.durationMs};
+  QVector<ClientThread *> threads;
+  ResourceSampler sampler{serverPid};
+
+  for (int idx = 0; idx < workload.clients; idx++) {
+    threads.append(new ClientThread{idx, workload, factory, warmup, deadline});
+    threads.last()->start();
+  }
+
+  QThread::msleep(workload.warmupMs);
+  sampler.start();
+  while (!deadline.hasExpired()) {
+    sampler.sample();
+    QThread::msleep(std::min<qint64>(SAMPLING_INTERVAL_MS, std::max<qint64>(1, deadline.remainingTime())));
+  }
+  sampler.stop();
+
+  for (ClientThread *t : threads)
+    t->wait();
+
+  const QJsonObject result = report(transport, threads, sampler, workload);
+  qDeleteAll(threads);
+
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app{argc, argv};
+  QCommandLineParser parser{};
+
+  parser.setApplicationDescription("Benchmarks EDII with concurrent clients over the local socket and D-Bus");
+  parser.addHelpOption();
+  parser.addOptions({
+    { "server", "Path to the EDIICore executable", "path", EDII_BENCH_SERVER_PATH },
+    { "plugin", "Path to the bench fixture plugin", "path", EDII_BENCH_FIXTURE_PLUGIN_PATH },
+    { "config", "EDII configuration file to benchmark with, per-client request limit is disabled by default", "file" },
+    { "transport", "Transports to benchmark: socket, dbus or both", "name", "both" },
+    { "clients", "Number of simulated clients", "count", "8" },
+    { "duration", "Length of the measurement in seconds", "seconds", "10" },
+    { "warmup", "Time before the measurement starts in seconds", "seconds", "1" },
+    { "mix", "Relative weights of requests", "formats=N,small=N,large=N", "formats=1,small=8,large=1" },
+    { "files", "Number of fixture files of each size", "count", "8" },
+    { "small-points", "Datapoints of each trace of a small file", "count", "5000" },
+    { "large-points", "Datapoints of each trace of a large file", "count", "500000" },
+    { "traces", "Traces in each fixture file", "count", "4" },
+    { "timeout", "Milliseconds to wait for a response", "ms", "60000" },
+    { "shared-memory", "Receive values in memory files over the local socket" },
+    { "dbus-method", "D-Bus method used to load files", "name", "loadDataFile" },
+    { "json", "Write results to a JSON file", "file" }
+  });
+  parser.process(app);
+
+  Workload workload;
+  bool ok = true;
+  bool parsed;
+  auto intOption = [&parser, &ok, &parsed](const char *name, const int min) {
+    const int v = parser.value(name).toInt(&parsed);
+    ok = ok && parsed && v >= min;
+    return v;
+  };
+
+  workload.clients = intOption("clients", 1);
+  workload.durationMs = intOption("duration", 1) * 1000;
+  workload.warmupMs = intOption("warmup", 0) * 1000;
+  workload.timeoutMs = intOption("timeout", 1);
+  workload.sharedMemory = parser.isSet("shared-memory");
+  workload.dbusMethod = parser.value("dbus-method");
+  const int files = intOption("files", 1);
+  const int smallPoints = intOption("small-points", 1);
+  const int largePoints = intOption("large-points", 1);
+  const int traces = intOption("traces", 1);
+  const QString transports = parser.value("transport");
+
+  if (!ok || !parseMix(parser.value("mix"), workload.weights) ||
+      (transports != "socket" && transports != "dbus" && transports != "both")) {
+    std::fprintf(stderr, "Invalid arguments, see %s --help\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  workload.durationMs += workload.warmupMs;
+
+#ifndef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+  if (transports == "dbus") {
+    std::fprintf(stderr, "edii-bench was built without D-Bus support\n");
+    return EXIT_FAILURE;
+  }
+#endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+
+  QTemporaryDir tempDir{};
+  if (!tempDir.isValid()) {
+    std::fprintf(stderr, "Cannot create temporary directory: %s\n", tempDir.errorString().toUtf8().constData());
+    return EXIT_FAILURE;
+  }
+  const QDir root{tempDir.path()};
+  root.mkpath("config/ECHMET");
+  root.mkpath("fixtures");
+  root.mkpath("plugins");
+  root.mkpath("run");
+
+  const QString pluginPath = parser.value("plugin");
+  if (!QFile::copy(pluginPath, root.filePath("plugins/" + QFileInfo{pluginPath}.fileName()))) {
+    std::fprintf(stderr, "Cannot copy fixture plugin %s\n", pluginPath.toUtf8().constData());
+    return EXIT_FAILURE;
+  }
+
+  const QString configPath = root.filePath("config/ECHMET/EDII.ini");
+  if (parser.isSet("config")) {
+    if (!QFile::copy(parser.value("config"), configPath)) {
+      std::fprintf(stderr, "Cannot read configuration %s\n", parser.value("config").toUtf8().constData());
+      return EXIT_FAILURE;
+    }
+  } else {
+    /* All simulated clients live in one process, EDII would count them as one client */
+    QFile config{configPath};
+    if (!config.open(QIODevice::WriteOnly) || config.write("[WorkerPool]\nMaxRequestsPerClient=0\n") < 0) {
+      std::fprintf(stderr, "Cannot write configuration\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::printf("Generating fixtures...\n");
+  const QDir fixtures{root.filePath("fixtures")};
+  if (!makeFixtures(fixtures, "small", files, smallPoints, traces, workload.smallFiles) ||
+      !makeFixtures(fixtures, "large", files, largePoints, traces, workload.largeFiles)) {
+    std::fprintf(stderr, "Cannot write fixtures\n");
+    return EXIT_FAILURE;
+  }
+
+  QJsonArray results;
+  int ret = EXIT_SUCCESS;
+
+  if (transports != "dbus") {
+    QProcess server{};
+    const QString serverName = root.filePath("run/" DEFAULT_SERVER_NAME);
+
+    if (!startServer(server, parser.value("server"), root, QString{}) || !waitForSocket(serverName, server)) {
+      std::fprintf(stderr, "EDII did not start listening on the local socket\n");
+      ret = EXIT_FAILURE;
+    } else {
+      const TransportFactory factory = [&serverName, &workload](const int) -> Transport * {
+        return new SocketTransport{serverName, workload};
+      };
+      results.append(runClients("socket", workload, factory, server.processId()));
+    }
+    stopServer(server);
+  }
+
+#ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+  if (transports != "socket" && ret == EXIT_SUCCESS) {
+    QProcess bus{};
+    QProcess server{};
+    QString busAddress;
+
+    if (!startBus(bus, busAddress)) {
+      std::fprintf(stderr, "Cannot start private session bus\n");
+      ret = EXIT_FAILURE;
+    } else if (!startServer(server, parser.value("server"), root, busAddress) || !waitForService(busAddress, server)) {
+      std::fprintf(stderr, "EDII did not register on the private session bus\n");
+      ret = EXIT_FAILURE;
+    } else {
+      const TransportFactory factory = [&busAddress, &workload](const int index) -> Transport * {
+        return new DBusTransport{busAddress, index, workload};
+      };
+      results.append(runClients("dbus", workload, factory, server.processId()));
+    }
+    stopServer(server);
+    stopServer(bus);
+  }
+#endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
+
+  if (parser.isSet("json")) {
+    QFile out{parser.value("json")};
+    if (!out.open(QIODevice::WriteOnly) || out.write(QJsonDocument{results}.toJson()) < 0) {
+      std::fprintf(stderr, "Cannot write %s\n", parser.value("json").toUtf8().constData());
+      ret = EXIT_FAILURE;
+    }
+  }
+
+  return ret;
+}
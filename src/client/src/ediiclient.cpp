@@ -0,0 +1,215 @@
+#include <client/ediiclient.h>
+
+#include "persistentconnection.h"
+#include "sharedmemoryload.h"
+#include "traceoutput.h"
+
+#include <edii_ipc_network.h>
+#include <QMutex>
+#include <QPromise>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace edii {
+
+class Client::Private {
+public:
+  typedef std::function<void (PersistentConnection &)> Job;
+
+  explicit Private(const ClientOptions &options);
+  ~Private();
+  LoadResult load(PersistentConnection &conn, const LoadRequest &request, TraceSink *sink);
+  void submit(Job job);
+
+private:
+  void work();
+
+  const ClientOptions m_options;
+
+  QMutex m_lock;
+  QWaitCondition m_jobsAvailable;
+  std::deque<Job> m_jobs;
+  bool m_stopping;
+  std::vector<QThread *> m_workers;
+};
+
+Client::Private::Private(const ClientOptions &options) :
+  m_options{options},
+  m_stopping{false}
+{
+  const int connections = std::max(1, options.connections);
+
+  for (int idx = 0; idx < connections; idx++) {
+    QThread *worker = QThread::create([this]() { work(); });
+
+    worker->start();
+    m_workers.push_back(worker);
+  }
+}
+
+/* Loads that were submitted are finished before the workers stop */
+Client::Private::~Private()
+{
+  {
+    QMutexLocker locker{&m_lock};
+    m_stopping = true;
+  }
+  m_jobsAvailable.wakeAll();
+
+  for (QThread *worker : m_workers) {
+    worker->wait();
+    delete worker;
+  }
+}
+
+LoadResult Client::Private::load(PersistentConnection &conn, const LoadRequest &request, TraceSink *sink)
+{
+  for (int attempt = 0;; attempt++) {
+    LoadResult result{};
+    TraceOutput output{result, sink};
+    int retryAfter = 0;
+
+    /* Memory files need a connection of their own for each load, they are used only when asked for */
+    const bool sharedMemory = m_options.sharedMemory && SharedMemoryLoad::isSupported() && conn.supportsSharedMemory();
+    const bool done = sharedMemory ? SharedMemoryLoad::load(m_options, request, output, result, retryAfter) :
+                                     conn.load(request, output, result, retryAfter);
+    if (done)
+      return result;
+
+    if (attempt >= m_options.busyRetries) {
+      result.ok = false;
+      result.error = "EDII is busy";
+      result.traces.clear();
+      return result;
+    }
+
+    QThread::msleep(retryAfter);
+  }
+}
+
+void Client::Private::submit(Job job)
+{
+  {
+    QMutexLocker locker{&m_lock};
+    m_jobs.push_back(std::move(job));
+  }
+  m_jobsAvailable.wakeOne();
+}
+
+/* Each worker owns one connection so that a connection is never used by two threads */
+void Client::Private::work()
+{
+  PersistentConnection conn{m_options};
+
+  for (;;) {
+    Job job;
+
+    {
+      QMutexLocker locker{&m_lock};
+
+      while (m_jobs.empty() && !m_stopping)
+        m_jobsAvailable.wait(&m_lock);
+      if (m_jobs.empty())
+        return;
+
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    job(conn);
+  }
+}
+
+TraceSink::~TraceSink()
+{
+}
+
+LoadRequest::LoadRequest() :
+  loadOption{0},
+  priority{Priority::INTERACTIVE}
+{
+}
+
+LoadRequest::LoadRequest(const QString &tag, const QString &path, const int loadOption, const Priority priority) :
+  tag{tag},
+  path{path},
+  loadOption{loadOption},
+  priority{priority}
+{
+}
+
+LoadResult::LoadResult() :
+  ok{false}
+{
+}
+
+ClientOptions::ClientOptions() :
+  serverName{EDII_IPCS_SOCKET_NAME},
+  connections{4},
+  timeout{30000},
+  busyRetries{10},
+  sharedMemory{false}
+{
+}
+
+Client::Client(const ClientOptions &options) :
+  d{std::make_unique<Private>(options)}
+{
+}
+
+Client::~Client()
+{
+}
+
+QFuture<LoadResult> Client::loadBatch(const QVector<LoadRequest> &requests)
+{
+  auto promise = std::make_shared<QPromise<LoadResult>>();
+  auto remaining = std::make_shared<std::atomic<int>>(requests.size());
+  QFuture<LoadResult> future = promise->future();
+
+  promise->start();
+  if (requests.isEmpty()) {
+    promise->finish();
+    return future;
+  }
+
+  Private *priv = d.get();
+  for (int idx = 0; idx < requests.size(); idx++) {
+    const LoadRequest request = requests.at(idx);
+
+    priv->submit([priv, promise, remaining, request, idx](PersistentConnection &conn) {
+      promise->addResult(priv->load(conn, request, nullptr), idx);
+      if (--(*remaining) == 0)
+        promise->finish();
+    });
+  }
+
+  return future;
+}
+
+QFuture<LoadResult> Client::loadPath(const LoadRequest &request)
+{
+  return loadPath(request, nullptr);
+}
+
+QFuture<LoadResult> Client::loadPath(const LoadRequest &request, TraceSink *sink)
+{
+  auto promise = std::make_shared<QPromise<LoadResult>>();
+  QFuture<LoadResult> future = promise->future();
+
+  Private *priv = d.get();
+  promise->start();
+  priv->submit([priv, promise, request, sink](PersistentConnection &conn) {
+    promise->addResult(priv->load(conn, request, sink));
+    promise->finish();
+  });
+
+  return future;
+}
+
+} // namespace edii
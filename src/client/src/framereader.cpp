@@ -0,0 +1,181 @@
+#include "framereader.h"
+#include "traceoutput.h"
+
+#include <edii_ipc_network.h>
+#include <algorithm>
+#include <cstring>
+
+/* Frames other than values carry only descriptors and strings */
+#define MAX_DESCRIPTOR_LENGTH (64 * 1024 * 1024)
+#define SKIP_CHUNK_SIZE (64 * 1024)
+
+static
+bool fail(edii::LoadResult &result, const QString &error)
+{
+  result.ok = false;
+  result.error = error;
+
+  return false;
+}
+
+static
+quint64 padding(const quint64 length)
+{
+  return (8 - length % 8) % 8;
+}
+
+FrameReader::FrameReader(Reader reader) :
+  m_reader{std::move(reader)}
+{
+}
+
+bool FrameReader::read(TraceOutput &output, edii::LoadResult &result)
+{
+  static const QString MALFORMED{"Malformed response from EDII"};
+
+  QVector<QVector<double>> axes;
+  double *xValues = nullptr;
+  double *yValues = nullptr;
+  quint64 datapoints = 0;
+
+  result.ok = true;
+
+  for (;;) {
+    EDII_IPCSockFrame frame;
+
+    if (!m_reader(reinterpret_cast<char *>(&frame), sizeof(frame)))
+      return fail(result, "Connection to EDII was lost");
+    if (frame.magic != EDII_IPCS_FRAME_MAGIC)
+      return fail(result, MALFORMED);
+
+    switch (frame.frameType) {
+    case EDII_FRAME_LOAD_DATA_HEADER:
+    {
+      QByteArray payload;
+
+      if (!readPayload(payload, frame.length))
+        return fail(result, MALFORMED);
+      if (payload.size() >= static_cast<qsizetype>(sizeof(EDII_IPCSockLoadDataHeaderV2))) {
+        const auto header = reinterpret_cast<const EDII_IPCSockLoadDataHeaderV2 *>(payload.constData());
+        result.traces.reserve(std::min<quint64>(header->items, 1 << 16));
+      }
+    }
+      break;
+    case EDII_FRAME_ERROR:
+    {
+      QByteArray payload;
+
+      if (!readPayload(payload, frame.length))
+        return fail(result, MALFORMED);
+      result.ok = false;
+      result.error = QString::fromUtf8(payload);
+    }
+      break;
+    case EDII_FRAME_AXIS:
+    {
+      if (frame.length % sizeof(double) != 0)
+        return fail(result, MALFORMED);
+
+      QVector<double> axis(frame.length / sizeof(double));
+      if (!readValues(axis.data(), frame.length))
+        return fail(result, MALFORMED);
+      axes.append(axis);
+    }
+      break;
+    case EDII_FRAME_TRACE:
+    {
+      static const quint64 DESC_SIZE = sizeof(EDII_IPCSockTraceDescriptorV2);
+      QByteArray payload;
+
+      if (!readPayload(payload, frame.length) || static_cast<quint64>(payload.size()) < DESC_SIZE)
+        return fail(result, MALFORMED);
+
+      EDII_IPCSockTraceDescriptorV2 desc;
+      std::memcpy(&desc, payload.constData(), DESC_SIZE);
+      if (desc.descriptorLength < DESC_SIZE)
+        return fail(result, MALFORMED);
+
+      /* Descriptors of newer servers may be longer, the strings follow them */
+      const quint64 lengths[] = { desc.nameLength, desc.dataIdLength, desc.pathLength, desc.xDescriptionLength,
+                                  desc.yDescriptionLength, desc.xUnitLength, desc.yUnitLength };
+      QString strings[7];
+      quint64 offset = desc.descriptorLength;
+      for (int idx = 0; idx < 7; idx++) {
+        if (lengths[idx] > static_cast<quint64>(payload.size()) - std::min<quint64>(offset, payload.size()))
+          return fail(result, MALFORMED);
+        strings[idx] = QString::fromUtf8(payload.constData() + offset, lengths[idx]);
+        offset += lengths[idx];
+      }
+
+      const edii::TraceInfo info{strings[0], strings[1], strings[2], strings[3], strings[4], strings[5], strings[6],
+                                 static_cast<qint64>(desc.datapoints)};
+      datapoints = desc.datapoints;
+
+      bool accepted;
+      if (desc.axisId == EDII_IPCS_NO_AXIS) {
+        accepted = output.beginTrace(info, xValues, yValues);
+      } else {
+        if (desc.axisId >= static_cast<quint64>(axes.size()))
+          return fail(result, MALFORMED);
+        xValues = nullptr;
+        accepted = output.beginTraceWithAxis(info, axes.at(desc.axisId), yValues);
+      }
+      if (!accepted)
+        return fail(result, "Load was aborted");
+    }
+      break;
+    case EDII_FRAME_X_VALUES:
+    case EDII_FRAME_Y_VALUES:
+    {
+      double *&values = frame.frameType == EDII_FRAME_X_VALUES ? xValues : yValues;
+
+      if (frame.length != sizeof(double) * datapoints || !readValues(values, frame.length))
+        return fail(result, MALFORMED);
+      values = nullptr;
+    }
+      break;
+    case EDII_FRAME_END:
+      return skip(padding(frame.length)) || fail(result, MALFORMED);
+    default:
+      if (!skip(frame.length))
+        return fail(result, MALFORMED);
+      break;
+    }
+
+    if (!skip(padding(frame.length)))
+      return fail(result, MALFORMED);
+  }
+}
+
+bool FrameReader::readPayload(QByteArray &payload, const quint64 length)
+{
+  if (length > MAX_DESCRIPTOR_LENGTH)
+    return false;
+
+  payload.resize(length);
+  return m_reader(payload.data(), length);
+}
+
+/* Null values skip the values */
+bool FrameReader::readValues(double *values, const quint64 length)
+{
+  if (values == nullptr)
+    return skip(length);
+
+  return m_reader(reinterpret_cast<char *>(values), length);
+}
+
+bool FrameReader::skip(quint64 length)
+{
+  char scratch[SKIP_CHUNK_SIZE];
+
+  while (length > 0) {
+    const quint64 n = std::min<quint64>(length, SKIP_CHUNK_SIZE);
+
+    if (!m_reader(scratch, n))
+      return false;
+    length -= n;
+  }
+
+  return true;
+}
@@ -0,0 +1,30 @@
+#ifndef FRAMEREADER_H
+#define FRAMEREADER_H
+
+#include <client/ediiclient.h>
+#include <functional>
+
+class TraceOutput;
+
+/*
+ * Reads a load data response sent in v2 framing, see
+ * EDII_IPCS_LOAD_FLAG_FRAMING_V2. Values are read straight into the buffers
+ * of the output. Frames of unknown types are skipped.
+ */
+class FrameReader {
+public:
+  /* Reads exactly the given number of bytes of the response */
+  typedef std::function<bool (char *, qint64)> Reader;
+
+  explicit FrameReader(Reader reader);
+  bool read(TraceOutput &output, edii::LoadResult &result);
+
+private:
+  bool readPayload(QByteArray &payload, const quint64 length);
+  bool readValues(double *values, const quint64 length);
+  bool skip(quint64 length);
+
+  const Reader m_reader;
+};
+
+#endif // FRAMEREADER_H
@@ -0,0 +1,108 @@
+#include "itemreader.h"
+#include "traceoutput.h"
+
+#include <edii_ipc_network.h>
+#include <algorithm>
+
+/* Datapoints are deinterleaved in blocks of this many points */
+#define DATAPOINT_BLOCK 4096
+
+static
+bool fail(edii::LoadResult &result, const QString &error)
+{
+  result.ok = false;
+  result.error = error;
+
+  return false;
+}
+
+ItemReader::ItemReader(Reader reader) :
+  m_reader{std::move(reader)}
+{
+}
+
+bool ItemReader::read(TraceOutput &output, edii::LoadResult &result)
+{
+  static const QString MALFORMED{"Malformed response from EDII"};
+
+  EDII_IPCSockResponseHeader header;
+
+  result.ok = true;
+
+  if (!m_reader(reinterpret_cast<char *>(&header), sizeof(header)))
+    return fail(result, "Connection to EDII was lost");
+  if (header.magic != EDII_IPCS_PACKET_MAGIC || header.responseType != EDII_RESPONSE_LOAD_DATA_HEADER)
+    return fail(result, MALFORMED);
+
+  if (header.status != EDII_IPCS_SUCCESS) {
+    QByteArray message{static_cast<qsizetype>(header.errorLength), Qt::Uninitialized};
+
+    if (!m_reader(message.data(), message.size()))
+      return fail(result, MALFORMED);
+    result.ok = false;
+    result.error = QString::fromUtf8(message);
+    return true;
+  }
+
+  result.traces.reserve(std::clamp(header.items, 0, 1 << 16));
+  for (int idx = 0; idx < header.items; idx++) {
+    edii::TraceInfo info;
+    double *xValues = nullptr;
+    double *yValues = nullptr;
+
+    if (!readTraceInfo(info))
+      return fail(result, MALFORMED);
+    if (!output.beginTrace(info, xValues, yValues))
+      return fail(result, "Load was aborted");
+    if (!readDatapoints(info.datapoints, xValues, yValues))
+      return fail(result, MALFORMED);
+  }
+
+  return true;
+}
+
+/* Null buffers skip the values */
+bool ItemReader::readDatapoints(const qint64 count, double *xValues, double *yValues)
+{
+  EDII_IPCSockDatapoint block[DATAPOINT_BLOCK];
+
+  for (qint64 offset = 0; offset < count; offset += DATAPOINT_BLOCK) {
+    const qint64 n = std::min<qint64>(count - offset, DATAPOINT_BLOCK);
+
+    if (!m_reader(reinterpret_cast<char *>(block), sizeof(EDII_IPCSockDatapoint) * n))
+      return false;
+
+    for (qint64 idx = 0; idx < n; idx++) {
+      if (xValues != nullptr)
+        xValues[offset + idx] = block[idx].x;
+      if (yValues != nullptr)
+        yValues[offset + idx] = block[idx].y;
+    }
+  }
+
+  return true;
+}
+
+bool ItemReader::readTraceInfo(edii::TraceInfo &info)
+{
+  EDII_IPCSockLoadDataResponseDescriptor desc;
+
+  if (!m_reader(reinterpret_cast<char *>(&desc), sizeof(desc)) || desc.magic != EDII_IPCS_PACKET_MAGIC ||
+      desc.responseType != EDII_RESPONSE_LOAD_DATA_DESCRIPTOR)
+    return false;
+
+  const uint32_t lengths[] = { desc.nameLength, desc.dataIdLength, desc.pathLength, desc.xDescriptionLength,
+                               desc.yDescriptionLength, desc.xUnitLength, desc.yUnitLength };
+  QString *strings[] = { &info.name, &info.dataId, &info.path, &info.xDescription,
+                         &info.yDescription, &info.xUnit, &info.yUnit };
+  for (int idx = 0; idx < 7; idx++) {
+    QByteArray raw{static_cast<qsizetype>(lengths[idx]), Qt::Uninitialized};
+
+    if (!m_reader(raw.data(), raw.size()))
+      return false;
+    *strings[idx] = QString::fromUtf8(raw);
+  }
+  info.datapoints = desc.datapointsLength;
+
+  return true;
+}
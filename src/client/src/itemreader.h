@@ -0,0 +1,29 @@
+#ifndef ITEMREADER_H
+#define ITEMREADER_H
+
+#include <client/ediiclient.h>
+#include <functional>
+
+class TraceOutput;
+
+/*
+ * Reads a load data response sent as the items of the original protocol,
+ * which servers older than ABI 0.14 send instead of v2 framing. Responses
+ * to requests with load flags are not understood. Values are read straight
+ * into the buffers of the output.
+ */
+class ItemReader {
+public:
+  /* Reads exactly the given number of bytes of the response */
+  typedef std::function<bool (char *, qint64)> Reader;
+
+  explicit ItemReader(Reader reader);
+  bool read(TraceOutput &output, edii::LoadResult &result);
+  bool readDatapoints(const qint64 count, double *xValues, double *yValues);
+  bool readTraceInfo(edii::TraceInfo &info);
+
+private:
+  const Reader m_reader;
+};
+
+#endif // ITEMREADER_H
@@ -0,0 +1,311 @@
+#include "persistentconnection.h"
+#include "framereader.h"
+#include "itemreader.h"
+#include "requestwriter.h"
+#include "traceoutput.h"
+
+#include <edii_ipc_network.h>
+#include <QLocalSocket>
+#include <algorithm>
+
+/* ABI versions that introduced the parts of the protocol the connection uses */
+#define PRIORITY_ABI_VERSION_MINOR 3
+#define PERSISTENT_ABI_VERSION_MINOR 8
+#define SHARED_MEMORY_ABI_VERSION_MINOR 10
+#define FRAMING_V2_ABI_VERSION_MINOR 14
+#define SKIP_CHUNK_SIZE (64 * 1024)
+
+PersistentConnection::PersistentConnection(const edii::ClientOptions &options) :
+  h_options{options},
+  m_socket{nullptr},
+  m_nextRequestId{1},
+  m_serverMinor{-1},
+  m_persistent{false},
+  m_requestId{0},
+  m_partRemaining{0},
+  m_lastPart{true},
+  m_status{0},
+  m_broken{false}
+{
+}
+
+PersistentConnection::~PersistentConnection()
+{
+  disconnect();
+}
+
+/* Asks the server what it supports, the connection is kept only if the server keeps it open */
+bool PersistentConnection::connect(QString &error)
+{
+  if (!open(error))
+    return false;
+
+  EDII_IPCSockResponseABIVersionExt resp;
+  if (!writeSocket(RequestWriter::abiVersion(EDII_IPCS_CAP_PERSISTENT | EDII_IPCS_CAP_STREAMING)) ||
+      !readSocket(reinterpret_cast<char *>(&resp), sizeof(resp)) ||
+      resp.magic != EDII_IPCS_PACKET_MAGIC || resp.responseType != EDII_RESPONSE_ABI_VERSION_EXT) {
+    /* Servers older than ABI 0.8 close connections with requests they do not know */
+    disconnect();
+    return probeVersion(error);
+  }
+
+  if (resp.major != EDII_ABI_VERSION_MAJOR) {
+    error = QString{"Unsupported version of EDII interface %1.%2"}.arg(resp.major).arg(resp.minor);
+    disconnect();
+    return false;
+  }
+
+  m_serverMinor = resp.minor;
+  m_persistent = resp.capabilities & EDII_IPCS_CAP_PERSISTENT;
+  if (!m_persistent)
+    disconnect();
+
+  return true;
+}
+
+void PersistentConnection::disconnect()
+{
+  delete m_socket;
+  m_socket = nullptr;
+}
+
+bool PersistentConnection::load(const edii::LoadRequest &request, TraceOutput &output, edii::LoadResult &result, int &retryAfter)
+{
+  if ((m_serverMinor < 0 || (m_persistent && m_socket == nullptr)) && !connect(result.error)) {
+    result.ok = false;
+    return true;
+  }
+
+  if (!m_persistent)
+    return loadDirect(request, output, result);
+
+  m_requestId = m_nextRequestId++;
+  m_partRemaining = 0;
+  m_lastPart = false;
+
+  const bool framingV2 = m_serverMinor >= FRAMING_V2_ABI_VERSION_MINOR;
+  const uint32_t flags = framingV2 ? EDII_IPCS_LOAD_FLAG_FRAMING_V2 | EDII_IPCS_LOAD_FLAG_SHARED_AXES : 0;
+  const QByteArray req = RequestWriter::loadPath(request, flags);
+  if (!writeSocket(RequestWriter::envelope(m_requestId, req)) || !nextPart()) {
+    result.ok = false;
+    result.error = "Connection to EDII was lost";
+    disconnect();
+    return true;
+  }
+
+  if (m_status == EDII_IPCS_BUSY) {
+    EDII_IPCSockBusyResponse busy;
+
+    if (!readResponse(reinterpret_cast<char *>(&busy), sizeof(busy)) || !skipResponse()) {
+      disconnect();
+      result.ok = false;
+      result.error = "Connection to EDII was lost";
+      return true;
+    }
+
+    retryAfter = std::max<int>(1, busy.retryAfter);
+    return false;
+  }
+
+  const auto responseReader = [this](char *data, const qint64 length) { return readResponse(data, length); };
+  bool read;
+  if (framingV2) {
+    FrameReader reader{responseReader};
+    read = reader.read(output, result);
+  } else {
+    ItemReader reader{responseReader};
+    read = reader.read(output, result);
+  }
+  if (!read) {
+    /* A response that ended early was refused by the server, the connection is still fine */
+    if (!m_broken && m_lastPart && m_partRemaining == 0 && m_status != EDII_IPCS_SUCCESS)
+      result.error = "EDII could not handle the request";
+    else
+      m_broken = true;
+  }
+
+  if (m_broken || !skipResponse())
+    disconnect();
+
+  return true;
+}
+
+/* Loads over a connection of its own that the server closes after the response */
+bool PersistentConnection::loadDirect(const edii::LoadRequest &request, TraceOutput &output, edii::LoadResult &result)
+{
+  if (!open(result.error)) {
+    result.ok = false;
+    m_serverMinor = -1;
+    return true;
+  }
+
+  const QByteArray req = m_serverMinor >= PRIORITY_ABI_VERSION_MINOR ? RequestWriter::loadPath(request, 0) :
+                                                                       RequestWriter::legacyLoadPath(request);
+  if (writeSocket(req)) {
+    ItemReader reader{[this](char *data, const qint64 length) { return readSocket(data, length); }};
+    reader.read(output, result);
+  } else {
+    result.ok = false;
+    result.error = "Connection to EDII was lost";
+    m_broken = true;
+  }
+
+  /* The server may have been upgraded in the meantime */
+  if (m_broken)
+    m_serverMinor = -1;
+  disconnect();
+
+  return true;
+}
+
+/* Reads the envelope of the next part of the response */
+bool PersistentConnection::nextPart()
+{
+  EDII_IPCSockEnvelope envelope;
+
+  if (!readSocket(reinterpret_cast<char *>(&envelope), sizeof(envelope)))
+    return false;
+
+  if (envelope.magic != EDII_IPCS_PACKET_MAGIC || envelope.requestId != m_requestId ||
+      (envelope.envelopeType != EDII_ENVELOPE_RESPONSE && envelope.envelopeType != EDII_ENVELOPE_RESPONSE_PART)) {
+    m_broken = true;
+    return false;
+  }
+
+  m_partRemaining = envelope.length;
+  m_lastPart = envelope.envelopeType == EDII_ENVELOPE_RESPONSE;
+  m_status = envelope.status;
+
+  return true;
+}
+
+bool PersistentConnection::open(QString &error)
+{
+  m_socket = new QLocalSocket{};
+  m_broken = false;
+
+  m_socket->connectToServer(h_options.serverName);
+  if (!m_socket->waitForConnected(h_options.timeout)) {
+    error = QString{"Cannot connect to EDII: %1"}.arg(m_socket->errorString());
+    disconnect();
+    return false;
+  }
+
+  return true;
+}
+
+/* Asks for the version the way servers that predate persistent connections understand */
+bool PersistentConnection::probeVersion(QString &error)
+{
+  if (!open(error))
+    return false;
+
+  EDII_IPCSockResponseABIVersion resp;
+  const bool answered = writeSocket(RequestWriter::legacyAbiVersion()) &&
+                        readSocket(reinterpret_cast<char *>(&resp), sizeof(resp)) &&
+                        resp.magic == EDII_IPCS_PACKET_MAGIC && resp.responseType == EDII_RESPONSE_ABI_VERSION;
+  disconnect();
+
+  if (!answered) {
+    error = "Cannot get version of EDII interface";
+    return false;
+  }
+  if (resp.major != EDII_ABI_VERSION_MAJOR) {
+    error = QString{"Unsupported version of EDII interface %1.%2"}.arg(resp.major).arg(resp.minor);
+    return false;
+  }
+  /* A server that knows persistent connections dropped the first one for another reason */
+  if (resp.minor >= PERSISTENT_ABI_VERSION_MINOR) {
+    error = "Connection to EDII was lost";
+    return false;
+  }
+
+  m_serverMinor = resp.minor;
+  m_persistent = false;
+
+  return true;
+}
+
+/* Reads the body of the response across the envelopes of its parts */
+bool PersistentConnection::readResponse(char *data, qint64 length)
+{
+  while (length > 0) {
+    if (m_partRemaining == 0) {
+      if (m_lastPart || !nextPart())
+        return false;
+      continue;
+    }
+
+    const qint64 n = std::min(length, m_partRemaining);
+    if (!readSocket(data, n)) {
+      m_broken = true;
+      return false;
+    }
+
+    data += n;
+    length -= n;
+    m_partRemaining -= n;
+  }
+
+  return true;
+}
+
+bool PersistentConnection::readSocket(char *data, qint64 length)
+{
+  while (length > 0) {
+    if (m_socket->bytesAvailable() == 0 && !m_socket->waitForReadyRead(h_options.timeout)) {
+      m_broken = true;
+      return false;
+    }
+
+    const qint64 r = m_socket->read(data, length);
+    if (r < 0) {
+      m_broken = true;
+      return false;
+    }
+
+    data += r;
+    length -= r;
+  }
+
+  return true;
+}
+
+/* Drops whatever is left of the response so that the next one can be read */
+bool PersistentConnection::skipResponse()
+{
+  char scratch[SKIP_CHUNK_SIZE];
+
+  while (!m_lastPart || m_partRemaining > 0) {
+    if (m_partRemaining == 0) {
+      if (!nextPart())
+        return false;
+      continue;
+    }
+
+    const qint64 n = std::min<qint64>(m_partRemaining, SKIP_CHUNK_SIZE);
+    if (!readSocket(scratch, n))
+      return false;
+    m_partRemaining -= n;
+  }
+
+  return true;
+}
+
+bool PersistentConnection::supportsSharedMemory() const
+{
+  return m_serverMinor >= SHARED_MEMORY_ABI_VERSION_MINOR;
+}
+
+bool PersistentConnection::writeSocket(const QByteArray &bytes)
+{
+  if (m_socket->write(bytes) != bytes.size())
+    return false;
+
+  while (m_socket->bytesToWrite() > 0) {
+    if (!m_socket->waitForBytesWritten(h_options.timeout))
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PERSISTENTCONNECTION_H
+#define PERSISTENTCONNECTION_H
+
+#include <client/ediiclient.h>
+#include <QByteArray>
+
+class QLocalSocket;
+class TraceOutput;
+
+/*
+ * Persistent connection to EDII that carries one request at a time. The
+ * connection is made on first use and again after it was lost, each time
+ * the server is asked what it supports. Responses are read in v2 framing,
+ * either whole or in streamed parts, or as the original items from
+ * servers older than ABI 0.14. Servers older than ABI 0.8 cannot keep
+ * connections open and get a connection for each load. The connection
+ * belongs to the thread that uses it.
+ */
+class PersistentConnection {
+public:
+  explicit PersistentConnection(const edii::ClientOptions &options);
+  ~PersistentConnection();
+
+  PersistentConnection(const PersistentConnection &other) = delete;
+  PersistentConnection & operator=(const PersistentConnection &other) = delete;
+
+  /* Returns false if the server was busy, retryAfter is then the delay it asked for */
+  bool load(const edii::LoadRequest &request, TraceOutput &output, edii::LoadResult &result, int &retryAfter);
+  /* Known after the first load */
+  bool supportsSharedMemory() const;
+
+private:
+  bool connect(QString &error);
+  void disconnect();
+  bool loadDirect(const edii::LoadRequest &request, TraceOutput &output, edii::LoadResult &result);
+  bool nextPart();
+  bool open(QString &error);
+  bool probeVersion(QString &error);
+  bool readResponse(char *data, qint64 length);
+  bool readSocket(char *data, qint64 length);
+  bool skipResponse();
+  bool writeSocket(const QByteArray &bytes);
+
+  const edii::ClientOptions &h_options;
+  QLocalSocket *m_socket;
+  quint32 m_nextRequestId;
+  int m_serverMinor;                    /* ABI minor version of the server, -1 until it is known */
+  bool m_persistent;                    /* The server keeps connections open */
+
+  /* State of the response being read */
+  quint32 m_requestId;
+  qint64 m_partRemaining;               /* Bytes of the current envelope that have not been read */
+  bool m_lastPart;
+  uint8_t m_status;
+  bool m_broken;                        /* The connection cannot be used for further requests */
+};
+
+#endif // PERSISTENTCONNECTION_H
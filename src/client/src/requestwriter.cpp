@@ -0,0 +1,108 @@
+#include "requestwriter.h"
+
+#include <edii_ipc_network.h>
+
+template <typename P>
+void append(QByteArray &bytes, const P &packet)
+{
+  bytes.append(reinterpret_cast<const char *>(&packet), sizeof(packet));
+}
+
+QByteArray RequestWriter::abiVersion(const uint32_t capabilities)
+{
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_ABI_VERSION_EXT;
+
+  EDII_IPCSockABIVersionRequestDescriptor desc;
+  desc.magic = EDII_IPCS_PACKET_MAGIC;
+  desc.requestType = EDII_REQUEST_ABI_VERSION_DESCRIPTOR;
+  desc.capabilities = capabilities;
+
+  QByteArray bytes;
+  append(bytes, header);
+  append(bytes, desc);
+
+  return bytes;
+}
+
+QByteArray RequestWriter::envelope(const quint32 requestId, const QByteArray &request)
+{
+  EDII_IPCSockEnvelope envelope;
+  envelope.magic = EDII_IPCS_PACKET_MAGIC;
+  envelope.envelopeType = EDII_ENVELOPE_REQUEST;
+  envelope.status = 0;
+  envelope.requestId = requestId;
+  envelope.length = request.size();
+
+  QByteArray bytes;
+  append(bytes, envelope);
+  bytes.append(request);
+
+  return bytes;
+}
+
+QByteArray RequestWriter::legacyAbiVersion()
+{
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_ABI_VERSION;
+
+  QByteArray bytes;
+  append(bytes, header);
+
+  return bytes;
+}
+
+QByteArray RequestWriter::legacyLoadPath(const edii::LoadRequest &request)
+{
+  const QByteArray tag = request.tag.toUtf8();
+  const QByteArray path = request.path.toUtf8();
+
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_LOAD_DATA;
+
+  EDII_IPCSockLoadDataRequestDescriptor desc;
+  desc.magic = EDII_IPCS_PACKET_MAGIC;
+  desc.requestType = EDII_REQUEST_LOAD_DATA_DESCRIPTOR;
+  desc.mode = EDII_IPCS_LOAD_FILE;
+  desc.loadOption = request.loadOption;
+  desc.tagLength = tag.size();
+  desc.filePathLength = path.size();
+
+  QByteArray bytes;
+  append(bytes, header);
+  append(bytes, desc);
+  bytes.append(tag);
+  bytes.append(path);
+
+  return bytes;
+}
+
+QByteArray RequestWriter::loadPath(const edii::LoadRequest &request, const uint32_t flags)
+{
+  const QByteArray tag = request.tag.toUtf8();
+  const QByteArray path = request.path.toUtf8();
+
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_LOAD_DATA;
+
+  EDII_IPCSockLoadDataRequestDescriptorExt desc;
+  desc.magic = EDII_IPCS_PACKET_MAGIC;
+  desc.requestType = EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT;
+  desc.mode = EDII_IPCS_LOAD_FILE;
+  desc.loadOption = request.loadOption;
+  desc.tagLength = tag.size();
+  desc.filePathLength = path.size();
+  desc.flags = flags | ((static_cast<uint32_t>(request.priority) << EDII_IPCS_LOAD_PRIORITY_SHIFT) & EDII_IPCS_LOAD_PRIORITY_MASK);
+
+  QByteArray bytes;
+  append(bytes, header);
+  append(bytes, desc);
+  bytes.append(tag);
+  bytes.append(path);
+
+  return bytes;
+}
@@ -0,0 +1,21 @@
+#ifndef REQUESTWRITER_H
+#define REQUESTWRITER_H
+
+#include <client/ediiclient.h>
+#include <QByteArray>
+
+/*
+ * Serializes requests of the local socket protocol, see edii_ipc_network.h.
+ */
+class RequestWriter {
+public:
+  static QByteArray abiVersion(const uint32_t capabilities);
+  static QByteArray envelope(const quint32 requestId, const QByteArray &request);
+  static QByteArray loadPath(const edii::LoadRequest &request, const uint32_t flags);
+
+  /* Requests understood by servers older than ABI 0.8 and 0.3 respectively */
+  static QByteArray legacyAbiVersion();
+  static QByteArray legacyLoadPath(const edii::LoadRequest &request);
+};
+
+#endif // REQUESTWRITER_H
@@ -0,0 +1,323 @@
+#include "sharedmemoryload.h"
+#include "itemreader.h"
+#include "requestwriter.h"
+#include "traceoutput.h"
+
+#include <edii_ipc_network.h>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+  #include <errno.h>
+  #include <sys/mman.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif // Q_OS_LINUX
+
+#ifdef Q_OS_LINUX
+
+/* Owns the socket, the received descriptor and the mapping of the memory file */
+class SharedMemoryResources {
+public:
+  SharedMemoryResources() :
+    sock{-1},
+    fd{-1},
+    mem{nullptr},
+    size{0}
+  {}
+
+  ~SharedMemoryResources()
+  {
+    if (mem != nullptr)
+      ::munmap(mem, size);
+    if (fd >= 0)
+      ::close(fd);
+    if (sock >= 0)
+      ::close(sock);
+  }
+
+  int sock;
+  int fd;
+  void *mem;
+  size_t size;
+};
+
+/* QLocalServer places sockets with relative names in the temporary directory */
+static
+QByteArray socketPath(const QString &serverName)
+{
+  if (serverName.startsWith('/'))
+    return QFile::encodeName(serverName);
+  return QFile::encodeName(QDir::tempPath() + "/" + serverName);
+}
+
+static
+int connectSocket(const edii::ClientOptions &options, QString &error)
+{
+  const QByteArray path = socketPath(options.serverName);
+  struct sockaddr_un addr;
+
+  if (path.size() >= static_cast<qsizetype>(sizeof(addr.sun_path))) {
+    error = "Path to the socket of EDII is too long";
+    return -1;
+  }
+
+  const int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) {
+    error = QString{"Cannot create socket: %1"}.arg(std::strerror(errno));
+    return -1;
+  }
+
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.constData(), path.size());
+
+  struct timeval tv;
+  tv.tv_sec = options.timeout / 1000;
+  tv.tv_usec = (options.timeout % 1000) * 1000;
+  ::setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  ::setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+  if (::connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+    error = QString{"Cannot connect to EDII: %1"}.arg(std::strerror(errno));
+    ::close(sock);
+    return -1;
+  }
+
+  return sock;
+}
+
+static
+bool recvAll(const int sock, void *data, size_t length)
+{
+  char *p = static_cast<char *>(data);
+
+  while (length > 0) {
+    const ssize_t r = ::recv(sock, p, length, 0);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      return false;
+
+    p += r;
+    length -= r;
+  }
+
+  return true;
+}
+
+/* The descriptor comes with the first byte of the response, fd stays -1 if there is none */
+static
+bool recvWithDescriptor(const int sock, void *data, const size_t length, int &fd)
+{
+  char control[CMSG_SPACE(sizeof(int))];
+  struct iovec iov;
+  struct msghdr msg;
+  ssize_t r;
+
+  std::memset(control, 0, sizeof(control));
+  std::memset(&msg, 0, sizeof(msg));
+  iov.iov_base = data;
+  iov.iov_len = length;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  do {
+    r = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+  } while (r < 0 && errno == EINTR);
+  if (r <= 0)
+    return false;
+
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+      std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  }
+
+  return recvAll(sock, static_cast<char *>(data) + r, length - r);
+}
+
+static
+bool sendAll(const int sock, const QByteArray &bytes)
+{
+  const char *p = bytes.constData();
+  size_t length = bytes.size();
+
+  while (length > 0) {
+    const ssize_t r = ::send(sock, p, length, MSG_NOSIGNAL);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      return false;
+
+    p += r;
+    length -= r;
+  }
+
+  return true;
+}
+
+static
+bool fits(const SharedMemoryResources &res, const quint64 offset, const qint64 count)
+{
+  const quint64 bytes = sizeof(double) * static_cast<quint64>(count);
+
+  return offset <= res.size && bytes <= res.size - offset;
+}
+
+#endif // Q_OS_LINUX
+
+bool SharedMemoryLoad::isSupported()
+{
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif // Q_OS_LINUX
+}
+
+bool SharedMemoryLoad::load(const edii::ClientOptions &options, const edii::LoadRequest &request, TraceOutput &output,
+                            edii::LoadResult &result, int &retryAfter)
+{
+#ifdef Q_OS_LINUX
+  static const QString MALFORMED{"Malformed response from EDII"};
+
+  SharedMemoryResources res;
+
+  result.ok = false;
+
+  res.sock = connectSocket(options, result.error);
+  if (res.sock < 0)
+    return true;
+
+  if (!sendAll(res.sock, RequestWriter::loadPath(request, EDII_IPCS_LOAD_FLAG_SHARED_MEMORY))) {
+    result.error = "Cannot send request to EDII";
+    return true;
+  }
+
+  /* Magic, type and status are common to the header and to the busy response */
+  EDII_IPCSockResponseHeader header;
+  static const size_t COMMON_SIZE = sizeof(header.magic) + sizeof(header.responseType) + sizeof(header.status);
+  if (!recvWithDescriptor(res.sock, &header, COMMON_SIZE, res.fd) || header.magic != EDII_IPCS_PACKET_MAGIC) {
+    result.error = "Connection to EDII was lost";
+    return true;
+  }
+
+  if (header.responseType == EDII_RESPONSE_BUSY) {
+    EDII_IPCSockBusyResponse busy;
+
+    std::memcpy(&busy, &header, COMMON_SIZE);
+    if (!recvAll(res.sock, reinterpret_cast<char *>(&busy) + COMMON_SIZE, sizeof(busy) - COMMON_SIZE)) {
+      result.error = "Connection to EDII was lost";
+      return true;
+    }
+
+    retryAfter = std::max<int>(1, busy.retryAfter);
+    return false;
+  }
+
+  if (header.responseType != EDII_RESPONSE_LOAD_DATA_HEADER ||
+      !recvAll(res.sock, reinterpret_cast<char *>(&header) + COMMON_SIZE, sizeof(header) - COMMON_SIZE)) {
+    result.error = MALFORMED;
+    return true;
+  }
+
+  if (header.status != EDII_IPCS_SUCCESS) {
+    QByteArray message{static_cast<qsizetype>(header.errorLength), Qt::Uninitialized};
+
+    result.error = recvAll(res.sock, message.data(), message.size()) ? QString::fromUtf8(message) : MALFORMED;
+    return true;
+  }
+
+  if (res.fd >= 0) {
+    EDII_IPCSockSharedMemoryDescriptor shmDesc;
+
+    if (!recvAll(res.sock, &shmDesc, sizeof(shmDesc)) || shmDesc.responseType != EDII_RESPONSE_SHARED_MEMORY) {
+      result.error = MALFORMED;
+      return true;
+    }
+
+    res.size = shmDesc.size;
+    if (res.size > 0) {
+      res.mem = ::mmap(nullptr, res.size, PROT_READ, MAP_SHARED, res.fd, 0);
+      if (res.mem == MAP_FAILED) {
+        res.mem = nullptr;
+        result.error = QString{"Cannot map shared memory file: %1"}.arg(std::strerror(errno));
+        return true;
+      }
+    }
+  }
+
+  const char *mem = static_cast<const char *>(res.mem);
+  const int sock = res.sock;
+  ItemReader reader{[sock](char *data, const qint64 length) { return recvAll(sock, data, length); }};
+  QHash<quint64, QVector<double>> axes;
+  for (int idx = 0; idx < header.items; idx++) {
+    edii::TraceInfo info;
+    double *xValues = nullptr;
+    double *yValues = nullptr;
+
+    if (!reader.readTraceInfo(info)) {
+      result.error = MALFORMED;
+      return true;
+    }
+
+    if (res.fd < 0) {
+      if (!output.beginTrace(info, xValues, yValues)) {
+        result.error = "Load was aborted";
+        return true;
+      }
+      if (!reader.readDatapoints(info.datapoints, xValues, yValues)) {
+        result.error = MALFORMED;
+        return true;
+      }
+      continue;
+    }
+
+    EDII_IPCSockSharedMemoryTraceDescriptor traceDesc;
+    if (!recvAll(res.sock, &traceDesc, sizeof(traceDesc)) || traceDesc.responseType != EDII_RESPONSE_SHARED_MEMORY_TRACE ||
+        !fits(res, traceDesc.xOffset, info.datapoints) || !fits(res, traceDesc.yOffset, info.datapoints)) {
+      result.error = MALFORMED;
+      return true;
+    }
+
+    const size_t bytes = sizeof(double) * info.datapoints;
+    bool accepted;
+    if (output.isColumnar()) {
+      /* Traces placed at the same X offset share their X values */
+      auto it = axes.find(traceDesc.xOffset);
+      if (it == axes.end()) {
+        QVector<double> axis(info.datapoints);
+        if (bytes > 0)
+          std::memcpy(axis.data(), mem + traceDesc.xOffset, bytes);
+        it = axes.insert(traceDesc.xOffset, axis);
+      }
+      accepted = output.beginTraceWithAxis(info, *it, yValues);
+    } else {
+      accepted = output.beginTrace(info, xValues, yValues);
+      if (accepted && xValues != nullptr && bytes > 0)
+        std::memcpy(xValues, mem + traceDesc.xOffset, bytes);
+    }
+    if (!accepted) {
+      result.error = "Load was aborted";
+      return true;
+    }
+    if (yValues != nullptr && bytes > 0)
+      std::memcpy(yValues, mem + traceDesc.yOffset, bytes);
+  }
+
+  result.ok = true;
+  return true;
+#else
+  Q_UNUSED(options); Q_UNUSED(request); Q_UNUSED(output); Q_UNUSED(retryAfter);
+
+  result.ok = false;
+  result.error = "Shared memory is not supported on this platform";
+  return true;
+#endif // Q_OS_LINUX
+}
@@ -0,0 +1,24 @@
+#ifndef SHAREDMEMORYLOAD_H
+#define SHAREDMEMORYLOAD_H
+
+#include <client/ediiclient.h>
+
+class TraceOutput;
+
+/*
+ * Loads a file over a connection of its own and receives the values in a
+ * sealed memory file, see EDII_IPCS_LOAD_FLAG_SHARED_MEMORY. The values are
+ * copied from the mapped file straight into the buffers of the output.
+ * Values of a server that cannot create the file arrive in the socket as
+ * datapoints and are read as well. Supported on Linux only.
+ */
+class SharedMemoryLoad {
+public:
+  static bool isSupported();
+
+  /* Returns false if the server was busy, retryAfter is then the delay it asked for */
+  static bool load(const edii::ClientOptions &options, const edii::LoadRequest &request, TraceOutput &output,
+                   edii::LoadResult &result, int &retryAfter);
+};
+
+#endif // SHAREDMEMORYLOAD_H
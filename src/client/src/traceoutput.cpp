@@ -0,0 +1,69 @@
+#include "traceoutput.h"
+
+#include <cstring>
+#include <utility>
+
+TraceOutput::TraceOutput(edii::LoadResult &result, edii::TraceSink *sink) :
+  h_result{result},
+  m_sink{sink}
+{
+}
+
+bool TraceOutput::beginTrace(const edii::TraceInfo &info, double *&xValues, double *&yValues)
+{
+  const int index = h_result.traces.size();
+  edii::Trace trace;
+  static_cast<edii::TraceInfo &>(trace) = info;
+
+  xValues = nullptr;
+  yValues = nullptr;
+
+  if (m_sink != nullptr) {
+    h_result.traces.append(trace);
+    return m_sink->beginTrace(index, info, xValues, yValues);
+  }
+
+  /* Buffers of the columns stay in place when the list of traces grows,
+   * the trace is moved so that taking the buffers does not detach them */
+  trace.xValues.resize(info.datapoints);
+  trace.yValues.resize(info.datapoints);
+  h_result.traces.append(std::move(trace));
+
+  edii::Trace &added = h_result.traces.last();
+  xValues = added.xValues.data();
+  yValues = added.yValues.data();
+
+  return true;
+}
+
+/* Columns share the values of the axis, sinks get their own copy */
+bool TraceOutput::beginTraceWithAxis(const edii::TraceInfo &info, const QVector<double> &axis, double *&yValues)
+{
+  if (axis.size() != info.datapoints)
+    return false;
+
+  if (m_sink != nullptr) {
+    double *xValues = nullptr;
+
+    if (!beginTrace(info, xValues, yValues))
+      return false;
+    if (xValues != nullptr)
+      std::memcpy(xValues, axis.constData(), sizeof(double) * axis.size());
+    return true;
+  }
+
+  edii::Trace trace;
+  static_cast<edii::TraceInfo &>(trace) = info;
+  trace.xValues = axis;
+  trace.yValues.resize(info.datapoints);
+  h_result.traces.append(std::move(trace));
+
+  yValues = h_result.traces.last().yValues.data();
+
+  return true;
+}
+
+bool TraceOutput::isColumnar() const
+{
+  return m_sink == nullptr;
+}
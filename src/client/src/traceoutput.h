@@ -0,0 +1,23 @@
+#ifndef TRACEOUTPUT_H
+#define TRACEOUTPUT_H
+
+#include <client/ediiclient.h>
+
+/*
+ * Destination of the values of the traces of a load. Values go either to
+ * columns of the result or to buffers provided by a TraceSink. Readers ask
+ * for the buffers of a trace and write the values into them.
+ */
+class TraceOutput {
+public:
+  explicit TraceOutput(edii::LoadResult &result, edii::TraceSink *sink);
+  bool beginTrace(const edii::TraceInfo &info, double *&xValues, double *&yValues);
+  bool beginTraceWithAxis(const edii::TraceInfo &info, const QVector<double> &axis, double *&yValues);
+  bool isColumnar() const;
+
+private:
+  edii::LoadResult &h_result;
+  edii::TraceSink *m_sink;
+};
+
+#endif // TRACEOUTPUT_H
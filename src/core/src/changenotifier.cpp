@@ -0,0 +1,183 @@
+#include "changenotifier.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+
+bool ChangeNotifier::Stamp::operator==(const Stamp &other) const
+{
+  return size == other.size && modified == other.modified && exists == other.exists;
+}
+
+ChangeNotifier::ChangeNotifier(const ServiceConfig::Subscriptions &config, QObject *parent) :
+  QObject{parent},
+  m_config{config},
+  m_watcher{nullptr},
+  m_nextId{1}
+{
+  m_coalesceTimer = new QTimer{this};
+
+  /* Pending changes are checked a few times per coalescing period */
+  m_coalesceTimer->setInterval(std::clamp(std::min(m_config.coalesceTime, m_config.maxDelay) / 4, 10, 250));
+
+  connect(m_coalesceTimer, &QTimer::timeout, this, &ChangeNotifier::onCoalesceTimeout);
+}
+
+void ChangeNotifier::markChanged(const QString &path)
+{
+  auto it = m_files.find(path);
+  if (it == m_files.end())
+    return;
+
+  if (!it->pending) {
+    it->pending = true;
+    it->firstChange.start();
+  }
+  it->lastChange.start();
+
+  if (!m_coalesceTimer->isActive())
+    m_coalesceTimer->start();
+}
+
+void ChangeNotifier::onCoalesceTimeout()
+{
+  QHash<QString, Change> changed;
+  bool stillPending = false;
+
+  for (auto it = m_files.begin(); it != m_files.end(); ++it) {
+    if (!it->pending)
+      continue;
+
+    if (it->lastChange.elapsed() < m_config.coalesceTime && it->firstChange.elapsed() < m_config.maxDelay) {
+      stillPending = true;
+      continue;
+    }
+
+    it->pending = false;
+
+    const Stamp stamp = stampOf(it.key());
+    if (stamp == it->stamp)
+      continue;
+
+    it->stamp = stamp;
+    changed.insert(it.key(), Change{stamp.size, stamp.modified, !stamp.exists});
+  }
+
+  if (!stillPending)
+    m_coalesceTimer->stop();
+
+  if (changed.isEmpty())
+    return;
+
+  /* Listeners may unwatch files, they are called only after the walk over the watches */
+  QVector<std::pair<Listener, Change>> calls;
+  for (auto it = m_watches.cbegin(); it != m_watches.cend(); ++it) {
+    const auto cIt = changed.constFind(it->path);
+    if (cIt != changed.cend())
+      calls.append({it->listener, *cIt});
+  }
+
+  for (const auto &call : calls)
+    call.first(call.second);
+}
+
+void ChangeNotifier::onDirectoryChanged(const QString &path)
+{
+  /* Files that were created again or replaced by a rename must be watched anew */
+  const QStringList watchedFiles = m_watcher->files();
+
+  for (auto it = m_files.cbegin(); it != m_files.cend(); ++it) {
+    const QString &filePath = it.key();
+
+    if (QFileInfo{filePath}.absolutePath() != path)
+      continue;
+
+    if (!watchedFiles.contains(filePath) && QFileInfo::exists(filePath))
+      m_watcher->addPath(filePath);
+    markChanged(filePath);
+  }
+}
+
+void ChangeNotifier::onFileChanged(const QString &path)
+{
+  /* QFileSystemWatcher stops watching files that were removed or replaced */
+  if (!m_watcher->files().contains(path) && QFileInfo::exists(path))
+    m_watcher->addPath(path);
+
+  markChanged(path);
+}
+
+ChangeNotifier::Stamp ChangeNotifier::stampOf(const QString &path)
+{
+  const QFileInfo fi{path};
+
+  if (!fi.exists())
+    return {0, 0, false};
+
+  return {fi.size(), fi.lastModified().toMSecsSinceEpoch(), true};
+}
+
+void ChangeNotifier::unwatch(const int id)
+{
+  const auto wIt = m_watches.find(id);
+  if (wIt == m_watches.end())
+    return;
+
+  const QString path = wIt->path;
+  m_watches.erase(wIt);
+
+  const auto fIt = m_files.find(path);
+  if (--fIt->watches > 0)
+    return;
+
+  m_files.erase(fIt);
+  if (m_watcher->files().contains(path))
+    m_watcher->removePath(path);
+
+  const QString dirPath = QFileInfo{path}.absolutePath();
+  const auto dIt = m_directories.find(dirPath);
+  if (--dIt.value() > 0)
+    return;
+
+  m_directories.erase(dIt);
+  m_watcher->removePath(dirPath);
+}
+
+/* Returns an identifier of the watch or -1 if the directory of the file does not exist */
+int ChangeNotifier::watch(const QString &path, Listener listener)
+{
+  const QFileInfo fi{path};
+  const QString filePath = fi.absoluteFilePath();
+  const QString dirPath = fi.absolutePath();
+
+  if (!QFileInfo{dirPath}.isDir())
+    return -1;
+
+  /* The watcher is set up in the thread the notifier was moved to */
+  if (m_watcher == nullptr) {
+    m_watcher = new QFileSystemWatcher{this};
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &ChangeNotifier::onDirectoryChanged);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &ChangeNotifier::onFileChanged);
+  }
+
+  auto fIt = m_files.find(filePath);
+  if (fIt == m_files.end()) {
+    fIt = m_files.insert(filePath, WatchedFile{stampOf(filePath), 0, false, {}, {}});
+    if (fIt->stamp.exists)
+      m_watcher->addPath(filePath);
+
+    int &inDirectory = m_directories[dirPath];
+    if (inDirectory++ == 0)
+      m_watcher->addPath(dirPath);
+  }
+  fIt->watches++;
+
+  const int id = m_nextId++;
+  m_watches.insert(id, Watch{filePath, std::move(listener)});
+
+  return id;
+}
@@ -0,0 +1,87 @@
+#ifndef CHANGENOTIFIER_H
+#define CHANGENOTIFIER_H
+
+#include "serviceconfig.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <functional>
+
+class QFileSystemWatcher;
+class QTimer;
+
+/*
+ * Tells listeners when watched files change. The operating system reports
+ * every write separately (inotify is used on Linux), a burst of writes is
+ * reported as a single change once the file stays quiet for the coalescing
+ * time or once it has been changing for the maximum delay. Events that leave
+ * the size and modification time of a file as they were are not reported.
+ *
+ * The directory of each file is watched too so that files which are replaced
+ * or created again keep being watched. Listeners are called from the thread
+ * of the notifier, all methods must be called from that thread too.
+ */
+class ChangeNotifier : public QObject
+{
+  Q_OBJECT
+
+public:
+  class Change {
+  public:
+    qint64 size;
+    qint64 modified;                    /* Milliseconds since the epoch */
+    bool removed;
+  };
+
+  typedef std::function<void (const Change &)> Listener;
+
+  explicit ChangeNotifier(const ServiceConfig::Subscriptions &config, QObject *parent = nullptr);
+
+  void unwatch(const int id);
+  int watch(const QString &path, Listener listener);
+
+private:
+  class Stamp {
+  public:
+    bool operator==(const Stamp &other) const;
+
+    qint64 size;
+    qint64 modified;
+    bool exists;
+  };
+
+  class WatchedFile {
+  public:
+    Stamp stamp;                        /* State of the file that listeners know of */
+    int watches;
+    bool pending;
+    QElapsedTimer firstChange;
+    QElapsedTimer lastChange;
+  };
+
+  class Watch {
+  public:
+    QString path;
+    Listener listener;
+  };
+
+  void markChanged(const QString &path);
+  static Stamp stampOf(const QString &path);
+
+  const ServiceConfig::Subscriptions m_config;
+
+  QFileSystemWatcher *m_watcher;        /* Created with the first watch */
+  QTimer *m_coalesceTimer;
+  int m_nextId;
+  QHash<int, Watch> m_watches;
+  QHash<QString, WatchedFile> m_files;
+  QHash<QString, int> m_directories;    /* Watched directory -> number of watched files in it */
+
+private slots:
+  void onCoalesceTimeout();
+  void onDirectoryChanged(const QString &path);
+  void onFileChanged(const QString &path);
+};
+
+#endif // CHANGENOTIFIER_H
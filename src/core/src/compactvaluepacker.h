@@ -0,0 +1,218 @@
+#ifndef COMPACTVALUEPACKER_H
+#define COMPACTVALUEPACKER_H
+
+#include <edii_ipc_network.h>
+#include <QByteArray>
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/*
+ * Picks the smallest encoding of the values of a trace that reproduces
+ * them exactly and writes the values in that encoding. X values that
+ * follow a uniform grid are replaced by the first value and the step,
+ * Y values are narrowed to floats or to integers with a common scale
+ * when no bit of them is lost. Decoded values are compared bit by bit
+ * with the original ones so the client always gets what the plugin read.
+ *
+ * The sink is called as sink(const char *data, qint64 size) and returns
+ * false to abort.
+ */
+class CompactValuePacker {
+public:
+  static const int BLOCK_VALUES = 65536;
+
+  class Encoding {
+  public:
+    uint8_t xEncoding;
+    uint8_t yEncoding;
+    double t0;
+    double dt;
+    double yScale;
+  };
+
+  /* xValues is null when the X values are sent with an axis descriptor */
+  static Encoding choose(const double *xValues, const double *yValues, const int count)
+  {
+    Encoding enc{EDII_IPCS_X_DOUBLE, EDII_IPCS_Y_DOUBLE, 0.0, 0.0, 0.0};
+
+    if (xValues == nullptr)
+      enc.xEncoding = EDII_IPCS_X_AXIS;
+    else if (isUniform(xValues, count, enc.t0, enc.dt))
+      enc.xEncoding = EDII_IPCS_X_UNIFORM;
+    else if (isUniformFloat(xValues, count, enc.t0, enc.dt))
+      enc.xEncoding = EDII_IPCS_X_UNIFORM_FLOAT;
+
+    if (fitsFloat(yValues, count))
+      enc.yEncoding = EDII_IPCS_Y_FLOAT;
+    else if (findScale(yValues, count, enc.yScale))
+      enc.yEncoding = EDII_IPCS_Y_SCALED_INT32;
+
+    return enc;
+  }
+
+  template <typename Sink>
+  static bool write(const Encoding &enc, const double *xValues, const double *yValues, const int count, Sink &&sink)
+  {
+    if (enc.xEncoding == EDII_IPCS_X_DOUBLE) {
+      if (!sink(reinterpret_cast<const char *>(xValues), static_cast<qint64>(sizeof(double)) * count))
+        return false;
+    }
+
+    switch (enc.yEncoding) {
+    case EDII_IPCS_Y_FLOAT:
+      return writeNarrowed<float>(yValues, count, sink, [](const double v) { return static_cast<float>(v); });
+    case EDII_IPCS_Y_SCALED_INT32:
+    {
+      const double scale = enc.yScale;
+      return writeNarrowed<int32_t>(yValues, count, sink, [scale](const double v) { return static_cast<int32_t>(std::llround(v / scale)); });
+    }
+    default:
+      return sink(reinterpret_cast<const char *>(yValues), static_cast<qint64>(sizeof(double)) * count);
+    }
+  }
+
+  /* Values are exactly t0 + i * dt computed in double precision */
+  static bool isUniform(const double *values, const int count, double &t0, double &dt)
+  {
+    if (count < 2)
+      return false;
+
+    const double first = values[0];
+    const double candidates[] = { values[1] - values[0], (values[count - 1] - values[0]) / (count - 1) };
+
+    for (const double step : candidates) {
+      bool uniform = true;
+
+      for (int idx = 0; idx < count && uniform; idx++)
+        uniform = sameBits(first + idx * step, values[idx]);
+
+      if (uniform) {
+        t0 = first;
+        dt = step;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+private:
+  /* Scales that axis multipliers of instruments commonly use */
+  static constexpr double DECIMAL_SCALES[] = { 1.0, 1.0e-1, 1.0e-2, 1.0e-3, 1.0e-4, 1.0e-5, 1.0e-6, 1.0e-7, 1.0e-8, 1.0e-9 };
+
+  static bool sameBits(const double a, const double b)
+  {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+  }
+
+  static bool fitsFloat(const double *values, const int count)
+  {
+    for (int idx = 0; idx < count; idx++) {
+      if (!sameBits(static_cast<double>(static_cast<float>(values[idx])), values[idx]))
+        return false;
+    }
+    return true;
+  }
+
+  static bool fitsScale(const double *values, const int count, const double scale)
+  {
+    if (!(scale > 0.0) || !std::isfinite(scale))
+      return false;
+
+    for (int idx = 0; idx < count; idx++) {
+      /* Integers have no negative zero */
+      if (values[idx] == 0.0 && std::signbit(values[idx]))
+        return false;
+
+      const double k = std::round(values[idx] / scale);
+
+      if (!(std::fabs(k) <= 2147483647.0) || !sameBits(k * scale, values[idx]))
+        return false;
+    }
+    return true;
+  }
+
+  static bool findScale(const double *values, const int count, double &scale)
+  {
+    if (count < 1)
+      return false;
+
+    /* The smallest step between neighbouring values is a small multiple of the scale */
+    double step = 0.0;
+    double largest = 0.0;
+    for (int idx = 0; idx < count; idx++) {
+      if (idx > 0) {
+        const double d = std::fabs(values[idx] - values[idx - 1]);
+        if (d > 0.0 && (step == 0.0 || d < step))
+          step = d;
+      }
+      if (std::fabs(values[idx]) > std::fabs(largest))
+        largest = values[idx];
+    }
+
+    if (step > 0.0 && largest != 0.0) {
+      /* Dividing the largest value by its multiple gives the most accurate estimate */
+      const double estimate = std::fabs(largest) / std::round(std::fabs(largest) / step);
+      if (fitsScale(values, count, estimate)) {
+        scale = estimate;
+        return true;
+      }
+    }
+
+    for (const double s : DECIMAL_SCALES) {
+      if (fitsScale(values, count, s)) {
+        scale = s;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /* Grids computed in single precision, as some formats store them */
+  static bool isUniformFloat(const double *values, const int count, double &t0, double &dt)
+  {
+    if (count < 2)
+      return false;
+
+    const float first = static_cast<float>(values[0]);
+    const float step = static_cast<float>(values[1]) - first;
+
+    for (int idx = 0; idx < count; idx++) {
+      const float x = first + static_cast<float>(idx) * step;
+
+      if (!sameBits(static_cast<double>(x), values[idx]))
+        return false;
+    }
+
+    t0 = first;
+    dt = step;
+    return true;
+  }
+
+  template <typename T, typename Sink, typename Narrow>
+  static bool writeNarrowed(const double *values, const int count, Sink &sink, Narrow narrow)
+  {
+    if (count < 1)
+      return true;
+
+    QByteArray block{static_cast<qsizetype>(sizeof(T)) * std::min(count, BLOCK_VALUES), Qt::Uninitialized};
+    T *out = reinterpret_cast<T *>(block.data());
+
+    for (int offset = 0; offset < count; offset += BLOCK_VALUES) {
+      const int n = std::min(count - offset, BLOCK_VALUES);
+
+      for (int idx = 0; idx < n; idx++)
+        out[idx] = narrow(values[offset + idx]);
+
+      if (!sink(block.constData(), static_cast<qint64>(sizeof(T)) * n))
+        return false;
+    }
+
+    return true;
+  }
+};
+
+#endif // COMPACTVALUEPACKER_H
@@ -1,8 +1,19 @@
 #include "dataloader.h"
+#include "folderwatcher.h"
+#include "memoryaccount.h"
+#include "metadatacatalog.h"
+#include "prefetcher.h"
+#include "serviceconfig.h"
+#include "servicestats.h"
+#include "tailcheckpointstore.h"
+#include "tracecache.h"
 #include <plugins/uiplugin.h>
+#include <QDebug>
 #include <QDir>
 #include <QLibrary>
+#include <cstring>
 #include <iostream>
+#include <map>
 
 #if defined(Q_OS_UNIX) || defined(Q_OS_LINUX)
   #define DYNAMIC_LIB_SUFFIX ".so"
@@ -14,6 +25,15 @@
 
 #define BACKENDS_DIRECTORY "plugins"
 
+/* Background prefetching pauses while there are loads that a client waits for */
+class ForegroundGuard {
+public:
+  ForegroundGuard(std::atomic<int> &counter) : h_counter{counter} { h_counter++; }
+  ~ForegroundGuard() { h_counter--; }
+private:
+  std::atomic<int> &h_counter;
+};
+
 FileFormatInfo::FileFormatInfo() :
   longDescription(""),
   shortDescription(""),
@@ -65,26 +85,13 @@ Data::Data() :
   yDescription(""),
   xUnit(""),
   yUnit(""),
-  datapoints(QVector<std::tuple<double, double>>())
-{
-}
-
-Data::Data(const QString &path, const QString &dataId, const QString &name, const QString &xDescription, const QString &yDescription,
-           const QString &xUnit, const QString &yUnit, const QVector<std::tuple<double, double>> &datapoints) :
-  valid(true),
-  path(path),
-  dataId(dataId),
-  name(name),
-  xDescription(xDescription),
-  yDescription(yDescription),
-  xUnit(xUnit),
-  yUnit(yUnit),
-  datapoints(datapoints)
+  xValues(QVector<double>()),
+  yValues(QVector<double>())
 {
 }
 
 Data::Data(const QString &path, const QString &dataId, const QString &name, const QString &xDescription, const QString &yDescription,
-           const QString &xUnit, const QString &yUnit, const QVector<std::tuple<double, double> > &&datapoints) :
+           const QString &xUnit, const QString &yUnit, const QVector<double> &xValues, const QVector<double> &yValues) :
   valid(true),
   path(path),
   dataId(dataId),
@@ -93,18 +100,60 @@ Data::Data(const QString &path, const QString &dataId, const QString &name, cons
   yDescription(yDescription),
   xUnit(xUnit),
   yUnit(yUnit),
-  datapoints(std::move(datapoints))
+  xValues(xValues),
+  yValues(yValues)
 {
 }
 
 DataLoader::DataLoader(QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  m_cache{nullptr},
+  m_tailCheckpoints{nullptr},
+  m_prefetcher{nullptr},
+  m_folderWatcher{nullptr},
+  m_catalog{nullptr},
+  m_foregroundLoads{0},
+  m_catalogStatsProviderId{-1}
 {
+  const ServiceConfig &config = ServiceConfig::instance();
+
   loadPlugins();
+
+  m_cache = new TraceCache{config.decodeCache.capacity};
+  m_tailCheckpoints = new TailCheckpointStore{config.tailFollow.maxCheckpoints};
+  /* Watched folders are ingested by the prefetcher's background thread */
+  if (config.prefetch.enabled || config.watchFolders.enabled)
+    m_prefetcher = new Prefetcher{config.prefetch, m_foregroundLoads};
+  if (config.watchFolders.enabled) {
+    m_folderWatcher = new FolderWatcher{config.watchFolders,
+                                        [this](const QString &formatTag, const QString &path) { ingestFile(formatTag, path); },
+                                        this};
+  }
+  if (config.catalog.enabled) {
+    m_catalog = new MetadataCatalog{config.catalog,
+                                    [this](const QString &formatTag, const QString &path, MetadataCatalog::Metadata &metadata) {
+                                      return readMetadata(formatTag, path, metadata);
+                                    },
+                                    m_foregroundLoads,
+                                    this};
+    m_catalogStatsProviderId = ServiceStats::instance().addProvider("catalog", [this]() { return m_catalog->statsJson(); });
+  }
+
+  m_statsProviderId = ServiceStats::instance().addProvider("decodeCache", [this]() { return m_cache->statsJson(); });
+  m_tailStatsProviderId = ServiceStats::instance().addProvider("tailFollow", [this]() { return m_tailCheckpoints->statsJson(); });
 }
 
 DataLoader::~DataLoader()
 {
+  if (m_catalog != nullptr)
+    ServiceStats::instance().removeProvider(m_catalogStatsProviderId);
+  ServiceStats::instance().removeProvider(m_tailStatsProviderId);
+  ServiceStats::instance().removeProvider(m_statsProviderId);
+  delete m_folderWatcher;
+  delete m_catalog; /* Waits for the scan so that it does not outlive the plugins */
+  delete m_prefetcher; /* Waits for the background job so that it does not outlive the plugins */
+  delete m_tailCheckpoints; /* Checkpoints are objects of the plugins */
+  delete m_cache;
   releasePlugins();
 }
 
@@ -113,6 +162,28 @@ bool DataLoader::checkTag(const QString &tag) const
   return m_pluginInstances.contains(tag);
 }
 
+void DataLoader::ingestFile(const QString &formatTag, const QString &path) const
+{
+  if (!checkTag(formatTag)) {
+    qWarning() << "Cannot ingest" << path << "- no plugin for format tag" << formatTag;
+    return;
+  }
+
+  Prefetcher::Decoder decoder{};
+
+  /* Files of formats that need the user to pick loading parameters are only read into the page cache */
+  if (m_cache->enabled() && m_pluginInstances[formatTag]->unattendedLoadSupported()) {
+    decoder = [this, formatTag](const QString &filePath) {
+      return prefetchDataPath(formatTag, filePath, 0);
+    };
+  }
+
+  m_prefetcher->ingest(path, std::move(decoder));
+
+  if (m_catalog != nullptr)
+    m_catalog->update(formatTag, path);
+}
+
 void DataLoader::initializePlugin(const QString &pluginPath)
 {
   if (!QLibrary::isLibrary(pluginPath))
@@ -145,6 +216,7 @@ void DataLoader::initializePlugin(const QString &pluginPath)
     return;
 
   m_pluginInstances.insert(tag, instance);
+  ServiceStats::instance().registerTag(tag);
 }
 
 
@@ -160,7 +232,7 @@ DataLoader::LoadedPack DataLoader::loadData(const QString &formatTag, const int
   if (pdVec.size() < 1)
     return makeErrorPack("No data was loaded");
 
-  return package(pdVec);
+  return package(formatTag, pdVec);
 }
 
 std::tuple<std::vector<Data>, bool, QString> DataLoader::loadDataHint(const QString &formatTag, const QString &hintPath, const int mode) const
@@ -169,12 +241,29 @@ std::tuple<std::vector<Data>, bool, QString> DataLoader::loadDataHint(const QStr
     return makeErrorPack(QString("Invalid format tag %1").arg(formatTag));
 
   auto instance = m_pluginInstances[formatTag];
+  quint64 prefetchSession = 0;
+
+  /* Read ahead the hinted directory while the user is busy with the loading dialog */
+  if (m_prefetcher != nullptr && ServiceConfig::instance().prefetch.enabled) {
+    Prefetcher::Decoder decoder{};
+
+    if (m_cache->enabled() && instance->unattendedLoadSupported()) {
+      decoder = [this, formatTag, mode](const QString &path) {
+        return prefetchDataPath(formatTag, path, mode);
+      };
+    }
+    prefetchSession = m_prefetcher->start(hintPath, std::move(decoder));
+  }
+
   auto pdVec = instance->loadHint(hintPath.toStdString(), mode);
 
+  if (prefetchSession != 0)
+    m_prefetcher->stop(prefetchSession);
+
   if (pdVec.size() < 1)
     return makeErrorPack("No data was loaded");
 
-  return package(pdVec);
+  return package(formatTag, pdVec);
 }
 
 std::tuple<std::vector<Data>, bool, QString> DataLoader::loadDataPath(const QString &formatTag, const QString &path, const int mode) const
@@ -182,15 +271,67 @@ std::tuple<std::vector<Data>, bool, QString> DataLoader::loadDataPath(const QStr
   if (!checkTag(formatTag))
     return makeErrorPack(QString("Invalid format tag %1").arg(formatTag));
 
+  ForegroundGuard guard{m_foregroundLoads};
+
   auto instance = m_pluginInstances[formatTag];
+
+  /* Only results of non-interactive backends may be cached, others need the user to pick loading parameters */
+  const bool cacheable = m_cache->enabled() && instance->unattendedLoadSupported();
+  const TraceCache::FileStamp stamp = cacheable ? TraceCache::FileStamp::of(path) : TraceCache::FileStamp{0, 0, false};
+
+  if (cacheable) {
+    const auto cached = m_cache->get(formatTag, path, mode);
+    if (cached != nullptr)
+      return makePack(*cached, true);
+  }
+
   auto pdVec = instance->loadPath(path.toStdString(), mode);
 
   if (pdVec.size() < 1)
     return makeErrorPack("No data was loaded");
 
-  return package(pdVec);
+  LoadedPack pack = package(formatTag, pdVec);
+  if (cacheable && std::get<1>(pack))
+    m_cache->insert(formatTag, path, mode, stamp, std::get<0>(pack));
+
+  return pack;
 }
 
+/*
+ * Loads data appended to a growing file since the checkpoint identified by the cursor.
+ * Cursor zero reads the file from the beginning. The cursor is replaced by one that
+ * identifies the new checkpoint. The reset flag tells that the cursor could not be used
+ * and the returned data start at the beginning of the file.
+ */
+std::tuple<std::vector<Data>, bool, QString> DataLoader::loadDataPathTail(const QString &formatTag, const QString &path, const int mode,
+                                                                          quint64 &cursor, bool &reset) const
+{
+  if (!checkTag(formatTag))
+    return makeErrorPack(QString("Invalid format tag %1").arg(formatTag));
+
+  ForegroundGuard guard{m_foregroundLoads};
+
+  auto instance = m_pluginInstances[formatTag];
+  if (!instance->tailLoadSupported())
+    return makeErrorPack(QString("Format %1 cannot be read incrementally").arg(formatTag));
+
+  TailCheckpointStore::Checkpoint checkpoint{nullptr};
+  if (cursor != 0)
+    checkpoint = m_tailCheckpoints->get(cursor, formatTag, path, mode);
+
+  bool restarted = false;
+  reset = cursor != 0 && checkpoint == nullptr;
+
+  auto pdVec = instance->loadPathTail(path.toStdString(), mode, checkpoint, restarted);
+
+  if (checkpoint == nullptr)
+    return makeErrorPack("No data was loaded");
+
+  reset = reset || restarted;
+  cursor = m_tailCheckpoints->insert(formatTag, path, mode, std::move(checkpoint));
+
+  return package(formatTag, pdVec);
+}
 
 bool DataLoader::loadPlugins()
 {
@@ -227,14 +368,77 @@ DataLoader::LoadedPack DataLoader::makePack(const std::vector<Data> &data, const
   return std::make_tuple(data, status, message);
 }
 
-DataLoader::LoadedPack DataLoader::package(std::vector<plugin::Data> &vec) const
+qint64 DataLoader::prefetchDataPath(const QString &formatTag, const QString &path, const int mode) const
 {
+  const TraceCache::FileStamp stamp = TraceCache::FileStamp::of(path);
+
+  if (m_cache->contains(formatTag, path, mode, stamp))
+    return 0;
+
+  auto instance = m_pluginInstances[formatTag];
+  auto pdVec = instance->loadPathUnattended(path.toStdString(), mode);
+
+  if (pdVec.size() < 1)
+    return 0;
+
+  const LoadedPack pack = package(formatTag, pdVec);
+  if (!std::get<1>(pack))
+    return 0;
+
+  return m_cache->insert(formatTag, path, mode, stamp, std::get<0>(pack));
+}
+
+DataLoader::LoadedPack DataLoader::package(const QString &formatTag, std::vector<plugin::Data> &vec) const
+{
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer timer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::PACKAGING};
+
   std::vector<Data> packageVec;
+  std::vector<QVector<double>> knownAxes;
+  std::map<const std::vector<double> *, QVector<double>> pluginAxes;
+
+  /* Traces read from one file commonly share the time axis. Look for axes
+   * with identical content and let such traces reference one copy of the data. */
+  auto shareAxis = [&knownAxes](QVector<double> &&axis) {
+    for (const auto &known : knownAxes) {
+      if (known.size() != axis.size())
+        continue;
+      if (std::memcmp(known.constData(), axis.constData(), sizeof(double) * axis.size()) == 0)
+        return known;
+    }
+
+    knownAxes.emplace_back(std::move(axis));
+    return knownAxes.back();
+  };
 
   for (const auto &pd : vec) {
-    QVector<std::tuple<double, double>> datapoints;
-    for (const auto &item : pd.datapoints)
-      datapoints.append(item);
+    QVector<double> xValues;
+    QVector<double> yValues;
+
+    if (pd.xAxis != nullptr) {
+      if (pd.xAxis->size() != pd.yValues.size())
+        return makeErrorPack("Loaded data contain different number of X and Y values");
+
+      auto it = pluginAxes.find(pd.xAxis.get());
+      if (it == pluginAxes.end()) {
+        QVector<double> axis(pd.xAxis->cbegin(), pd.xAxis->cend());
+        it = pluginAxes.emplace(pd.xAxis.get(), shareAxis(std::move(axis))).first;
+      }
+
+      xValues = it->second;
+      yValues = QVector<double>(pd.yValues.cbegin(), pd.yValues.cend());
+    } else {
+      QVector<double> axis;
+
+      axis.reserve(pd.datapoints.size());
+      yValues.reserve(pd.datapoints.size());
+      for (const auto &item : pd.datapoints) {
+        axis.append(std::get<0>(item));
+        yValues.append(std::get<1>(item));
+      }
+
+      xValues = shareAxis(std::move(axis));
+    }
 
     Data d{QString::fromStdString(pd.path),
            QString::fromStdString(pd.dataId),
@@ -243,14 +447,50 @@ DataLoader::LoadedPack DataLoader::package(std::vector<plugin::Data> &vec) const
            QString::fromStdString(pd.yDescription),
            QString::fromStdString(pd.xUnit),
            QString::fromStdString(pd.yUnit),
-           datapoints};
+           xValues,
+           yValues};
 
     packageVec.emplace_back(d);
   }
 
+  /* QVector allocations bypass operator new */
+  MemoryAccount::charge(TraceCache::dataSize(packageVec));
+
   return makePack(packageVec, true);
 }
 
+std::tuple<QJsonArray, bool, QString> DataLoader::queryCatalog(const QString &query, const int maxResults) const
+{
+  if (m_catalog == nullptr)
+    return {QJsonArray{}, false, "Catalog is disabled"};
+
+  bool ok;
+  QString error;
+  QJsonArray results = m_catalog->query(query, maxResults, ok, error);
+
+  return {results, ok, error};
+}
+
+bool DataLoader::readMetadata(const QString &formatTag, const QString &path, QVector<QPair<QString, QString>> &metadata) const
+{
+  if (!checkTag(formatTag))
+    return false;
+
+  auto instance = m_pluginInstances[formatTag];
+  if (!instance->metadataSupported())
+    return false;
+
+  plugin::Metadata pMeta;
+  if (!instance->readMetadata(path.toStdString(), pMeta))
+    return false;
+
+  metadata.clear();
+  for (const auto &item : pMeta)
+    metadata.append({QString::fromStdString(item.first), QString::fromStdString(item.second)});
+
+  return true;
+}
+
 void DataLoader::releasePlugins()
 {
   for (auto &plugin : m_pluginInstances)
@@ -1,11 +1,19 @@
 #ifndef DATALOADER_H
 #define DATALOADER_H
 
+#include <QJsonArray>
 #include <QMap>
 #include <QObject>
 #include <QVector>
+#include <atomic>
 #include <plugins/plugininterface.h>
 
+class FolderWatcher;
+class MetadataCatalog;
+class Prefetcher;
+class TailCheckpointStore;
+class TraceCache;
+
 class FileFormatInfo {
 public:
   explicit FileFormatInfo();
@@ -27,11 +35,7 @@ public:
   explicit Data(const QString &path, const QString &dataId, const QString &name,
                 const QString &xDescription, const QString &yDescription,
                 const QString &xUnit, const QString &yUnit,
-                const QVector<std::tuple<double, double>> &datapoints);
-  explicit Data(const QString &path, const QString &dataId, const QString &name,
-                const QString &xDescription, const QString &yDescription,
-                const QString &xUnit, const QString &yUnit,
-                const QVector<std::tuple<double, double>> &&datapoints);
+                const QVector<double> &xValues, const QVector<double> &yValues);
 
   const bool valid;
   const QString path;
@@ -41,7 +45,8 @@ public:
   const QString yDescription;
   const QString xUnit;
   const QString yUnit;
-  const QVector<std::tuple<double, double>> datapoints;
+  const QVector<double> xValues; /* Implicitly shared by all traces in a pack that have identical X values */
+  const QVector<double> yValues;
 };
 
 class DataLoader : public QObject
@@ -56,18 +61,33 @@ public:
   std::tuple<std::vector<Data>, bool, QString> loadData(const QString &formatTag, const int mode) const;
   std::tuple<std::vector<Data>, bool, QString> loadDataHint(const QString &formatTag, const QString &hintPath, const int mode) const;
   std::tuple<std::vector<Data>, bool, QString> loadDataPath(const QString &formatTag, const QString &path, const int mode) const;
+  std::tuple<std::vector<Data>, bool, QString> loadDataPathTail(const QString &formatTag, const QString &path, const int mode,
+                                                                quint64 &cursor, bool &reset) const;
+  std::tuple<QJsonArray, bool, QString> queryCatalog(const QString &query, const int maxResults) const;
   QVector<FileFormatInfo> supportedFileFormats() const;
 
 private:
   bool checkTag(const QString &tag) const;
+  void ingestFile(const QString &formatTag, const QString &path) const;
   void initializePlugin(const QString &pluginPath);
   bool loadPlugins();
   LoadedPack makeErrorPack(const QString &error) const;
   LoadedPack makePack(const std::vector<Data> &data, const bool status, const QString &message = "") const;
-  LoadedPack package(std::vector<plugin::Data> &vec) const;
+  LoadedPack package(const QString &formatTag, std::vector<plugin::Data> &vec) const;
+  qint64 prefetchDataPath(const QString &formatTag, const QString &path, const int mode) const;
+  bool readMetadata(const QString &formatTag, const QString &path, QVector<QPair<QString, QString>> &metadata) const;
   void releasePlugins();
 
   QMap<QString, plugin::EDIIPlugin *> m_pluginInstances;
+  TraceCache *m_cache;
+  TailCheckpointStore *m_tailCheckpoints;
+  Prefetcher *m_prefetcher;
+  FolderWatcher *m_folderWatcher;
+  MetadataCatalog *m_catalog;
+  mutable std::atomic<int> m_foregroundLoads;
+  int m_statsProviderId;
+  int m_tailStatsProviderId;
+  int m_catalogStatsProviderId;
 
 };
 
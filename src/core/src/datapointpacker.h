@@ -0,0 +1,48 @@
+#ifndef DATAPOINTPACKER_H
+#define DATAPOINTPACKER_H
+
+#include <edii_ipc_network.h>
+#include <QByteArray>
+#include <QtGlobal>
+#include <algorithm>
+
+/*
+ * Interleaves X and Y values into EDII_IPCSockDatapoint records and passes
+ * them to the sink in blocks of up to BLOCK_POINTS records. Writing whole
+ * blocks avoids the per-call overhead of the socket that dominated when
+ * each datapoint was written on its own, while the bounded block keeps
+ * the extra memory small even for traces with millions of points.
+ *
+ * The sink is called as sink(const char *data, qint64 size) and returns
+ * false to abort.
+ */
+class DatapointPacker {
+public:
+  static const int BLOCK_POINTS = 65536;
+
+  template <typename Sink>
+  static bool write(const double *xValues, const double *yValues, const int count, Sink &&sink)
+  {
+    if (count < 1)
+      return true;
+
+    QByteArray block{static_cast<qsizetype>(sizeof(EDII_IPCSockDatapoint)) * std::min(count, BLOCK_POINTS), Qt::Uninitialized};
+    EDII_IPCSockDatapoint *dps = reinterpret_cast<EDII_IPCSockDatapoint *>(block.data());
+
+    for (int offset = 0; offset < count; offset += BLOCK_POINTS) {
+      const int n = std::min(count - offset, BLOCK_POINTS);
+
+      for (int idx = 0; idx < n; idx++) {
+        dps[idx].x = xValues[offset + idx];
+        dps[idx].y = yValues[offset + idx];
+      }
+
+      if (!sink(block.constData(), static_cast<qint64>(sizeof(EDII_IPCSockDatapoint)) * n))
+        return false;
+    }
+
+    return true;
+  }
+};
+
+#endif // DATAPOINTPACKER_H
@@ -5,7 +5,8 @@
  * qdbusxml2cpp is Copyright (C) 2017 The Qt Company Ltd.
  *
  * This is an auto-generated file.
- * Do not edit! All changes made to it will be lost.
+ * This file may have been hand-edited. Look for HAND-EDIT comments
+ * before re-generating it.
  */
 
 #include "DBusInterfaceAdaptor.h"
@@ -41,30 +42,156 @@ EDII::IPCQtDBus::ABIVersion LoaderAdaptor::abiVersion()
     return abiVersion;
 }
 
-EDII::IPCQtDBus::DataPack LoaderAdaptor::loadData(const QString &formatTag, int loadOption)
+QString LoaderAdaptor::catalogQuery(const QString &query, int maxResults)
+{
+    // handle method call edii.loader.catalogQuery
+    QString result;
+    QMetaObject::invokeMethod(parent(), "catalogQuery", Q_RETURN_ARG(QString, result), Q_ARG(QString, query), Q_ARG(int, maxResults));
+    return result;
+}
+
+QString LoaderAdaptor::flushTrace()
+{
+    // handle method call edii.loader.flushTrace
+    QString path;
+    QMetaObject::invokeMethod(parent(), "flushTrace", Q_RETURN_ARG(QString, path));
+    return path;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::DataPack LoaderAdaptor::loadData(const QString &formatTag, int loadOption, const QDBusMessage &message)
 {
     // handle method call edii.loader.loadData
     EDII::IPCQtDBus::DataPack pack;
-    QMetaObject::invokeMethod(parent(), "loadData", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(int, loadOption));
+    QMetaObject::invokeMethod(parent(), "loadData", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::ColumnarDataPack LoaderAdaptor::loadDataColumns(const QString &formatTag, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataColumns
+    EDII::IPCQtDBus::ColumnarDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataColumns", Q_RETURN_ARG(EDII::IPCQtDBus::ColumnarDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::FdDataPack LoaderAdaptor::loadDataFd(const QString &formatTag, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataFd
+    EDII::IPCQtDBus::FdDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataFd", Q_RETURN_ARG(EDII::IPCQtDBus::FdDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
     return pack;
 }
 
-EDII::IPCQtDBus::DataPack LoaderAdaptor::loadDataFile(const QString &formatTag, const QString &filePath, int loadOption)
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::DataPack LoaderAdaptor::loadDataFile(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message)
 {
     // handle method call edii.loader.loadDataFile
     EDII::IPCQtDBus::DataPack pack;
-    QMetaObject::invokeMethod(parent(), "loadDataFile", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption));
+    QMetaObject::invokeMethod(parent(), "loadDataFile", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
     return pack;
 }
 
-EDII::IPCQtDBus::DataPack LoaderAdaptor::loadDataHint(const QString &formatTag, const QString &hint, int loadOption)
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::ColumnarDataPack LoaderAdaptor::loadDataFileColumns(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataFileColumns
+    EDII::IPCQtDBus::ColumnarDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataFileColumns", Q_RETURN_ARG(EDII::IPCQtDBus::ColumnarDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::FdDataPack LoaderAdaptor::loadDataFileFd(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataFileFd
+    EDII::IPCQtDBus::FdDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataFileFd", Q_RETURN_ARG(EDII::IPCQtDBus::FdDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::SharedAxesDataPack LoaderAdaptor::loadDataFileSharedAxes(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataFileSharedAxes
+    EDII::IPCQtDBus::SharedAxesDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataFileSharedAxes", Q_RETURN_ARG(EDII::IPCQtDBus::SharedAxesDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::TailDataPack LoaderAdaptor::loadDataFileTail(const QString &formatTag, const QString &filePath, int loadOption, qulonglong cursor, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataFileTail
+    EDII::IPCQtDBus::TailDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataFileTail", Q_RETURN_ARG(EDII::IPCQtDBus::TailDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(qulonglong, cursor), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::DataPack LoaderAdaptor::loadDataHint(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message)
 {
     // handle method call edii.loader.loadDataHint
     EDII::IPCQtDBus::DataPack pack;
-    QMetaObject::invokeMethod(parent(), "loadDataHint", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, hint), Q_ARG(int, loadOption));
+    QMetaObject::invokeMethod(parent(), "loadDataHint", Q_RETURN_ARG(EDII::IPCQtDBus::DataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, hint), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::ColumnarDataPack LoaderAdaptor::loadDataHintColumns(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataHintColumns
+    EDII::IPCQtDBus::ColumnarDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataHintColumns", Q_RETURN_ARG(EDII::IPCQtDBus::ColumnarDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, hint), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::FdDataPack LoaderAdaptor::loadDataHintFd(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataHintFd
+    EDII::IPCQtDBus::FdDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataHintFd", Q_RETURN_ARG(EDII::IPCQtDBus::FdDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, hint), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::SharedAxesDataPack LoaderAdaptor::loadDataHintSharedAxes(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataHintSharedAxes
+    EDII::IPCQtDBus::SharedAxesDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataHintSharedAxes", Q_RETURN_ARG(EDII::IPCQtDBus::SharedAxesDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(QString, hint), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
     return pack;
 }
 
+// HAND-EDIT: Passes the call on to be replied to later
+EDII::IPCQtDBus::SharedAxesDataPack LoaderAdaptor::loadDataSharedAxes(const QString &formatTag, int loadOption, const QDBusMessage &message)
+{
+    // handle method call edii.loader.loadDataSharedAxes
+    EDII::IPCQtDBus::SharedAxesDataPack pack;
+    QMetaObject::invokeMethod(parent(), "loadDataSharedAxes", Q_RETURN_ARG(EDII::IPCQtDBus::SharedAxesDataPack, pack), Q_ARG(QString, formatTag), Q_ARG(int, loadOption), Q_ARG(QDBusMessage, message));
+    return pack;
+}
+
+QString LoaderAdaptor::stats()
+{
+    // handle method call edii.loader.stats
+    QString stats;
+    QMetaObject::invokeMethod(parent(), "stats", Q_RETURN_ARG(QString, stats));
+    return stats;
+}
+
+// HAND-EDIT: Passes the unique bus name of the caller on
+uint LoaderAdaptor::subscribe(const QString &formatTag, const QString &filePath, int loadOption, bool withData, qulonglong cursor, const QDBusMessage &message)
+{
+    // handle method call edii.loader.subscribe
+    uint subscriptionId;
+    QMetaObject::invokeMethod(parent(), "subscribe", Q_RETURN_ARG(uint, subscriptionId), Q_ARG(QString, formatTag), Q_ARG(QString, filePath), Q_ARG(int, loadOption), Q_ARG(bool, withData), Q_ARG(qulonglong, cursor), Q_ARG(QString, message.service()));
+    return subscriptionId;
+}
+
 EDII::IPCQtDBus::SupportedFileFormatVec LoaderAdaptor::supportedFileFormats()
 {
     // handle method call edii.loader.supportedFileFormats
@@ -73,3 +200,12 @@ EDII::IPCQtDBus::SupportedFileFormatVec LoaderAdaptor::supportedFileFormats()
     return supportedFileFormats;
 }
 
+// HAND-EDIT: Passes the unique bus name of the caller on
+bool LoaderAdaptor::unsubscribe(uint subscriptionId, const QDBusMessage &message)
+{
+    // handle method call edii.loader.unsubscribe
+    bool removed;
+    QMetaObject::invokeMethod(parent(), "unsubscribe", Q_RETURN_ARG(bool, removed), Q_ARG(uint, subscriptionId), Q_ARG(QString, message.service()));
+    return removed;
+}
+
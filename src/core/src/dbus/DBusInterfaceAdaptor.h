@@ -52,14 +52,116 @@ class LoaderAdaptor: public QDBusAbstractAdaptor
 "      <arg direction=\"out\" type=\"(bsa(sssssssa(dd)))\" name=\"pack\"/>\n"
 "      <annotation value=\"EDII::IPCQtDBus::DataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "    </method>\n"
+"    <method name=\"loadDataFileTail\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"filePath\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"in\" type=\"t\" name=\"cursor\"/>\n"
+"      <arg direction=\"out\" type=\"(tb(bsa(sssssssa(dd))))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::TailDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataSharedAxes\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsaada(sssssssiad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::SharedAxesDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataHintSharedAxes\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"hint\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsaada(sssssssiad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::SharedAxesDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataFileSharedAxes\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"filePath\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsaada(sssssssiad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::SharedAxesDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataFd\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bshta(sssssssttt))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::FdDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataHintFd\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"hint\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bshta(sssssssttt))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::FdDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataFileFd\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"filePath\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bshta(sssssssttt))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::FdDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataColumns\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsa(sssssssb(dd)adad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::ColumnarDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataHintColumns\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"hint\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsa(sssssssb(dd)adad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::ColumnarDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"loadDataFileColumns\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"filePath\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"out\" type=\"(bsa(sssssssb(dd)adad))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::ColumnarDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+"    </method>\n"
+"    <method name=\"subscribe\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"formatTag\"/>\n"
+"      <arg direction=\"in\" type=\"s\" name=\"filePath\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"loadOption\"/>\n"
+"      <arg direction=\"in\" type=\"b\" name=\"withData\"/>\n"
+"      <arg direction=\"in\" type=\"t\" name=\"cursor\"/>\n"
+"      <arg direction=\"out\" type=\"u\" name=\"subscriptionId\"/>\n"
+"    </method>\n"
+"    <method name=\"unsubscribe\">\n"
+"      <arg direction=\"in\" type=\"u\" name=\"subscriptionId\"/>\n"
+"      <arg direction=\"out\" type=\"b\" name=\"removed\"/>\n"
+"    </method>\n"
 "    <method name=\"supportedFileFormats\">\n"
 "      <arg direction=\"out\" type=\"a(sssa(s))\" name=\"supportedFileFormats\"/>\n"
 "      <annotation value=\"EDII::IPCQtDBus::SupportedFileFormatVec\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "    </method>\n"
+"    <method name=\"catalogQuery\">\n"
+"      <arg direction=\"in\" type=\"s\" name=\"query\"/>\n"
+"      <arg direction=\"in\" type=\"i\" name=\"maxResults\"/>\n"
+"      <arg direction=\"out\" type=\"s\" name=\"result\"/>\n"
+"    </method>\n"
+"    <method name=\"stats\">\n"
+"      <arg direction=\"out\" type=\"s\" name=\"stats\"/>\n"
+"    </method>\n"
+"    <method name=\"flushTrace\">\n"
+"      <arg direction=\"out\" type=\"s\" name=\"path\"/>\n"
+"    </method>\n"
 "    <method name=\"abiVersion\">\n"
 "      <arg direction=\"out\" type=\"(ii)\" name=\"abiVersion\"/>\n"
 "      <annotation value=\"EDII::IPCQtDBus::ABIVersion\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
 "    </method>\n"
+"    <signal name=\"fileChanged\">\n"
+"      <arg type=\"u\" name=\"subscriptionId\"/>\n"
+"      <arg type=\"x\" name=\"size\"/>\n"
+"      <arg type=\"x\" name=\"modified\"/>\n"
+"      <arg type=\"b\" name=\"removed\"/>\n"
+"    </signal>\n"
+"    <signal name=\"fileDataAppended\">\n"
+"      <arg type=\"u\" name=\"subscriptionId\"/>\n"
+"      <arg type=\"(tb(bsa(sssssssa(dd))))\" name=\"pack\"/>\n"
+"      <annotation value=\"EDII::IPCQtDBus::TailDataPack\" name=\"org.qtproject.QtDBus.QtTypeName.Out1\"/>\n"
+"    </signal>\n"
 "  </interface>\n"
         "")
 public:
@@ -69,11 +171,42 @@ public:
 public: // PROPERTIES
 public Q_SLOTS: // METHODS
     EDII::IPCQtDBus::ABIVersion abiVersion();
-    EDII::IPCQtDBus::DataPack loadData(const QString &formatTag, int loadOption);
-    EDII::IPCQtDBus::DataPack loadDataFile(const QString &formatTag, const QString &filePath, int loadOption);
-    EDII::IPCQtDBus::DataPack loadDataHint(const QString &formatTag, const QString &hint, int loadOption);
+    QString catalogQuery(const QString &query, int maxResults);
+    QString flushTrace();
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::DataPack loadData(const QString &formatTag, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::ColumnarDataPack loadDataColumns(const QString &formatTag, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::FdDataPack loadDataFd(const QString &formatTag, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::DataPack loadDataFile(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::ColumnarDataPack loadDataFileColumns(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::FdDataPack loadDataFileFd(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::SharedAxesDataPack loadDataFileSharedAxes(const QString &formatTag, const QString &filePath, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::TailDataPack loadDataFileTail(const QString &formatTag, const QString &filePath, int loadOption, qulonglong cursor, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::DataPack loadDataHint(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::ColumnarDataPack loadDataHintColumns(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::FdDataPack loadDataHintFd(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::SharedAxesDataPack loadDataHintSharedAxes(const QString &formatTag, const QString &hint, int loadOption, const QDBusMessage &message);
+    // HAND-EDIT: The call is replied to once a worker has loaded the data, the trailing message is the call
+    EDII::IPCQtDBus::SharedAxesDataPack loadDataSharedAxes(const QString &formatTag, int loadOption, const QDBusMessage &message);
+    QString stats();
+    // HAND-EDIT: Subscriptions belong to the caller, the trailing message tells who it is
+    uint subscribe(const QString &formatTag, const QString &filePath, int loadOption, bool withData, qulonglong cursor, const QDBusMessage &message);
     EDII::IPCQtDBus::SupportedFileFormatVec supportedFileFormats();
+    // HAND-EDIT: Subscriptions belong to the caller, the trailing message tells who it is
+    bool unsubscribe(uint subscriptionId, const QDBusMessage &message);
 Q_SIGNALS: // SIGNALS
+    // HAND-EDIT: fileChanged and fileDataAppended are sent only to the subscriber by DBusIPCProxy and are not relayed
 };
 
 #endif
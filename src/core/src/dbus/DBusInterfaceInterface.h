@@ -43,6 +43,19 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QStringLiteral("abiVersion"), argumentList);
     }
 
+    inline QDBusPendingReply<QString> catalogQuery(const QString &query, int maxResults)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(query) << QVariant::fromValue(maxResults);
+        return asyncCallWithArgumentList(QStringLiteral("catalogQuery"), argumentList);
+    }
+
+    inline QDBusPendingReply<QString> flushTrace()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QStringLiteral("flushTrace"), argumentList);
+    }
+
     inline QDBusPendingReply<EDII::IPCQtDBus::DataPack> loadData(const QString &formatTag, int loadOption)
     {
         QList<QVariant> argumentList;
@@ -50,6 +63,20 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QStringLiteral("loadData"), argumentList);
     }
 
+    inline QDBusPendingReply<EDII::IPCQtDBus::ColumnarDataPack> loadDataColumns(const QString &formatTag, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataColumns"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::FdDataPack> loadDataFd(const QString &formatTag, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataFd"), argumentList);
+    }
+
     inline QDBusPendingReply<EDII::IPCQtDBus::DataPack> loadDataFile(const QString &formatTag, const QString &filePath, int loadOption)
     {
         QList<QVariant> argumentList;
@@ -57,6 +84,34 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QStringLiteral("loadDataFile"), argumentList);
     }
 
+    inline QDBusPendingReply<EDII::IPCQtDBus::ColumnarDataPack> loadDataFileColumns(const QString &formatTag, const QString &filePath, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(filePath) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataFileColumns"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::FdDataPack> loadDataFileFd(const QString &formatTag, const QString &filePath, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(filePath) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataFileFd"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::SharedAxesDataPack> loadDataFileSharedAxes(const QString &formatTag, const QString &filePath, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(filePath) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataFileSharedAxes"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::TailDataPack> loadDataFileTail(const QString &formatTag, const QString &filePath, int loadOption, qulonglong cursor)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(filePath) << QVariant::fromValue(loadOption) << QVariant::fromValue(cursor);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataFileTail"), argumentList);
+    }
+
     inline QDBusPendingReply<EDII::IPCQtDBus::DataPack> loadDataHint(const QString &formatTag, const QString &hint, int loadOption)
     {
         QList<QVariant> argumentList;
@@ -64,13 +119,63 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QStringLiteral("loadDataHint"), argumentList);
     }
 
+    inline QDBusPendingReply<EDII::IPCQtDBus::ColumnarDataPack> loadDataHintColumns(const QString &formatTag, const QString &hint, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(hint) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataHintColumns"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::FdDataPack> loadDataHintFd(const QString &formatTag, const QString &hint, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(hint) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataHintFd"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::SharedAxesDataPack> loadDataHintSharedAxes(const QString &formatTag, const QString &hint, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(hint) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataHintSharedAxes"), argumentList);
+    }
+
+    inline QDBusPendingReply<EDII::IPCQtDBus::SharedAxesDataPack> loadDataSharedAxes(const QString &formatTag, int loadOption)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(loadOption);
+        return asyncCallWithArgumentList(QStringLiteral("loadDataSharedAxes"), argumentList);
+    }
+
+    inline QDBusPendingReply<QString> stats()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QStringLiteral("stats"), argumentList);
+    }
+
+    inline QDBusPendingReply<uint> subscribe(const QString &formatTag, const QString &filePath, int loadOption, bool withData, qulonglong cursor)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(formatTag) << QVariant::fromValue(filePath) << QVariant::fromValue(loadOption) << QVariant::fromValue(withData) << QVariant::fromValue(cursor);
+        return asyncCallWithArgumentList(QStringLiteral("subscribe"), argumentList);
+    }
+
     inline QDBusPendingReply<EDII::IPCQtDBus::SupportedFileFormatVec> supportedFileFormats()
     {
         QList<QVariant> argumentList;
         return asyncCallWithArgumentList(QStringLiteral("supportedFileFormats"), argumentList);
     }
 
+    inline QDBusPendingReply<bool> unsubscribe(uint subscriptionId)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(subscriptionId);
+        return asyncCallWithArgumentList(QStringLiteral("unsubscribe"), argumentList);
+    }
+
 Q_SIGNALS: // SIGNALS
+    void fileChanged(uint subscriptionId, qlonglong size, qlonglong modified, bool removed);
+    void fileDataAppended(uint subscriptionId, EDII::IPCQtDBus::TailDataPack pack);
 };
 
 namespace edii {
@@ -1,5 +1,7 @@
 #include "dbusinterface.h"
 
+#include <QtDBus/QDBusMessage>
+
 DBusInterface::DBusInterface(QObject *parent) :
   QObject(parent)
 {
@@ -14,31 +16,160 @@ EDII::IPCQtDBus::ABIVersion DBusInterface::abiVersion()
   return { EDII_ABI_VERSION_MAJOR, EDII_ABI_VERSION_MINOR };
 }
 
-EDII::IPCQtDBus::DataPack DBusInterface::loadData(const QString &formatTag, const int loadOption)
+QString DBusInterface::catalogQuery(const QString &query, const int maxResults)
+{
+  QString result;
+
+  emit catalogQueryForwarder(result, query, maxResults);
+
+  return result;
+}
+
+QString DBusInterface::flushTrace()
+{
+  QString path;
+
+  emit flushTraceForwarder(path);
+
+  return path;
+}
+
+/* Loads are replied to from the worker that handles them, the returned pack is not sent */
+EDII::IPCQtDBus::DataPack DBusInterface::loadData(const QString &formatTag, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataForwarder(message, formatTag, LoadMode::INTERACTIVE, "", loadOption);
+
+  return EDII::IPCQtDBus::DataPack{};
+}
+
+EDII::IPCQtDBus::ColumnarDataPack DBusInterface::loadDataColumns(const QString &formatTag, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataColumnsForwarder(message, formatTag, LoadMode::INTERACTIVE, "", loadOption);
+
+  return EDII::IPCQtDBus::ColumnarDataPack{};
+}
+
+EDII::IPCQtDBus::FdDataPack DBusInterface::loadDataFd(const QString &formatTag, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataFdForwarder(message, formatTag, LoadMode::INTERACTIVE, "", loadOption);
+
+  return EDII::IPCQtDBus::FdDataPack{};
+}
+
+EDII::IPCQtDBus::DataPack DBusInterface::loadDataHint(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataForwarder(message, formatTag, LoadMode::HINT, hint, loadOption);
+
+  return EDII::IPCQtDBus::DataPack{};
+}
+
+EDII::IPCQtDBus::ColumnarDataPack DBusInterface::loadDataHintColumns(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataColumnsForwarder(message, formatTag, LoadMode::HINT, hint, loadOption);
+
+  return EDII::IPCQtDBus::ColumnarDataPack{};
+}
+
+EDII::IPCQtDBus::FdDataPack DBusInterface::loadDataHintFd(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataFdForwarder(message, formatTag, LoadMode::HINT, hint, loadOption);
+
+  return EDII::IPCQtDBus::FdDataPack{};
+}
+
+EDII::IPCQtDBus::DataPack DBusInterface::loadDataFile(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataForwarder(message, formatTag, LoadMode::FILE, filePath, loadOption);
+
+  return EDII::IPCQtDBus::DataPack{};
+}
+
+EDII::IPCQtDBus::ColumnarDataPack DBusInterface::loadDataFileColumns(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataColumnsForwarder(message, formatTag, LoadMode::FILE, filePath, loadOption);
+
+  return EDII::IPCQtDBus::ColumnarDataPack{};
+}
+
+EDII::IPCQtDBus::FdDataPack DBusInterface::loadDataFileFd(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataFdForwarder(message, formatTag, LoadMode::FILE, filePath, loadOption);
+
+  return EDII::IPCQtDBus::FdDataPack{};
+}
+
+EDII::IPCQtDBus::TailDataPack DBusInterface::loadDataFileTail(const QString &formatTag, const QString &filePath, const int loadOption, const qulonglong cursor, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataTailForwarder(message, formatTag, filePath, loadOption, cursor);
+
+  return EDII::IPCQtDBus::TailDataPack{};
+}
+
+EDII::IPCQtDBus::SharedAxesDataPack DBusInterface::loadDataSharedAxes(const QString &formatTag, const int loadOption, const QDBusMessage &message)
+{
+  message.setDelayedReply(true);
+
+  emit loadDataSharedAxesForwarder(message, formatTag, LoadMode::INTERACTIVE, "", loadOption);
+
+  return EDII::IPCQtDBus::SharedAxesDataPack{};
+}
+
+EDII::IPCQtDBus::SharedAxesDataPack DBusInterface::loadDataHintSharedAxes(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message)
 {
-  EDII::IPCQtDBus::DataPack pack;
+  message.setDelayedReply(true);
 
-  emit loadDataForwarder(pack, formatTag, LoadMode::INTERACTIVE, "", loadOption);
+  emit loadDataSharedAxesForwarder(message, formatTag, LoadMode::HINT, hint, loadOption);
 
-  return pack;
+  return EDII::IPCQtDBus::SharedAxesDataPack{};
 }
 
-EDII::IPCQtDBus::DataPack DBusInterface::loadDataHint(const QString &formatTag, const QString &hint, const int loadOption)
+EDII::IPCQtDBus::SharedAxesDataPack DBusInterface::loadDataFileSharedAxes(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message)
 {
-  EDII::IPCQtDBus::DataPack pack;
+  message.setDelayedReply(true);
 
-  emit loadDataForwarder(pack, formatTag, LoadMode::HINT, hint, loadOption);
+  emit loadDataSharedAxesForwarder(message, formatTag, LoadMode::FILE, filePath, loadOption);
 
-  return pack;
+  return EDII::IPCQtDBus::SharedAxesDataPack{};
 }
 
-EDII::IPCQtDBus::DataPack DBusInterface::loadDataFile(const QString &formatTag, const QString &filePath, const int loadOption)
+QString DBusInterface::stats()
 {
-  EDII::IPCQtDBus::DataPack pack;
+  QString stats;
 
-  emit loadDataForwarder(pack, formatTag, LoadMode::FILE, filePath, loadOption);
+  emit statsForwarder(stats);
 
-  return pack;
+  return stats;
+}
+
+/* Returns zero if the subscription was refused */
+uint DBusInterface::subscribe(const QString &formatTag, const QString &filePath, const int loadOption, const bool withData, const qulonglong cursor,
+                              const QString &subscriber)
+{
+  uint subscriptionId = 0;
+
+  emit subscribeForwarder(subscriptionId, subscriber, formatTag, filePath, loadOption, withData, cursor);
+
+  return subscriptionId;
 }
 
 EDII::IPCQtDBus::SupportedFileFormatVec DBusInterface::supportedFileFormats()
@@ -49,3 +180,12 @@ EDII::IPCQtDBus::SupportedFileFormatVec DBusInterface::supportedFileFormats()
 
   return vec;
 }
+
+bool DBusInterface::unsubscribe(const uint subscriptionId, const QString &subscriber)
+{
+  bool removed = false;
+
+  emit unsubscribeForwarder(removed, subscriber, subscriptionId);
+
+  return removed;
+}
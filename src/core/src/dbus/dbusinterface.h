@@ -6,6 +6,8 @@
 #include <edii_ipc_qtdbus.h>
 #include <QObject>
 
+class QDBusMessage;
+
 class DBusInterface : public QObject {
   Q_OBJECT
 
@@ -24,14 +26,40 @@ public:
 
 public slots:
   EDII::IPCQtDBus::ABIVersion abiVersion();
-  EDII::IPCQtDBus::DataPack loadData(const QString &formatTag, const int loadOption);
-  EDII::IPCQtDBus::DataPack loadDataHint(const QString &formatTag, const QString &hint, const int loadOption);
-  EDII::IPCQtDBus::DataPack loadDataFile(const QString &formatTag, const QString &filePath, const int loadOption);
+  QString catalogQuery(const QString &query, const int maxResults);
+  QString flushTrace();
+  EDII::IPCQtDBus::DataPack loadData(const QString &formatTag, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::ColumnarDataPack loadDataColumns(const QString &formatTag, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::FdDataPack loadDataFd(const QString &formatTag, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::DataPack loadDataHint(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::ColumnarDataPack loadDataHintColumns(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::FdDataPack loadDataHintFd(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::DataPack loadDataFile(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::ColumnarDataPack loadDataFileColumns(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::FdDataPack loadDataFileFd(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::TailDataPack loadDataFileTail(const QString &formatTag, const QString &filePath, const int loadOption, const qulonglong cursor, const QDBusMessage &message);
+  EDII::IPCQtDBus::SharedAxesDataPack loadDataSharedAxes(const QString &formatTag, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::SharedAxesDataPack loadDataHintSharedAxes(const QString &formatTag, const QString &hint, const int loadOption, const QDBusMessage &message);
+  EDII::IPCQtDBus::SharedAxesDataPack loadDataFileSharedAxes(const QString &formatTag, const QString &filePath, const int loadOption, const QDBusMessage &message);
+  QString stats();
+  uint subscribe(const QString &formatTag, const QString &filePath, const int loadOption, const bool withData, const qulonglong cursor,
+                 const QString &subscriber);
   EDII::IPCQtDBus::SupportedFileFormatVec supportedFileFormats();
+  bool unsubscribe(const uint subscriptionId, const QString &subscriber);
 
 signals:
-  void loadDataForwarder(EDII::IPCQtDBus::DataPack &pack, const QString &formatTag, const LoadMode mode, const QString &modeParam, const int loadOption);
+  void catalogQueryForwarder(QString &result, const QString &query, const int maxResults);
+  void flushTraceForwarder(QString &path);
+  void loadDataForwarder(const QDBusMessage &message, const QString &formatTag, const LoadMode mode, const QString &modeParam, const int loadOption);
+  void loadDataColumnsForwarder(const QDBusMessage &message, const QString &formatTag, const LoadMode mode, const QString &modeParam, const int loadOption);
+  void loadDataFdForwarder(const QDBusMessage &message, const QString &formatTag, const LoadMode mode, const QString &modeParam, const int loadOption);
+  void loadDataTailForwarder(const QDBusMessage &message, const QString &formatTag, const QString &filePath, const int loadOption, const qulonglong cursor);
+  void loadDataSharedAxesForwarder(const QDBusMessage &message, const QString &formatTag, const LoadMode mode, const QString &modeParam, const int loadOption);
+  void statsForwarder(QString &stats);
+  void subscribeForwarder(uint &subscriptionId, const QString &subscriber, const QString &formatTag, const QString &filePath, const int loadOption,
+                          const bool withData, const qulonglong cursor);
   void supportedFileFormatsForwarder(EDII::IPCQtDBus::SupportedFileFormatVec &supportedFileFormats);
+  void unsubscribeForwarder(bool &removed, const QString &subscriber, const uint subscriptionId);
 };
 
 #endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
@@ -1,15 +1,100 @@
 #include "dbusipcproxy.h"
 #include "dbus/dbusinterface.h"
 #include "dbus/DBusInterfaceAdaptor.h"
+#include "compactvaluepacker.h"
 #include "dataloader.h"
+#include "memoryaccount.h"
+#include "requestscheduler.h"
+#include "requesttracer.h"
+#include "serviceconfig.h"
+#include "servicestats.h"
+#include "sharedtracebuffer.h"
+#include "workerpool.h"
 #include <QtDBus/QDBusConnection>
 #include <QtDBus/QDBusConnectionInterface>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusServiceWatcher>
+#include <QtDBus/QDBusUnixFileDescriptor>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+  #include <fcntl.h>
+#endif // Q_OS_UNIX
+
+/* D-Bus cannot pass an invalid descriptor, packs of failed loads pass an empty file instead */
+static
+QDBusUnixFileDescriptor emptyDescriptor()
+{
+  QDBusUnixFileDescriptor descriptor;
+
+#ifdef Q_OS_UNIX
+  const int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+  if (fd >= 0)
+    descriptor.giveFileDescriptor(fd);
+#endif // Q_OS_UNIX
+
+  return descriptor;
+}
+
+/* Callers are told apart by their unique bus names */
+static
+qint64 clientOf(const QString &caller)
+{
+  return static_cast<qint64>(qHash(caller));
+}
+
+static
+void fillDataPack(EDII::IPCQtDBus::DataPack &pack, const DataLoader::LoadedPack &result, const QByteArray &tag)
+{
+  if (!std::get<1>(result)) {
+    pack.success = false;
+    pack.error = std::get<2>(result);
+  } else {
+    plugin::StageTimer serializationTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::SERIALIZATION};
+
+    pack.success = true;
+
+    for (const Data &d : std::get<0>(result)) {
+      EDII::IPCQtDBus::Data dd;
+
+      dd.name = d.name;
+      dd.dataId = d.dataId;
+      dd.path = d.path;
+      dd.xDescription = d.xDescription;
+      dd.yDescription = d.yDescription;
+      dd.xUnit = d.xUnit;
+      dd.yUnit = d.yUnit;
+
+      dd.datapoints.reserve(d.yValues.size());
+      MemoryAccount::charge(sizeof(EDII::IPCQtDBus::Datapoint) * d.yValues.size());
+      for (int idx = 0; idx < d.yValues.size(); idx++) {
+        EDII::IPCQtDBus::Datapoint dp;
+        dp.x = d.xValues.at(idx);
+        dp.y = d.yValues.at(idx);
+        dd.datapoints.append(dp);
+      }
+
+      pack.data.append(dd);
+    }
+  }
+}
 
 DBusIPCProxy::DBusIPCProxy(DataLoader *loader, QObject *parent) :
-  IPCProxy(loader, parent)
+  IPCProxy(loader, parent),
+  m_changeNotifier{nullptr},
+  m_scheduler{nullptr},
+  m_workerPool{nullptr},
+  m_statsProviderId{-1},
+  m_nextSubscriptionId{1}
 {
   EDII::IPCQtDBus::DBusMetaTypesRegistrator::registerAll();
   QDBusConnection connection = QDBusConnection::sessionBus();
+  if (!connection.isConnected())
+    throw std::runtime_error{"Session bus is not available"};
 
   m_interface = new DBusInterface{this};
   m_interfaceAdaptor = new LoaderAdaptor{m_interface};
@@ -22,17 +107,79 @@ DBusIPCProxy::DBusIPCProxy(DataLoader *loader, QObject *parent) :
       throw std::runtime_error{"Cannot register D-Bus object, bailing out"};
   }
 
+  connect(m_interface, &DBusInterface::catalogQueryForwarder, this, &DBusIPCProxy::onCatalogQuery);
+  connect(m_interface, &DBusInterface::flushTraceForwarder, this, &DBusIPCProxy::onFlushTrace);
   connect(m_interface, &DBusInterface::loadDataForwarder, this, &DBusIPCProxy::onLoadData);
+  connect(m_interface, &DBusInterface::loadDataColumnsForwarder, this, &DBusIPCProxy::onLoadDataColumns);
+  connect(m_interface, &DBusInterface::loadDataFdForwarder, this, &DBusIPCProxy::onLoadDataFd);
+  connect(m_interface, &DBusInterface::loadDataTailForwarder, this, &DBusIPCProxy::onLoadDataTail);
+  connect(m_interface, &DBusInterface::loadDataSharedAxesForwarder, this, &DBusIPCProxy::onLoadDataSharedAxes);
+  connect(m_interface, &DBusInterface::statsForwarder, this, &DBusIPCProxy::onStats);
   connect(m_interface, &DBusInterface::supportedFileFormatsForwarder, this, &DBusIPCProxy::onSupportedFileFormats);
+  connect(m_interface, &DBusInterface::subscribeForwarder, this, &DBusIPCProxy::onSubscribe);
+  connect(m_interface, &DBusInterface::unsubscribeForwarder, this, &DBusIPCProxy::onUnsubscribe);
+
+  if (ServiceConfig::instance().subscriptions.enabled)
+    m_changeNotifier = new ChangeNotifier{ServiceConfig::instance().subscriptions, this};
+
+  /* Subscriptions of clients that leave the bus are dropped */
+  m_subscriberWatcher = new QDBusServiceWatcher{QString{}, connection, QDBusServiceWatcher::WatchForUnregistration, this};
+  connect(m_subscriberWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &DBusIPCProxy::onSubscriberGone);
+
+  /* Loads are decoded by workers under the same limits as loads from the local socket,
+   * the thread that receives the calls only hands them over. */
+  m_scheduler = new RequestScheduler{ServiceConfig::instance().scheduler};
+  m_workerPool = new WorkerPool{ServiceConfig::instance().workerPool, m_scheduler->slotCount() + 1};
+
+  m_statsProviderId = ServiceStats::instance().addProvider("dbus", [this]() {
+    return QJsonObject{
+      { "workerPool", m_workerPool->statsJson() },
+      { "decodeSlotsBusy", m_scheduler->busySlots() },
+      { "decodeSlots", m_scheduler->slotCount() },
+      { "queueDepth", m_scheduler->queueDepth() }
+    };
+  });
 }
 
 DBusIPCProxy::~DBusIPCProxy()
 {
   unprovision();
 
+  ServiceStats::instance().removeProvider(m_statsProviderId);
+
+  /* Workers may still reply to calls that came before the object was unregistered */
+  delete m_workerPool;
+  delete m_scheduler;
+
   //delete m_loader;
 }
 
+/* Result is a JSON object with "success", "error" and "results" members, the latter has the same layout as the local socket response */
+void DBusIPCProxy::onCatalogQuery(QString &result, const QString &query, const int maxResults)
+{
+  const auto found = m_loader->queryCatalog(query, maxResults);
+
+  const QJsonObject obj{
+    { "success", std::get<1>(found) },
+    { "error", std::get<2>(found) },
+    { "results", std::get<0>(found) }
+  };
+
+  result = QString::fromUtf8(QJsonDocument{obj}.toJson(QJsonDocument::Compact));
+}
+
+void DBusIPCProxy::onFlushTrace(QString &path)
+{
+  QString error;
+
+  if (RequestTracer::instance().flush(error) < 0) {
+    qWarning() << "Cannot write trace:" << error;
+    return;
+  }
+
+  path = RequestTracer::instance().outputPath();
+}
+
 void DBusIPCProxy::onSupportedFileFormats(EDII::IPCQtDBus::SupportedFileFormatVec &supportedFileFormats)
 {
   const QVector<FileFormatInfo> fileFormatInfoVec = m_loader->supportedFileFormats();
@@ -47,30 +194,316 @@ void DBusIPCProxy::onSupportedFileFormats(EDII::IPCQtDBus::SupportedFileFormatVe
   }
 }
 
-void DBusIPCProxy::onLoadData(EDII::IPCQtDBus::DataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam, const int loadOption)
+void DBusIPCProxy::finishNotification(const uint subscriptionId, const EDII::IPCQtDBus::TailDataPack &pack)
 {
-  DataLoader::LoadedPack result;
+  /* The client may have unsubscribed while the datapoints were being read */
+  auto it = m_subscriptions.find(subscriptionId);
+  if (it == m_subscriptions.end())
+    return;
+
+  it->running = false;
+  if (pack.pack.success)
+    it->cursor = pack.cursor;
+
+  QDBusMessage appended = QDBusMessage::createTargetedSignal(it->subscriber, EDII_DBUS_OBJECT_PATH, EDII_DBUS_INTERFACE_NAME, "fileDataAppended");
+  appended << subscriptionId << QVariant::fromValue(pack);
+  QDBusConnection::sessionBus().send(appended);
 
+  if (it->pending)
+    startNotificationJob(subscriptionId);
+}
+
+/* Called from workers */
+DataLoader::LoadedPack DBusIPCProxy::load(const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam, const int loadOption) const
+{
   switch (mode) {
   case DBusInterface::LoadMode::INTERACTIVE:
-    result = m_loader->loadData(formatTag, loadOption);
-    break;
+    return m_loader->loadData(formatTag, loadOption);
   case DBusInterface::LoadMode::HINT:
-    result = m_loader->loadDataHint(formatTag, modeParam, loadOption);
-    break;
+    return m_loader->loadDataHint(formatTag, modeParam, loadOption);
   case DBusInterface::LoadMode::FILE:
-    result = m_loader->loadDataPath(formatTag, modeParam, loadOption);
-    break;
+  {
+    /* Interactive and hint loads wait for the user and are not scheduled */
+    RequestTracer::Span waitSpan{"schedulerWait"};
+    RequestScheduler::Slot slot{*m_scheduler, RequestScheduler::PriorityClass::INTERACTIVE};
+    waitSpan.stop();
+
+    return m_loader->loadDataPath(formatTag, modeParam, loadOption);
+  }
   }
 
+  return DataLoader::LoadedPack{{}, false, "Invalid load mode"};
+}
+
+/* Signals go only to the subscriber, other clients of the bus do not see them */
+void DBusIPCProxy::notify(const uint subscriptionId, const ChangeNotifier::Change &change)
+{
+  auto it = m_subscriptions.find(subscriptionId);
+  if (it == m_subscriptions.end())
+    return;
+
+  QDBusConnection connection = QDBusConnection::sessionBus();
+  const Subscription sub = *it;
+
+  QDBusMessage changed = QDBusMessage::createTargetedSignal(sub.subscriber, EDII_DBUS_OBJECT_PATH, EDII_DBUS_INTERFACE_NAME, "fileChanged");
+  changed << subscriptionId << static_cast<qlonglong>(change.size) << static_cast<qlonglong>(change.modified) << change.removed;
+  connection.send(changed);
+
+  if (!sub.withData || change.removed)
+    return;
+
+  /* Changes that come while the appended datapoints are being read are picked up by the next read */
+  if (it->running)
+    it->pending = true;
+  else
+    startNotificationJob(subscriptionId);
+}
+
+void DBusIPCProxy::onLoadData(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                              const int loadOption)
+{
+  startJob(message, [this, formatTag, mode, modeParam, loadOption]() {
+    EDII::IPCQtDBus::DataPack pack;
+    loadPack(pack, formatTag, mode, modeParam, loadOption);
+
+    return QVariant::fromValue(pack);
+  });
+}
+
+void DBusIPCProxy::onLoadDataColumns(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                                     const int loadOption)
+{
+  startJob(message, [this, formatTag, mode, modeParam, loadOption]() {
+    EDII::IPCQtDBus::ColumnarDataPack pack;
+    loadPack(pack, formatTag, mode, modeParam, loadOption);
+
+    return QVariant::fromValue(pack);
+  });
+}
+
+void DBusIPCProxy::onLoadDataFd(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                                const int loadOption)
+{
+  startJob(message, [this, formatTag, mode, modeParam, loadOption]() {
+    EDII::IPCQtDBus::FdDataPack pack;
+    loadPack(pack, formatTag, mode, modeParam, loadOption);
+
+    return QVariant::fromValue(pack);
+  });
+}
+
+void DBusIPCProxy::onLoadDataTail(const QDBusMessage &message, const QString &formatTag, const QString &filePath, const int loadOption,
+                                  const qulonglong cursor)
+{
+  startJob(message, [this, formatTag, filePath, loadOption, cursor]() {
+    EDII::IPCQtDBus::TailDataPack pack;
+    loadTailPack(pack, formatTag, filePath, loadOption, cursor);
+
+    return QVariant::fromValue(pack);
+  });
+}
+
+void DBusIPCProxy::onLoadDataSharedAxes(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode,
+                                        const QString &modeParam, const int loadOption)
+{
+  startJob(message, [this, formatTag, mode, modeParam, loadOption]() {
+    EDII::IPCQtDBus::SharedAxesDataPack pack;
+    loadPack(pack, formatTag, mode, modeParam, loadOption);
+
+    return QVariant::fromValue(pack);
+  });
+}
+
+/* Arrays of doubles are marshalled as one block whereas every datapoint of a(dd) is a structure of its own */
+void DBusIPCProxy::loadPack(EDII::IPCQtDBus::ColumnarDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode,
+                            const QString &modeParam, const int loadOption) const
+{
+  const quint64 requestId = RequestTracer::instance().newRequestId();
+  RequestTracer::RequestScope scope{requestId};
+  RequestTracer::Span span{"dbusRequest"};
+  MemoryAccount::RequestReport memoryReport{formatTag, requestId};
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::TOTAL};
+
+  const DataLoader::LoadedPack result = load(formatTag, mode, modeParam, loadOption);
+
+  if (!std::get<1>(result)) {
+    pack.success = false;
+    pack.error = std::get<2>(result);
+    return;
+  }
+
+  plugin::StageTimer serializationTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::SERIALIZATION};
+
+  /* Traces with identical X values are checked for a uniform grid only once */
+  struct Grid {
+    bool uniform;
+    double t0;
+    double dt;
+  };
+  QHash<const double *, Grid> grids;
+
+  pack.success = true;
+  pack.error = "";
+
+  for (const Data &d : std::get<0>(result)) {
+    EDII::IPCQtDBus::ColumnarData dd;
+
+    dd.name = d.name;
+    dd.dataId = d.dataId;
+    dd.path = d.path;
+    dd.xDescription = d.xDescription;
+    dd.yDescription = d.yDescription;
+    dd.xUnit = d.xUnit;
+    dd.yUnit = d.yUnit;
+
+    auto it = grids.constFind(d.xValues.constData());
+    if (it == grids.cend()) {
+      Grid grid{false, 0.0, 0.0};
+      grid.uniform = CompactValuePacker::isUniform(d.xValues.constData(), d.xValues.size(), grid.t0, grid.dt);
+      it = grids.insert(d.xValues.constData(), grid);
+    }
+
+    if (it->uniform) {
+      dd.uniformX = true;
+      dd.t0 = it->t0;
+      dd.dt = it->dt;
+    } else {
+      dd.xValues = d.xValues;
+    }
+    dd.yValues = d.yValues;
+
+    pack.data.append(dd);
+  }
+}
+
+void DBusIPCProxy::loadPack(EDII::IPCQtDBus::DataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                            const int loadOption) const
+{
+  const quint64 requestId = RequestTracer::instance().newRequestId();
+  RequestTracer::RequestScope scope{requestId};
+  RequestTracer::Span span{"dbusRequest"};
+  MemoryAccount::RequestReport memoryReport{formatTag, requestId};
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::TOTAL};
+
+  const DataLoader::LoadedPack result = load(formatTag, mode, modeParam, loadOption);
+
+  fillDataPack(pack, result, tag);
+}
+
+/* Values are placed in a sealed memory file so that they neither go through the bus nor count towards its message size limit */
+void DBusIPCProxy::loadPack(EDII::IPCQtDBus::FdDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                            const int loadOption) const
+{
+  const quint64 requestId = RequestTracer::instance().newRequestId();
+  RequestTracer::RequestScope scope{requestId};
+  RequestTracer::Span span{"dbusRequest"};
+  MemoryAccount::RequestReport memoryReport{formatTag, requestId};
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::TOTAL};
+
+  const DataLoader::LoadedPack result = load(formatTag, mode, modeParam, loadOption);
+
+  if (!std::get<1>(result)) {
+    pack.success = false;
+    pack.error = std::get<2>(result);
+  } else if (!QDBusConnection::sessionBus().connectionCapabilities().testFlag(QDBusConnection::UnixFileDescriptorPassing)) {
+    pack.success = false;
+    pack.error = "The bus cannot pass file descriptors";
+  } else {
+    plugin::StageTimer serializationTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::SERIALIZATION};
+
+    const std::vector<Data> &data = std::get<0>(result);
+    SharedTraceBuffer buffer{};
+    QString error;
+
+    if (!buffer.build(data, error)) {
+      pack.success = false;
+      pack.error = error;
+    } else {
+      pack.success = true;
+      pack.error = "";
+      pack.values.setFileDescriptor(buffer.fd());
+      pack.size = buffer.size();
+
+      for (size_t idx = 0; idx < data.size(); idx++) {
+        const Data &d = data[idx];
+        EDII::IPCQtDBus::FdTraceInfo info;
+
+        info.name = d.name;
+        info.dataId = d.dataId;
+        info.path = d.path;
+        info.xDescription = d.xDescription;
+        info.yDescription = d.yDescription;
+        info.xUnit = d.xUnit;
+        info.yUnit = d.yUnit;
+        info.datapoints = d.yValues.size();
+        info.xOffset = buffer.placements()[idx].xOffset;
+        info.yOffset = buffer.placements()[idx].yOffset;
+
+        pack.data.append(info);
+      }
+    }
+  }
+
+  if (!pack.values.isValid())
+    pack.values = emptyDescriptor();
+}
+
+void DBusIPCProxy::loadTailPack(EDII::IPCQtDBus::TailDataPack &pack, const QString &formatTag, const QString &filePath, const int loadOption,
+                                const qulonglong cursor) const
+{
+  const quint64 requestId = RequestTracer::instance().newRequestId();
+  RequestTracer::RequestScope scope{requestId};
+  RequestTracer::Span span{"dbusRequest"};
+  MemoryAccount::RequestReport memoryReport{formatTag, requestId};
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::TOTAL};
+
+  quint64 newCursor = cursor;
+  bool reset = false;
+  DataLoader::LoadedPack result;
+  {
+    RequestTracer::Span waitSpan{"schedulerWait"};
+    RequestScheduler::Slot slot{*m_scheduler, RequestScheduler::PriorityClass::INTERACTIVE};
+    waitSpan.stop();
+
+    result = m_loader->loadDataPathTail(formatTag, filePath, loadOption, newCursor, reset);
+  }
+
+  fillDataPack(pack.pack, result, tag);
+  if (pack.pack.success) {
+    pack.cursor = newCursor;
+    pack.reset = reset;
+  }
+}
+
+void DBusIPCProxy::loadPack(EDII::IPCQtDBus::SharedAxesDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode,
+                            const QString &modeParam, const int loadOption) const
+{
+  const quint64 requestId = RequestTracer::instance().newRequestId();
+  RequestTracer::RequestScope scope{requestId};
+  RequestTracer::Span span{"dbusRequest"};
+  MemoryAccount::RequestReport memoryReport{formatTag, requestId};
+  const QByteArray tag = formatTag.toUtf8();
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::TOTAL};
+
+  const DataLoader::LoadedPack result = load(formatTag, mode, modeParam, loadOption);
+
   if (!std::get<1>(result)) {
     pack.success = false;
     pack.error = std::get<2>(result);
   } else {
+    plugin::StageTimer serializationTimer{UIPlugin::instance(), tag.constData(), plugin::LoadStage::SERIALIZATION};
+
+    QHash<const double *, int32_t> axisIndices;
+
     pack.success = true;
+    pack.error = "";
 
     for (const Data &d : std::get<0>(result)) {
-      EDII::IPCQtDBus::Data dd;
+      EDII::IPCQtDBus::SharedAxisData dd;
 
       dd.name = d.name;
       dd.dataId = d.dataId;
@@ -80,18 +513,145 @@ void DBusIPCProxy::onLoadData(EDII::IPCQtDBus::DataPack &pack, const QString &fo
       dd.xUnit = d.xUnit;
       dd.yUnit = d.yUnit;
 
-      for (const auto &point : d.datapoints) {
-        EDII::IPCQtDBus::Datapoint dp;
-        dp.x = std::get<0>(point);
-        dp.y = std::get<1>(point);
-        dd.datapoints.append(dp);
+      const auto it = axisIndices.constFind(d.xValues.constData());
+      if (it != axisIndices.cend())
+        dd.axis = *it;
+      else {
+        dd.axis = pack.axes.size();
+        axisIndices.insert(d.xValues.constData(), dd.axis);
+        pack.axes.append(d.xValues);
       }
+      dd.yValues = d.yValues;
 
       pack.data.append(dd);
     }
   }
 }
 
+void DBusIPCProxy::onStats(QString &stats)
+{
+  stats = QString::fromUtf8(ServiceStats::instance().toJson());
+}
+
+void DBusIPCProxy::onSubscribe(uint &subscriptionId, const QString &subscriber, const QString &formatTag, const QString &filePath,
+                               const int loadOption, const bool withData, const qulonglong cursor)
+{
+  subscriptionId = 0;
+
+  if (m_changeNotifier == nullptr || subscriber.isEmpty() || filePath.isEmpty() || (withData && formatTag.isEmpty()))
+    return;
+
+  const int maxPerClient = ServiceConfig::instance().subscriptions.maxPerClient;
+  if (maxPerClient > 0) {
+    int count = 0;
+    for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+      if (it->subscriber == subscriber)
+        count++;
+    }
+    if (count >= maxPerClient)
+      return;
+  }
+
+  const uint id = m_nextSubscriptionId++;
+  const int watchId = m_changeNotifier->watch(filePath, [this, id](const ChangeNotifier::Change &change) {
+    notify(id, change);
+  });
+  if (watchId < 0)
+    return;
+
+  m_subscriptions.insert(id, Subscription{subscriber, formatTag, filePath, loadOption, withData, cursor, watchId, false, false});
+  if (!m_subscriberWatcher->watchedServices().contains(subscriber))
+    m_subscriberWatcher->addWatchedService(subscriber);
+
+  subscriptionId = id;
+}
+
+void DBusIPCProxy::onSubscriberGone(const QString &subscriber)
+{
+  QVector<uint> gone;
+
+  for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+    if (it->subscriber == subscriber)
+      gone.append(it.key());
+  }
+
+  for (const uint id : gone)
+    removeSubscription(id);
+}
+
+/* Clients may end only their own subscriptions */
+void DBusIPCProxy::onUnsubscribe(bool &removed, const QString &subscriber, const uint subscriptionId)
+{
+  const auto it = m_subscriptions.constFind(subscriptionId);
+
+  removed = it != m_subscriptions.cend() && it->subscriber == subscriber;
+  if (removed)
+    removeSubscription(subscriptionId);
+}
+
+void DBusIPCProxy::removeSubscription(const uint subscriptionId)
+{
+  const auto it = m_subscriptions.find(subscriptionId);
+  if (it == m_subscriptions.end())
+    return;
+
+  const QString subscriber = it->subscriber;
+
+  m_changeNotifier->unwatch(it->watchId);
+  m_subscriptions.erase(it);
+
+  for (auto sIt = m_subscriptions.cbegin(); sIt != m_subscriptions.cend(); ++sIt) {
+    if (sIt->subscriber == subscriber)
+      return;
+  }
+  m_subscriberWatcher->removeWatchedService(subscriber);
+}
+
+/* The reply is sent by the worker, a call refused by the pool gets an error the caller may retry after */
+void DBusIPCProxy::startJob(const QDBusMessage &message, std::function<QVariant ()> work)
+{
+  QRunnable *job = QRunnable::create([message, work]() {
+    QDBusConnection::sessionBus().send(message.createReply(work()));
+  });
+
+  if (!m_workerPool->tryStart(clientOf(message.service()), job)) {
+    const QString error = QString{"EDII is busy, retry after %1 ms"}.arg(m_workerPool->retryAfter());
+    QDBusConnection::sessionBus().send(message.createErrorReply(EDII_DBUS_INTERFACE_NAME ".Busy", error));
+  }
+}
+
+void DBusIPCProxy::startNotificationJob(const uint subscriptionId)
+{
+  auto it = m_subscriptions.find(subscriptionId);
+  if (it == m_subscriptions.end())
+    return;
+
+  it->pending = false;
+
+  const Subscription sub = *it;
+  QRunnable *job = QRunnable::create([this, subscriptionId, sub]() {
+    EDII::IPCQtDBus::TailDataPack pack;
+    loadTailPack(pack, sub.tag, sub.path, sub.loadOption, sub.cursor);
+
+    QMetaObject::invokeMethod(this, [this, subscriptionId, pack]() {
+      finishNotification(subscriptionId, pack);
+    }, Qt::QueuedConnection);
+  });
+
+  if (!m_workerPool->tryStart(clientOf(sub.subscriber), job)) {
+    /* The change is not lost, it is read once the pool has room */
+    it->pending = true;
+    QTimer::singleShot(m_workerPool->retryAfter(), this, [this, subscriptionId]() {
+      const auto sIt = m_subscriptions.constFind(subscriptionId);
+      if (sIt != m_subscriptions.cend() && sIt->pending && !sIt->running)
+        startNotificationJob(subscriptionId);
+    });
+    return;
+  }
+
+  it->running = true;
+}
+
 void DBusIPCProxy::unprovision()
 {
   QDBusConnection connection = QDBusConnection::sessionBus();
@@ -3,10 +3,17 @@
 
 #ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
 
+#include "changenotifier.h"
 #include "ipcproxy.h"
 #include "dbus/dbusinterface.h"
 
+#include <QHash>
+#include <functional>
+
 class LoaderAdaptor;
+class QDBusServiceWatcher;
+class RequestScheduler;
+class WorkerPool;
 
 class DBusIPCProxy : public IPCProxy
 {
@@ -15,14 +22,61 @@ public:
   virtual ~DBusIPCProxy();
 
 private:
+  class Subscription {
+  public:
+    QString subscriber;                 /* Unique bus name of the client */
+    QString tag;
+    QString path;
+    int loadOption;
+    bool withData;
+    quint64 cursor;
+    int watchId;
+    bool running;                       /* Appended datapoints are being read */
+    bool pending;                       /* Another change came while they were being read */
+  };
+
+  void finishNotification(const uint subscriptionId, const EDII::IPCQtDBus::TailDataPack &pack);
+  DataLoader::LoadedPack load(const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam, const int loadOption) const;
+  void loadPack(EDII::IPCQtDBus::ColumnarDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                const int loadOption) const;
+  void loadPack(EDII::IPCQtDBus::DataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                const int loadOption) const;
+  void loadPack(EDII::IPCQtDBus::FdDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                const int loadOption) const;
+  void loadPack(EDII::IPCQtDBus::SharedAxesDataPack &pack, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam,
+                const int loadOption) const;
+  void loadTailPack(EDII::IPCQtDBus::TailDataPack &pack, const QString &formatTag, const QString &filePath, const int loadOption,
+                    const qulonglong cursor) const;
+  void notify(const uint subscriptionId, const ChangeNotifier::Change &change);
+  void removeSubscription(const uint subscriptionId);
+  void startJob(const QDBusMessage &message, std::function<QVariant ()> work);
+  void startNotificationJob(const uint subscriptionId);
   void unprovision();
 
   DBusInterface *m_interface;
   LoaderAdaptor *m_interfaceAdaptor;
+  ChangeNotifier *m_changeNotifier;     /* Null when subscriptions are disabled */
+  QDBusServiceWatcher *m_subscriberWatcher;
+  RequestScheduler *m_scheduler;
+  WorkerPool *m_workerPool;             /* Loads run here, calls are replied to by the workers */
+  int m_statsProviderId;
+  QHash<uint, Subscription> m_subscriptions;
+  uint m_nextSubscriptionId;
 
 private slots:
+  void onCatalogQuery(QString &result, const QString &query, const int maxResults);
+  void onFlushTrace(QString &path);
   void onSupportedFileFormats(EDII::IPCQtDBus::SupportedFileFormatVec &supportedFileFormats);
-  void onLoadData(EDII::IPCQtDBus::DataPack &pack, const QString &formatTag, const DBusInterface::LoadMode loadMode, const QString &modeParam, const int loadOption);
+  void onLoadData(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode loadMode, const QString &modeParam, const int loadOption);
+  void onLoadDataColumns(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam, const int loadOption);
+  void onLoadDataFd(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode mode, const QString &modeParam, const int loadOption);
+  void onLoadDataTail(const QDBusMessage &message, const QString &formatTag, const QString &filePath, const int loadOption, const qulonglong cursor);
+  void onLoadDataSharedAxes(const QDBusMessage &message, const QString &formatTag, const DBusInterface::LoadMode loadMode, const QString &modeParam, const int loadOption);
+  void onStats(QString &stats);
+  void onSubscribe(uint &subscriptionId, const QString &subscriber, const QString &formatTag, const QString &filePath, const int loadOption,
+                   const bool withData, const qulonglong cursor);
+  void onSubscriberGone(const QString &subscriber);
+  void onUnsubscribe(bool &removed, const QString &subscriber, const uint subscriptionId);
 };
 
 #endif // ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
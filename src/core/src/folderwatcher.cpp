@@ -0,0 +1,141 @@
+#include "folderwatcher.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <algorithm>
+
+bool FolderWatcher::Stamp::operator==(const Stamp &other) const
+{
+  return size == other.size && modified == other.modified;
+}
+
+FolderWatcher::FolderWatcher(const ServiceConfig::WatchFolders &config, Ingest ingest, QObject *parent) :
+  QObject{parent},
+  m_config{config},
+  m_ingest{std::move(ingest)}
+{
+  m_watcher = new QFileSystemWatcher{this};
+  m_settleTimer = new QTimer{this};
+
+  /* Pending files are checked a few times per settle period */
+  m_settleTimer->setInterval(std::clamp(m_config.settleTime / 4, 100, 1000));
+
+  connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &FolderWatcher::onDirectoryChanged);
+  connect(m_settleTimer, &QTimer::timeout, this, &FolderWatcher::onSettleTimeout);
+
+  for (int idx = 0; idx < m_config.folders.size(); idx++) {
+    const QString path = QDir{m_config.folders.at(idx).path}.absolutePath();
+
+    if (!QFileInfo{path}.isDir()) {
+      qWarning() << "Watched folder" << path << "does not exist";
+      continue;
+    }
+
+    m_directories.insert(path, idx);
+    m_watcher->addPath(path);
+    scanDirectory(path, true);
+  }
+}
+
+void FolderWatcher::onDirectoryChanged(const QString &path)
+{
+  if (!QFileInfo{path}.isDir()) {
+    /* QFileSystemWatcher stops watching removed directories by itself */
+    m_directories.remove(path);
+    return;
+  }
+
+  scanDirectory(path, false);
+}
+
+void FolderWatcher::onSettleTimeout()
+{
+  for (auto it = m_pending.begin(); it != m_pending.end();) {
+    const Stamp stamp = stampOf(it.key());
+
+    if (stamp.size < 0) {
+      it = m_pending.erase(it);
+      continue;
+    }
+
+    if (!(stamp == it->stamp)) {
+      it->stamp = stamp;
+      it->unchangedFor.restart();
+      ++it;
+      continue;
+    }
+
+    if (it->unchangedFor.elapsed() < m_config.settleTime) {
+      ++it;
+      continue;
+    }
+
+    m_known.insert(it.key(), stamp);
+    m_ingest(m_config.folders.at(it->folder).tag, it.key());
+    it = m_pending.erase(it);
+  }
+
+  if (m_pending.isEmpty())
+    m_settleTimer->stop();
+}
+
+void FolderWatcher::scanDirectory(const QString &path, const bool initial)
+{
+  const auto dirIt = m_directories.constFind(path);
+  if (dirIt == m_directories.cend())
+    return;
+
+  const int folderIdx = *dirIt;
+  const ServiceConfig::Folder &folder = m_config.folders.at(folderIdx);
+  const QDir dir{path};
+
+  /* Only subdirectories of the configured folder itself are watched */
+  if (path == QDir{folder.path}.absolutePath()) {
+    for (const QFileInfo &fi : dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable)) {
+      const QString subPath = fi.absoluteFilePath();
+      if (m_directories.contains(subPath))
+        continue;
+
+      m_directories.insert(subPath, folderIdx);
+      m_watcher->addPath(subPath);
+      scanDirectory(subPath, initial);
+    }
+  }
+
+  for (const QFileInfo &fi : dir.entryInfoList(folder.nameFilters, QDir::Files | QDir::Readable)) {
+    const QString filePath = fi.absoluteFilePath();
+    const Stamp stamp{fi.size(), fi.lastModified().toMSecsSinceEpoch()};
+
+    if (initial) {
+      m_known.insert(filePath, stamp);
+      continue;
+    }
+
+    const auto knownIt = m_known.constFind(filePath);
+    if (knownIt != m_known.cend() && *knownIt == stamp)
+      continue;
+    if (m_pending.contains(filePath))
+      continue;
+
+    Pending pending{folderIdx, stamp, {}};
+    pending.unchangedFor.start();
+    m_pending.insert(filePath, pending);
+  }
+
+  if (!m_pending.isEmpty() && !m_settleTimer->isActive())
+    m_settleTimer->start();
+}
+
+FolderWatcher::Stamp FolderWatcher::stampOf(const QString &path)
+{
+  const QFileInfo fi{path};
+
+  if (!fi.exists())
+    return {-1, -1};
+
+  return {fi.size(), fi.lastModified().toMSecsSinceEpoch()};
+}
@@ -0,0 +1,63 @@
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include "serviceconfig.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <functional>
+
+class QFileSystemWatcher;
+class QTimer;
+
+/*
+ * Watches folders where instruments store acquired data and passes each new
+ * or modified file on once it stops changing. Files in subdirectories one
+ * level deep (such as ChemStation's *.D directories) are watched too. Files
+ * that exist when watching starts are not passed on.
+ */
+class FolderWatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  /* Called with the format tag of the folder and the path to a settled file */
+  typedef std::function<void (const QString &, const QString &)> Ingest;
+
+  explicit FolderWatcher(const ServiceConfig::WatchFolders &config, Ingest ingest, QObject *parent = nullptr);
+
+private:
+  class Stamp {
+  public:
+    bool operator==(const Stamp &other) const;
+
+    qint64 size;
+    qint64 modified;
+  };
+
+  class Pending {
+  public:
+    int folder;
+    Stamp stamp;
+    QElapsedTimer unchangedFor;
+  };
+
+  void scanDirectory(const QString &path, const bool initial);
+  static Stamp stampOf(const QString &path);
+
+  const ServiceConfig::WatchFolders m_config;
+  const Ingest m_ingest;
+
+  QFileSystemWatcher *m_watcher;
+  QTimer *m_settleTimer;
+  QHash<QString, int> m_directories;        /* Watched directory -> index of its folder in the configuration */
+  QHash<QString, Stamp> m_known;            /* Files that were ingested or existed before watching started */
+  QHash<QString, Pending> m_pending;
+
+private slots:
+  void onDirectoryChanged(const QString &path);
+  void onSettleTimeout();
+};
+
+#endif // FOLDERWATCHER_H
@@ -0,0 +1,1272 @@
+#include "localsocketconnection.h"
+#include "localsocketconnectionhandler.h"
+#include "requesttracer.h"
+#include "serviceconfig.h"
+#include "servicestats.h"
+#include "workerpool.h"
+
+#include <edii_ipc_network.h>
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QLocalSocket>
+#include <QRunnable>
+#include <QTimer>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+  #include <errno.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+#endif // Q_OS_LINUX
+
+/* Requests of one connection that may be handled at the same time, further requests wait in the socket */
+#define MAX_PIPELINED_REQUESTS 32
+/* Requests carry only descriptors, tags, paths and queries */
+#define MAX_REQUEST_LENGTH (1024 * 1024)
+/* Streamed responses are passed on in parts of this size */
+#define STREAM_PART_SIZE (256 * 1024)
+/* Delay before another attempt to pass a descriptor through a full socket */
+#define DESCRIPTOR_RETRY_MS 1
+/* Time a request may wait for the client to read its response */
+#define HANDLING_TIMEOUT 5000
+
+/*
+ * Returns the length of the request at the beginning of the data, zero if
+ * more data is needed to tell and -1 if the data cannot start a request.
+ * Only the lengths are checked here, the handler validates the rest.
+ */
+static
+qint64 requestLength(const QByteArray &data)
+{
+  static const qint64 HEADER_SIZE = sizeof(EDII_IPCSockRequestHeader);
+
+  if (data.size() < HEADER_SIZE)
+    return 0;
+
+  const auto header = reinterpret_cast<const EDII_IPCSockRequestHeader *>(data.constData());
+  if (header->magic != EDII_IPCS_PACKET_MAGIC)
+    return -1;
+
+  switch (header->requestType) {
+  case EDII_REQUEST_SUPPORTED_FORMATS:
+  case EDII_REQUEST_ABI_VERSION:
+  case EDII_REQUEST_STATS:
+  case EDII_REQUEST_FLUSH_TRACE:
+    return HEADER_SIZE;
+  case EDII_REQUEST_ABI_VERSION_EXT:
+    return HEADER_SIZE + sizeof(EDII_IPCSockABIVersionRequestDescriptor);
+  case EDII_REQUEST_UNSUBSCRIBE:
+    return HEADER_SIZE + sizeof(EDII_IPCSockUnsubscribeRequestDescriptor);
+  case EDII_REQUEST_LOAD_BATCH:
+  {
+    static const qint64 DESC_SIZE = sizeof(EDII_IPCSockLoadBatchRequestDescriptor);
+
+    if (data.size() < HEADER_SIZE + DESC_SIZE)
+      return 0;
+
+    const auto desc = reinterpret_cast<const EDII_IPCSockLoadBatchRequestDescriptor *>(data.constData() + HEADER_SIZE);
+    return HEADER_SIZE + DESC_SIZE + desc->entriesLength;
+  }
+  case EDII_REQUEST_SUBSCRIBE:
+  {
+    static const qint64 DESC_SIZE = sizeof(EDII_IPCSockSubscribeRequestDescriptor);
+
+    if (data.size() < HEADER_SIZE + DESC_SIZE)
+      return 0;
+
+    const auto desc = reinterpret_cast<const EDII_IPCSockSubscribeRequestDescriptor *>(data.constData() + HEADER_SIZE);
+    return HEADER_SIZE + DESC_SIZE + desc->tagLength + desc->filePathLength;
+  }
+  case EDII_REQUEST_CATALOG_QUERY:
+  {
+    static const qint64 DESC_SIZE = sizeof(EDII_IPCSockCatalogQueryRequestDescriptor);
+
+    if (data.size() < HEADER_SIZE + DESC_SIZE)
+      return 0;
+
+    const auto desc = reinterpret_cast<const EDII_IPCSockCatalogQueryRequestDescriptor *>(data.constData() + HEADER_SIZE);
+    return HEADER_SIZE + DESC_SIZE + desc->queryLength;
+  }
+  case EDII_REQUEST_LOAD_DATA:
+  {
+    static const qint64 DESC_SIZE = sizeof(EDII_IPCSockLoadDataRequestDescriptor);
+
+    if (data.size() < HEADER_SIZE + DESC_SIZE)
+      return 0;
+
+    const auto desc = reinterpret_cast<const EDII_IPCSockLoadDataRequestDescriptor *>(data.constData() + HEADER_SIZE);
+    qint64 length = HEADER_SIZE + desc->tagLength;
+
+    switch (desc->requestType) {
+    case EDII_REQUEST_LOAD_DATA_DESCRIPTOR:
+      length += DESC_SIZE;
+      break;
+    case EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT:
+      length += sizeof(EDII_IPCSockLoadDataRequestDescriptorExt);
+      break;
+    case EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL:
+      length += sizeof(EDII_IPCSockLoadDataRequestDescriptorTail);
+      break;
+    default:
+      return -1;
+    }
+
+    if (desc->mode == EDII_IPCS_LOAD_FILE || desc->mode == EDII_IPCS_LOAD_HINT)
+      length += desc->filePathLength;
+
+    return length;
+  }
+  default:
+    return -1;
+  }
+}
+
+/* Returns zero if the request is too short to tell */
+static
+uint8_t requestTypeOf(const QByteArray &request)
+{
+  if (request.size() < static_cast<qsizetype>(sizeof(EDII_IPCSockRequestHeader)))
+    return 0;
+
+  return reinterpret_cast<const EDII_IPCSockRequestHeader *>(request.constData())->requestType;
+}
+
+/* Builds a load request as a client would send it */
+static
+QByteArray loadRequest(const QByteArray &tagRaw, const QByteArray &pathRaw, const int32_t loadOption, const uint32_t flags)
+{
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_LOAD_DATA;
+
+  EDII_IPCSockLoadDataRequestDescriptorExt desc;
+  desc.magic = EDII_IPCS_PACKET_MAGIC;
+  desc.requestType = EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT;
+  desc.mode = EDII_IPCS_LOAD_FILE;
+  desc.loadOption = loadOption;
+  desc.tagLength = tagRaw.size();
+  desc.filePathLength = pathRaw.size();
+  desc.flags = flags;
+
+  QByteArray request{reinterpret_cast<const char *>(&header), sizeof(header)};
+  request.append(reinterpret_cast<const char *>(&desc), sizeof(desc));
+  request.append(tagRaw);
+  request.append(pathRaw);
+
+  return request;
+}
+
+/* Builds an incremental load request as a client would send it */
+static
+QByteArray tailRequest(const QString &tag, const QString &path, const int32_t loadOption, const uint32_t loadFlags, const quint64 cursor)
+{
+  const QByteArray tagRaw = tag.toUtf8();
+  const QByteArray pathRaw = path.toUtf8();
+
+  EDII_IPCSockRequestHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.requestType = EDII_REQUEST_LOAD_DATA;
+
+  EDII_IPCSockLoadDataRequestDescriptorTail desc;
+  desc.magic = EDII_IPCS_PACKET_MAGIC;
+  desc.requestType = EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL;
+  desc.mode = EDII_IPCS_LOAD_FILE;
+  desc.loadOption = loadOption;
+  desc.tagLength = tagRaw.size();
+  desc.filePathLength = pathRaw.size();
+  desc.flags = loadFlags;
+  desc.cursor = cursor;
+
+  QByteArray request{reinterpret_cast<const char *>(&header), sizeof(header)};
+  request.append(reinterpret_cast<const char *>(&desc), sizeof(desc));
+  request.append(tagRaw);
+  request.append(pathRaw);
+
+  return request;
+}
+
+/* Identifies the client by its process so that it cannot get around its limit by opening more connections */
+static
+qint64 clientOf(const quintptr sockDesc)
+{
+#ifdef Q_OS_LINUX
+  struct ucred cred;
+  socklen_t length = sizeof(cred);
+
+  if (::getsockopt(static_cast<int>(sockDesc), SOL_SOCKET, SO_PEERCRED, &cred, &length) == 0 && cred.pid > 0)
+    return cred.pid;
+#endif // Q_OS_LINUX
+
+  /* Otherwise each connection counts as a client, negative values do not collide with process IDs */
+  return -static_cast<qint64>(sockDesc);
+}
+
+/* Returns the number of bytes sent, zero if the socket is full and -1 on failure */
+static
+qint64 sendWithDescriptor(const qintptr sock, const QByteArray &bytes, const int fd)
+{
+#ifdef Q_OS_LINUX
+  char control[CMSG_SPACE(sizeof(int))];
+  struct iovec iov;
+  struct msghdr msg;
+
+  std::memset(control, 0, sizeof(control));
+  std::memset(&msg, 0, sizeof(msg));
+  iov.iov_base = const_cast<char *>(bytes.constData());
+  iov.iov_len = bytes.size();
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  for (;;) {
+    const ssize_t sent = ::sendmsg(static_cast<int>(sock), &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent >= 0)
+      return sent;
+    if (errno == EINTR)
+      continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return 0;
+
+    qWarning() << "Cannot send file descriptor:" << std::strerror(errno);
+    return -1;
+  }
+#else
+  Q_UNUSED(sock); Q_UNUSED(bytes); Q_UNUSED(fd);
+
+  return -1;
+#endif // Q_OS_LINUX
+}
+
+RequestDevice::RequestDevice(const QByteArray &request, PartSink partSink, const bool descriptorPassing) :
+  m_request{request},
+  m_partSink{std::move(partSink)},
+  m_descriptorPassing{descriptorPassing && m_partSink != nullptr},
+  m_readPos{0}
+{
+  open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+qint64 RequestDevice::bytesAvailable() const
+{
+  return m_request.size() - m_readPos + QIODevice::bytesAvailable();
+}
+
+bool RequestDevice::canPassDescriptors() const
+{
+  return m_descriptorPassing;
+}
+
+/* Reads and writes go to separate buffers, there is no position to seek to */
+bool RequestDevice::isSequential() const
+{
+  return true;
+}
+
+qint64 RequestDevice::readData(char *data, qint64 maxSize)
+{
+  const qint64 n = std::min(maxSize, m_request.size() - m_readPos);
+
+  std::memcpy(data, m_request.constData() + m_readPos, n);
+  m_readPos += n;
+
+  return n;
+}
+
+const QByteArray & RequestDevice::response() const
+{
+  return m_response;
+}
+
+/* The descriptor is passed with the first of the bytes, after everything written before */
+bool RequestDevice::writeWithDescriptor(const QByteArray &bytes, const int fd)
+{
+  if (!m_descriptorPassing)
+    return false;
+
+  if (!m_response.isEmpty()) {
+    if (!m_partSink(m_response, -1))
+      return false;
+    m_response.clear();
+  }
+
+  return m_partSink(bytes, fd);
+}
+
+qint64 RequestDevice::writeData(const char *data, qint64 maxSize)
+{
+  m_response.append(data, maxSize);
+
+  if (m_partSink && m_response.size() >= STREAM_PART_SIZE) {
+    if (!m_partSink(m_response, -1))
+      return -1;
+    m_response.clear();
+  }
+
+  return maxSize;
+}
+
+class LocalSocketConnection::RequestJob : public QRunnable
+{
+public:
+  RequestJob(LocalSocketConnection &connection, const quint32 requestId, const QByteArray &request,
+             const bool streamed, const bool descriptorPassing) :
+    h_connection{connection},
+    m_requestId{requestId},
+    m_request{request},
+    m_streamed{streamed},
+    m_descriptorPassing{descriptorPassing},
+    m_queuedAt{RequestTracer::instance().now()}
+  {}
+
+  virtual void run() override
+  {
+    LocalSocketConnectionHandler handler{h_connection.h_loader, h_connection.h_scheduler, m_queuedAt};
+    RequestDevice::PartSink partSink{};
+
+    if (m_streamed) {
+      partSink = [this](const QByteArray &part, const int fd) {
+        return h_connection.sendPart(m_requestId, part, fd);
+      };
+    }
+    RequestDevice device{m_request, std::move(partSink), m_descriptorPassing};
+
+    uint32_t capabilities;
+    const bool ok = handler.handle(&device, capabilities);
+    const QByteArray response = device.response();
+
+    /* The socket belongs to the I/O thread */
+    LocalSocketConnection *connection = &h_connection;
+    const quint32 requestId = m_requestId;
+    QMetaObject::invokeMethod(connection, [connection, requestId, ok, response, capabilities]() {
+      connection->finish(requestId, ok, response, capabilities);
+    }, Qt::QueuedConnection);
+  }
+
+private:
+  LocalSocketConnection &h_connection;
+  const quint32 m_requestId;
+  const QByteArray m_request;
+  const bool m_streamed;
+  const bool m_descriptorPassing;
+  const qint64 m_queuedAt;
+};
+
+/*
+ * Handles a request made up by the connection itself, such as an entry of
+ * a batch, and passes the whole response back to the I/O thread.
+ */
+class LocalSocketConnection::InternalJob : public QRunnable
+{
+public:
+  /* Called in the I/O thread with the result of the handler, its response and the cursor of an incremental load */
+  typedef std::function<void (const bool, const QByteArray &, const quint64)> Done;
+
+  InternalJob(LocalSocketConnection &connection, const QByteArray &request, Done done) :
+    h_connection{connection},
+    m_request{request},
+    m_done{std::move(done)},
+    m_queuedAt{RequestTracer::instance().now()}
+  {}
+
+  virtual void run() override
+  {
+    LocalSocketConnectionHandler handler{h_connection.h_loader, h_connection.h_scheduler, m_queuedAt};
+    RequestDevice device{m_request};
+
+    uint32_t capabilities;
+    const bool ok = handler.handle(&device, capabilities);
+    const QByteArray response = device.response();
+    const quint64 cursor = handler.tailCursor();
+
+    const Done done = m_done;
+    QMetaObject::invokeMethod(&h_connection, [done, ok, response, cursor]() {
+      done(ok, response, cursor);
+    }, Qt::QueuedConnection);
+  }
+
+private:
+  LocalSocketConnection &h_connection;
+  const QByteArray m_request;
+  const Done m_done;
+  const qint64 m_queuedAt;
+};
+
+LocalSocketConnection::LocalSocketConnection(const quintptr sockDesc, const DataLoader &loader, RequestScheduler &scheduler, WorkerPool &pool,
+                                             ChangeNotifier *notifier) :
+  QObject{nullptr},
+  m_sockDesc{sockDesc},
+  h_loader{loader},
+  h_scheduler{scheduler},
+  h_pool{pool},
+  m_notifier{notifier},
+  m_sendWindow{ServiceConfig::instance().scheduler.sendWindow},
+  m_socket{nullptr},
+  m_clientId{0},
+  m_persistent{false},
+  m_streaming{false},
+  m_inFlight{0},
+  m_notifying{0},
+  m_closed{false},
+  m_closeWhenWritten{false},
+  m_retryScheduled{false},
+  m_nextSubscriptionId{1},
+  m_unsent{0},
+  m_windowClosed{false}
+{
+}
+
+LocalSocketConnection::~LocalSocketConnection()
+{
+#ifdef Q_OS_LINUX
+  for (const auto &o : m_outgoing) {
+    if (o.fd >= 0)
+      ::close(o.fd);
+  }
+#endif // Q_OS_LINUX
+}
+
+void LocalSocketConnection::abort()
+{
+  if (m_closed)
+    return;
+
+  m_closed = true;
+  closeWindow();
+  dropBatches();
+  dropSubscriptions();
+  if (m_socket != nullptr)
+    m_socket->abort();
+  deleteIfDone();
+}
+
+/* Releases requests that wait for the window, their remaining parts are dropped */
+void LocalSocketConnection::closeWindow()
+{
+  QMutexLocker locker{&m_windowLock};
+
+  m_windowClosed = true;
+  m_windowFreed.wakeAll();
+}
+
+/* Requests in flight refer to the connection until they finish */
+void LocalSocketConnection::deleteIfDone()
+{
+  if (m_closed && m_inFlight == 0 && m_notifying == 0)
+    deleteLater();
+}
+
+void LocalSocketConnection::dispatch()
+{
+  if (m_closed)
+    return;
+
+  if (m_persistent)
+    dispatchEnvelopes();
+  else
+    dispatchDirect();
+}
+
+void LocalSocketConnection::dispatchDirect()
+{
+  if (m_inFlight > 0 || m_closeWhenWritten)
+    return;
+
+  const QByteArray head = m_socket->peek(std::min<qint64>(m_socket->bytesAvailable(), MAX_REQUEST_LENGTH));
+  const qint64 length = requestLength(head);
+
+  if (length < 0 || length > MAX_REQUEST_LENGTH) {
+    qWarning() << "Invalid request, closing connection";
+    abort();
+    return;
+  }
+  if (length == 0 || m_socket->bytesAvailable() < length)
+    return;
+
+  const QByteArray request = m_socket->read(length);
+  switch (requestTypeOf(request)) {
+  case EDII_REQUEST_SUBSCRIBE:
+  case EDII_REQUEST_UNSUBSCRIBE:
+    respondSubscription(0, EDII_IPCS_FAILURE, 0, "Subscriptions need a persistent connection");
+    break;
+  case EDII_REQUEST_LOAD_BATCH:
+    startBatch(0, request);
+    break;
+  default:
+    startJob(0, request);
+  }
+}
+
+void LocalSocketConnection::dispatchEnvelopes()
+{
+  static const qint64 ENVELOPE_SIZE = sizeof(EDII_IPCSockEnvelope);
+
+  while (!m_closed && m_inFlight < MAX_PIPELINED_REQUESTS) {
+    EDII_IPCSockEnvelope envelope;
+
+    if (m_socket->bytesAvailable() < ENVELOPE_SIZE)
+      return;
+    m_socket->peek(reinterpret_cast<char *>(&envelope), ENVELOPE_SIZE);
+
+    if (envelope.magic != EDII_IPCS_PACKET_MAGIC || envelope.envelopeType != EDII_ENVELOPE_REQUEST ||
+        envelope.length > MAX_REQUEST_LENGTH) {
+      qWarning() << "Invalid request envelope, closing connection";
+      abort();
+      return;
+    }
+
+    if (m_socket->bytesAvailable() < ENVELOPE_SIZE + envelope.length)
+      return;
+
+    m_socket->skip(ENVELOPE_SIZE);
+    const QByteArray request = m_socket->read(envelope.length);
+
+    /* Batches and subscriptions are taken care of by the connection */
+    switch (requestTypeOf(request)) {
+    case EDII_REQUEST_SUBSCRIBE:
+      subscribe(envelope.requestId, request);
+      break;
+    case EDII_REQUEST_UNSUBSCRIBE:
+      unsubscribe(envelope.requestId, request);
+      break;
+    case EDII_REQUEST_LOAD_BATCH:
+      startBatch(envelope.requestId, request);
+      break;
+    default:
+      startJob(envelope.requestId, request);
+    }
+  }
+}
+
+/* Batches with entries still running are released as the entries finish */
+void LocalSocketConnection::dropBatches()
+{
+  for (auto it = m_batches.begin(); it != m_batches.end();) {
+    if (it->running > 0) {
+      ++it;
+      continue;
+    }
+
+    it = m_batches.erase(it);
+    m_inFlight--;
+  }
+}
+
+void LocalSocketConnection::dropSubscriptions()
+{
+  for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it)
+    m_notifier->unwatch(it->watchId);
+  m_subscriptions.clear();
+}
+
+void LocalSocketConnection::finish(const quint32 requestId, const bool ok, const QByteArray &response, const uint32_t capabilities)
+{
+  m_inFlight--;
+
+  if (!m_closed) {
+    if (m_persistent) {
+      reserveWindow(response.size());
+      writeEnvelope(EDII_ENVELOPE_RESPONSE, ok ? EDII_IPCS_SUCCESS : EDII_IPCS_FAILURE, requestId, response);
+    } else {
+      reserveWindow(response.size());
+      queue(response, -1);
+
+      /* Capabilities of a connection that is already persistent do not change */
+      if (ok && (capabilities & EDII_IPCS_CAP_PERSISTENT)) {
+        m_persistent = true;
+        m_streaming = capabilities & EDII_IPCS_CAP_STREAMING;
+      } else {
+        m_closeWhenWritten = true;
+        flushOutgoing();
+      }
+    }
+
+    /* Requests may have been left waiting for a free place */
+    dispatch();
+  }
+
+  deleteIfDone();
+}
+
+void LocalSocketConnection::finishBatchEntry(const quint32 requestId, const quint32 entry, const bool ok, const QByteArray &response)
+{
+  m_inFlight--;
+
+  auto it = m_batches.find(requestId);
+  if (it == m_batches.end()) {
+    deleteIfDone();
+    return;
+  }
+
+  it->running--;
+  it->done++;
+
+  if (m_closed) {
+    if (it->running == 0) {
+      m_batches.erase(it);
+      m_inFlight--;
+    }
+  } else {
+    EDII_IPCSockLoadBatchResultDescriptor result;
+    result.magic = EDII_IPCS_PACKET_MAGIC;
+    result.responseType = EDII_RESPONSE_LOAD_BATCH_RESULT;
+    result.status = ok ? EDII_IPCS_SUCCESS : EDII_IPCS_FAILURE;
+    result.entry = entry;
+    result.length = response.size();
+
+    QByteArray bytes{reinterpret_cast<const char *>(&result), sizeof(result)};
+    bytes.append(response);
+
+    const bool last = it->done == it->requests.size();
+    writeBatchPart(requestId, bytes, last);
+
+    if (last) {
+      m_batches.remove(requestId);
+      /* The batch itself has been in flight too */
+      m_inFlight--;
+      dispatch();
+    } else {
+      startBatchEntries(requestId);
+    }
+  }
+
+  deleteIfDone();
+}
+
+void LocalSocketConnection::finishNotification(const quint32 subscriptionId, const ChangeNotifier::Change &change, const bool ok,
+                                               const QByteArray &response, const quint64 cursor)
+{
+  m_notifying--;
+
+  /* The subscription may have ended while the datapoints were being read */
+  auto it = m_subscriptions.find(subscriptionId);
+  if (!m_closed && it != m_subscriptions.end()) {
+    it->running = false;
+    if (ok)
+      it->cursor = cursor;
+
+    /* Failed loads are reported in the response as usual */
+    writeNotification(subscriptionId, change, response);
+
+    if (it->pending)
+      startNotificationJob(subscriptionId);
+  }
+
+  deleteIfDone();
+}
+
+void LocalSocketConnection::flushOutgoing()
+{
+  while (!m_closed && !m_outgoing.empty()) {
+    Outgoing &o = m_outgoing.front();
+
+    if (o.fd < 0) {
+      m_socket->write(o.bytes);
+      ServiceStats::instance().addBytesServed(o.bytes.size());
+      m_outgoing.pop_front();
+      continue;
+    }
+
+    /* The descriptor must follow everything the socket still buffers, bytesWritten() brings us back */
+    if (m_socket->bytesToWrite() > 0)
+      return;
+
+    const qint64 sent = sendWithDescriptor(m_socket->socketDescriptor(), o.bytes, o.fd);
+    if (sent < 0) {
+      abort();
+      return;
+    }
+    if (sent == 0) {
+      if (!m_retryScheduled) {
+        m_retryScheduled = true;
+        QTimer::singleShot(DESCRIPTOR_RETRY_MS, this, [this]() {
+          m_retryScheduled = false;
+          flushOutgoing();
+        });
+      }
+      return;
+    }
+
+#ifdef Q_OS_LINUX
+    ::close(o.fd);
+#endif // Q_OS_LINUX
+    ServiceStats::instance().addBytesServed(sent);
+    releaseWindow(sent);
+
+    /* Only the first byte carries the descriptor, the rest is written as usual */
+    o.bytes.remove(0, sent);
+    o.fd = -1;
+    if (o.bytes.isEmpty())
+      m_outgoing.pop_front();
+  }
+
+  if (m_closeWhenWritten && !m_closed && m_outgoing.empty())
+    m_socket->disconnectFromServer();
+}
+
+void LocalSocketConnection::onBytesWritten(const qint64 bytes)
+{
+  releaseWindow(bytes);
+
+  if (!m_outgoing.empty())
+    flushOutgoing();
+
+  /* Batches that stopped on a full window may go on */
+  const auto batchIds = m_batches.keys();
+  for (const quint32 requestId : batchIds)
+    startBatchEntries(requestId);
+}
+
+void LocalSocketConnection::notify(const quint32 subscriptionId, const ChangeNotifier::Change &change)
+{
+  auto it = m_subscriptions.find(subscriptionId);
+  if (m_closed || it == m_subscriptions.end())
+    return;
+
+  if (!it->withData || change.removed) {
+    writeNotification(subscriptionId, change, QByteArray{});
+    return;
+  }
+
+  it->change = change;
+  if (it->running)
+    it->pending = true;
+  else
+    startNotificationJob(subscriptionId);
+}
+
+void LocalSocketConnection::onDisconnected()
+{
+  m_closed = true;
+  closeWindow();
+  dropBatches();
+  dropSubscriptions();
+  deleteIfDone();
+}
+
+void LocalSocketConnection::queue(const QByteArray &bytes, const int fd)
+{
+  m_outgoing.push_back(Outgoing{bytes, fd});
+  flushOutgoing();
+}
+
+/* The request was refused before any worker saw it, the client may send it again later */
+void LocalSocketConnection::refuse(const quint32 requestId)
+{
+  EDII_IPCSockBusyResponse resp;
+
+  resp.magic = EDII_IPCS_PACKET_MAGIC;
+  resp.responseType = EDII_RESPONSE_BUSY;
+  resp.status = EDII_IPCS_BUSY;
+  resp.retryAfter = h_pool.retryAfter();
+
+  writeResponse(requestId, EDII_IPCS_BUSY, QByteArray{reinterpret_cast<const char *>(&resp), sizeof(resp)});
+}
+
+void LocalSocketConnection::respondSubscription(const quint32 requestId, const uint8_t status, const quint32 subscriptionId, const QString &error)
+{
+  const QByteArray errorRaw = error.toUtf8();
+  EDII_IPCSockSubscriptionResponseDescriptor resp;
+
+  resp.magic = EDII_IPCS_PACKET_MAGIC;
+  resp.responseType = EDII_RESPONSE_SUBSCRIPTION;
+  resp.status = status;
+  resp.subscriptionId = subscriptionId;
+  resp.errorLength = errorRaw.size();
+
+  QByteArray response{reinterpret_cast<const char *>(&resp), sizeof(resp)};
+  response.append(errorRaw);
+
+  writeResponse(requestId, status, response);
+}
+
+void LocalSocketConnection::releaseWindow(const qint64 bytes)
+{
+  QMutexLocker locker{&m_windowLock};
+
+  m_unsent -= bytes;
+  m_windowFreed.wakeAll();
+}
+
+void LocalSocketConnection::reserveWindow(const qint64 bytes)
+{
+  QMutexLocker locker{&m_windowLock};
+
+  m_unsent += bytes;
+}
+
+/*
+ * Called by requests on worker threads, blocks while the window is full.
+ * Parts larger than the window are passed on in pieces that fit into it.
+ */
+bool LocalSocketConnection::sendPart(const quint32 requestId, const QByteArray &part, const int fd)
+{
+  const qint64 pieceSize = std::min<qint64>(std::max<qint64>(m_sendWindow, 1), STREAM_PART_SIZE);
+  qint64 offset = 0;
+  int pieceFd = fd;
+
+  do {
+    const QByteArray piece = part.mid(offset, pieceSize);
+
+    if (!waitForWindow(piece.size()))
+      return false;
+    if (!sendPiece(requestId, piece, pieceFd))
+      return false;
+
+    /* The descriptor goes with the first piece only */
+    pieceFd = -1;
+    offset += piece.size();
+  } while (offset < part.size());
+
+  return true;
+}
+
+bool LocalSocketConnection::sendPiece(const quint32 requestId, const QByteArray &piece, const int fd)
+{
+  /* The caller keeps its own descriptor */
+  int ownFd = -1;
+#ifdef Q_OS_LINUX
+  if (fd >= 0) {
+    ownFd = ::dup(fd);
+    if (ownFd < 0)
+      return false;
+  }
+#else
+  Q_UNUSED(fd);
+#endif // Q_OS_LINUX
+
+  QMetaObject::invokeMethod(this, [this, requestId, piece, ownFd]() {
+    if (m_closed) {
+#ifdef Q_OS_LINUX
+      if (ownFd >= 0)
+        ::close(ownFd);
+#endif // Q_OS_LINUX
+      return;
+    }
+
+    if (m_persistent)
+      writeEnvelope(EDII_ENVELOPE_RESPONSE_PART, EDII_IPCS_SUCCESS, requestId, piece);
+    else
+      queue(piece, ownFd);
+  }, Qt::QueuedConnection);
+
+  return true;
+}
+
+void LocalSocketConnection::start()
+{
+  m_socket = new QLocalSocket{this};
+
+  if (!m_socket->setSocketDescriptor(m_sockDesc)) {
+    qWarning() << "Cannot open connection:" << m_socket->errorString();
+    m_closed = true;
+    deleteIfDone();
+    return;
+  }
+
+  m_clientId = clientOf(m_sockDesc);
+
+  connect(m_socket, &QLocalSocket::bytesWritten, this, &LocalSocketConnection::onBytesWritten);
+  connect(m_socket, &QLocalSocket::readyRead, this, &LocalSocketConnection::dispatch);
+  connect(m_socket, &QLocalSocket::disconnected, this, &LocalSocketConnection::onDisconnected);
+
+  /* The request may have arrived before the socket was set up */
+  dispatch();
+}
+
+void LocalSocketConnection::startBatch(const quint32 requestId, const QByteArray &request)
+{
+  static const qint64 HEADER_SIZE = sizeof(EDII_IPCSockRequestHeader);
+  static const qint64 DESC_SIZE = sizeof(EDII_IPCSockLoadBatchRequestDescriptor);
+  static const qint64 ENTRY_SIZE = sizeof(EDII_IPCSockLoadBatchEntryDescriptor);
+
+  const auto reject = [this, requestId](const QString &error) {
+    const QByteArray errorRaw = error.toUtf8();
+    EDII_IPCSockResponseHeader header;
+
+    header.magic = EDII_IPCS_PACKET_MAGIC;
+    header.responseType = EDII_RESPONSE_LOAD_BATCH_HEADER;
+    header.status = EDII_IPCS_FAILURE;
+    header.items = 0;
+    header.errorLength = errorRaw.size();
+
+    QByteArray response{reinterpret_cast<const char *>(&header), sizeof(header)};
+    response.append(errorRaw);
+
+    writeResponse(requestId, EDII_IPCS_FAILURE, response);
+  };
+
+  const auto desc = reinterpret_cast<const EDII_IPCSockLoadBatchRequestDescriptor *>(request.constData() + HEADER_SIZE);
+  if (request.size() < HEADER_SIZE + DESC_SIZE || desc->magic != EDII_IPCS_PACKET_MAGIC ||
+      desc->requestType != EDII_REQUEST_LOAD_BATCH_DESCRIPTOR || request.size() != HEADER_SIZE + DESC_SIZE + desc->entriesLength) {
+    reject("Invalid batch request");
+    return;
+  }
+  if (m_batches.contains(requestId)) {
+    reject("Request ID is used by another batch");
+    return;
+  }
+
+  /* Memory files cannot be passed with the parts of a batch */
+  const uint32_t flags = desc->flags & ~static_cast<uint32_t>(EDII_IPCS_LOAD_FLAG_SHARED_MEMORY);
+
+  /* The number of entries comes from the client, it must not make us allocate more than the request can describe */
+  if (desc->entries > desc->entriesLength / ENTRY_SIZE) {
+    reject("Invalid batch request");
+    return;
+  }
+
+  Batch batch{{}, 0, 0, 0, false, {}};
+  batch.requests.reserve(desc->entries);
+
+  qint64 pos = HEADER_SIZE + DESC_SIZE;
+  for (uint32_t idx = 0; idx < desc->entries; idx++) {
+    if (request.size() - pos < ENTRY_SIZE) {
+      reject("Invalid batch entry");
+      return;
+    }
+
+    const auto entry = reinterpret_cast<const EDII_IPCSockLoadBatchEntryDescriptor *>(request.constData() + pos);
+    pos += ENTRY_SIZE;
+
+    if (entry->mode != EDII_IPCS_LOAD_FILE) {
+      reject("Batch entries must load files");
+      return;
+    }
+    if (entry->tagLength < 1 || entry->filePathLength < 1 ||
+        request.size() - pos < static_cast<qint64>(entry->tagLength) + entry->filePathLength) {
+      reject("Invalid batch entry");
+      return;
+    }
+
+    const QByteArray tagRaw = request.mid(pos, entry->tagLength);
+    const QByteArray pathRaw = request.mid(pos + entry->tagLength, entry->filePathLength);
+    pos += static_cast<qint64>(entry->tagLength) + entry->filePathLength;
+
+    batch.requests.append(loadRequest(tagRaw, pathRaw, entry->loadOption, flags));
+  }
+  if (pos != request.size()) {
+    reject("Invalid batch request");
+    return;
+  }
+
+  EDII_IPCSockResponseHeader header;
+  header.magic = EDII_IPCS_PACKET_MAGIC;
+  header.responseType = EDII_RESPONSE_LOAD_BATCH_HEADER;
+  header.status = EDII_IPCS_SUCCESS;
+  header.items = batch.requests.size();
+  header.errorLength = 0;
+
+  const QByteArray headerRaw{reinterpret_cast<const char *>(&header), sizeof(header)};
+  if (batch.requests.isEmpty()) {
+    writeResponse(requestId, EDII_IPCS_SUCCESS, headerRaw);
+    return;
+  }
+
+  m_batches.insert(requestId, batch);
+  m_inFlight++;
+  writeBatchPart(requestId, headerRaw, false);
+  startBatchEntries(requestId);
+}
+
+/*
+ * Entries beyond the number of decoding slots would only wait in the scheduler while holding a worker.
+ * No entries are started while the send window is full, writing out their results resumes the batch.
+ */
+void LocalSocketConnection::startBatchEntries(const quint32 requestId)
+{
+  const int maxRunning = std::max(1, ServiceConfig::instance().scheduler.decodeSlots);
+
+  auto it = m_batches.find(requestId);
+  if (m_closed || it == m_batches.end() || it->retryScheduled)
+    return;
+
+  while (it->next < it->requests.size() && it->running < maxRunning && windowOpen()) {
+    const quint32 entry = it->next;
+    InternalJob *job = new InternalJob{*this, it->requests.at(entry), [this, requestId, entry](const bool ok, const QByteArray &response, const quint64) {
+      finishBatchEntry(requestId, entry, ok, response);
+    }};
+
+    if (!h_pool.tryStart(m_clientId, job)) {
+      it->retryScheduled = true;
+      QTimer::singleShot(h_pool.retryAfter(), this, [this, requestId]() {
+        const auto bIt = m_batches.find(requestId);
+        if (bIt == m_batches.end())
+          return;
+        bIt->retryScheduled = false;
+        startBatchEntries(requestId);
+      });
+      return;
+    }
+
+    /* The job holds its own copy of the request */
+    it->requests[entry] = QByteArray{};
+    it->next++;
+    it->running++;
+    m_inFlight++;
+  }
+}
+
+void LocalSocketConnection::startJob(const quint32 requestId, const QByteArray &request)
+{
+  /* Descriptors can be passed only with responses that are not wrapped in envelopes */
+  RequestJob *job = new RequestJob{*this, requestId, request, !m_persistent || m_streaming, !m_persistent};
+
+  if (!h_pool.tryStart(m_clientId, job)) {
+    refuse(requestId);
+    return;
+  }
+  m_inFlight++;
+}
+
+/* Reads the datapoints appended by the most recent change of the file */
+void LocalSocketConnection::startNotificationJob(const quint32 subscriptionId)
+{
+  auto it = m_subscriptions.find(subscriptionId);
+  if (m_closed || it == m_subscriptions.end())
+    return;
+
+  it->pending = false;
+
+  const ChangeNotifier::Change change = it->change;
+  InternalJob *job = new InternalJob{*this, tailRequest(it->tag, it->path, it->loadOption, it->loadFlags, it->cursor),
+                                     [this, subscriptionId, change](const bool ok, const QByteArray &response, const quint64 cursor) {
+    finishNotification(subscriptionId, change, ok, response, cursor);
+  }};
+  if (!h_pool.tryStart(m_clientId, job)) {
+    /* The change is not lost, it is read once the pool has room */
+    it->pending = true;
+    QTimer::singleShot(h_pool.retryAfter(), this, [this, subscriptionId]() {
+      const auto sIt = m_subscriptions.constFind(subscriptionId);
+      if (sIt != m_subscriptions.cend() && sIt->pending && !sIt->running)
+        startNotificationJob(subscriptionId);
+    });
+    return;
+  }
+
+  it->running = true;
+  m_notifying++;
+}
+
+void LocalSocketConnection::subscribe(const quint32 requestId, const QByteArray &request)
+{
+  static const qint64 HEADER_SIZE = sizeof(EDII_IPCSockRequestHeader);
+  static const qint64 DESC_SIZE = sizeof(EDII_IPCSockSubscribeRequestDescriptor);
+
+  if (m_notifier == nullptr) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Subscriptions are disabled");
+    return;
+  }
+
+  const auto desc = reinterpret_cast<const EDII_IPCSockSubscribeRequestDescriptor *>(request.constData() + HEADER_SIZE);
+  if (request.size() < HEADER_SIZE + DESC_SIZE || desc->magic != EDII_IPCS_PACKET_MAGIC ||
+      desc->requestType != EDII_REQUEST_SUBSCRIBE_DESCRIPTOR ||
+      request.size() != HEADER_SIZE + DESC_SIZE + desc->tagLength + desc->filePathLength) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Invalid subscription request");
+    return;
+  }
+
+  const bool withData = desc->flags & EDII_IPCS_SUBSCRIBE_FLAG_DATA;
+  if (desc->filePathLength < 1) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Invalid file path length");
+    return;
+  }
+  if (withData && desc->tagLength < 1) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Invalid length of formatTag");
+    return;
+  }
+
+  const int maxPerClient = ServiceConfig::instance().subscriptions.maxPerClient;
+  if (maxPerClient > 0 && m_subscriptions.size() >= maxPerClient) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Too many subscriptions");
+    return;
+  }
+
+  const char *strings = request.constData() + HEADER_SIZE + DESC_SIZE;
+  Subscription sub{
+    -1,
+    QString::fromUtf8(strings, desc->tagLength),
+    QString::fromUtf8(strings + desc->tagLength, desc->filePathLength),
+    desc->loadOption,
+    desc->loadFlags,
+    desc->cursor,
+    withData,
+    false,
+    false,
+    {}
+  };
+
+  const quint32 subscriptionId = m_nextSubscriptionId++;
+  sub.watchId = m_notifier->watch(sub.path, [this, subscriptionId](const ChangeNotifier::Change &change) {
+    notify(subscriptionId, change);
+  });
+  if (sub.watchId < 0) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Directory of the file does not exist");
+    return;
+  }
+
+  m_subscriptions.insert(subscriptionId, sub);
+  respondSubscription(requestId, EDII_IPCS_SUCCESS, subscriptionId, QString{});
+}
+
+void LocalSocketConnection::unsubscribe(const quint32 requestId, const QByteArray &request)
+{
+  static const qint64 HEADER_SIZE = sizeof(EDII_IPCSockRequestHeader);
+  static const qint64 DESC_SIZE = sizeof(EDII_IPCSockUnsubscribeRequestDescriptor);
+
+  const auto desc = reinterpret_cast<const EDII_IPCSockUnsubscribeRequestDescriptor *>(request.constData() + HEADER_SIZE);
+  if (request.size() != HEADER_SIZE + DESC_SIZE || desc->magic != EDII_IPCS_PACKET_MAGIC ||
+      desc->requestType != EDII_REQUEST_UNSUBSCRIBE_DESCRIPTOR) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, 0, "Invalid subscription request");
+    return;
+  }
+
+  const auto it = m_subscriptions.find(desc->subscriptionId);
+  if (it == m_subscriptions.end()) {
+    respondSubscription(requestId, EDII_IPCS_FAILURE, desc->subscriptionId, "Unknown subscription");
+    return;
+  }
+
+  m_notifier->unwatch(it->watchId);
+  m_subscriptions.erase(it);
+  respondSubscription(requestId, EDII_IPCS_SUCCESS, desc->subscriptionId, QString{});
+}
+
+/* Reserves room for bytes about to be written, false if the connection is closing */
+bool LocalSocketConnection::waitForWindow(const qint64 bytes)
+{
+  QMutexLocker locker{&m_windowLock};
+  QDeadlineTimer deadline{HANDLING_TIMEOUT};
+
+  /* Something is always let through once everything before it was read */
+  while (!m_windowClosed && m_unsent > 0 && m_unsent + bytes > m_sendWindow) {
+    if (!m_windowFreed.wait(&m_windowLock, deadline)) {
+      /* The client stopped reading, give up on the whole connection */
+      m_windowClosed = true;
+      m_windowFreed.wakeAll();
+      QMetaObject::invokeMethod(this, &LocalSocketConnection::abort, Qt::QueuedConnection);
+      return false;
+    }
+  }
+  if (m_windowClosed)
+    return false;
+  m_unsent += bytes;
+
+  return true;
+}
+
+bool LocalSocketConnection::windowOpen()
+{
+  QMutexLocker locker{&m_windowLock};
+
+  return m_unsent < m_sendWindow;
+}
+
+/* Results of a batch go out as soon as they are ready unless the client reads whole responses from envelopes */
+void LocalSocketConnection::writeBatchPart(const quint32 requestId, const QByteArray &bytes, const bool last)
+{
+  if (!m_persistent) {
+    reserveWindow(bytes.size());
+    queue(bytes, -1);
+    if (last) {
+      m_closeWhenWritten = true;
+      flushOutgoing();
+    }
+    return;
+  }
+
+  if (m_streaming) {
+    reserveWindow(bytes.size());
+    writeEnvelope(last ? EDII_ENVELOPE_RESPONSE : EDII_ENVELOPE_RESPONSE_PART, EDII_IPCS_SUCCESS, requestId, bytes);
+    return;
+  }
+
+  Batch &batch = m_batches[requestId];
+  batch.collected.append(bytes);
+  if (last) {
+    reserveWindow(batch.collected.size());
+    writeEnvelope(EDII_ENVELOPE_RESPONSE, EDII_IPCS_SUCCESS, requestId, batch.collected);
+  }
+}
+
+/*
+ * The length of an envelope has 32 bits. Longer responses are split into parts on connections that stream
+ * and replaced by an empty response with a failure status elsewhere.
+ */
+void LocalSocketConnection::writeEnvelope(const uint8_t envelopeType, const uint8_t status, const quint32 requestId, const QByteArray &payload)
+{
+  static const qint64 MAX_ENVELOPE_LENGTH = UINT32_MAX;
+
+  if (payload.size() > MAX_ENVELOPE_LENGTH) {
+    const bool response = envelopeType == EDII_ENVELOPE_RESPONSE || envelopeType == EDII_ENVELOPE_RESPONSE_PART;
+
+    if (response && m_streaming) {
+      qint64 offset = 0;
+      for (; payload.size() - offset > MAX_ENVELOPE_LENGTH; offset += MAX_ENVELOPE_LENGTH)
+        writeEnvelope(EDII_ENVELOPE_RESPONSE_PART, status, requestId, payload.mid(offset, MAX_ENVELOPE_LENGTH));
+      writeEnvelope(envelopeType, status, requestId, payload.mid(offset));
+      return;
+    }
+
+    qWarning() << "Response of" << payload.size() << "bytes does not fit into an envelope, the client must request streaming";
+
+    /* The payload was counted in the window by the caller but is never written */
+    releaseWindow(payload.size());
+    if (response)
+      writeEnvelope(EDII_ENVELOPE_RESPONSE, EDII_IPCS_FAILURE, requestId, QByteArray{});
+    return;
+  }
+
+  EDII_IPCSockEnvelope envelope;
+
+  envelope.magic = EDII_IPCS_PACKET_MAGIC;
+  envelope.envelopeType = envelopeType;
+  envelope.status = status;
+  envelope.requestId = requestId;
+  envelope.length = payload.size();
+
+  QByteArray bytes{reinterpret_cast<const char *>(&envelope), sizeof(envelope)};
+  bytes.append(payload);
+
+  reserveWindow(sizeof(envelope));
+  queue(bytes, -1);
+}
+
+void LocalSocketConnection::writeNotification(const quint32 subscriptionId, const ChangeNotifier::Change &change, const QByteArray &data)
+{
+  EDII_IPCSockChangeNotification notification;
+
+  notification.magic = EDII_IPCS_PACKET_MAGIC;
+  notification.responseType = EDII_RESPONSE_CHANGE_NOTIFICATION;
+  notification.status = EDII_IPCS_SUCCESS;
+  notification.flags = (change.removed ? EDII_IPCS_CHANGE_FLAG_REMOVED : 0) | (data.isEmpty() ? 0 : EDII_IPCS_CHANGE_FLAG_DATA);
+  notification.size = change.size;
+  notification.modified = change.modified;
+
+  QByteArray payload{reinterpret_cast<const char *>(&notification), sizeof(notification)};
+  payload.append(data);
+
+  reserveWindow(payload.size());
+  writeEnvelope(EDII_ENVELOPE_NOTIFICATION, EDII_IPCS_SUCCESS, subscriptionId, payload);
+}
+
+/* Writes a whole response, a connection that is not persistent is closed afterwards */
+void LocalSocketConnection::writeResponse(const quint32 requestId, const uint8_t status, const QByteArray &response)
+{
+  reserveWindow(response.size());
+  if (m_persistent) {
+    writeEnvelope(EDII_ENVELOPE_RESPONSE, status, requestId, response);
+  } else {
+    queue(response, -1);
+    m_closeWhenWritten = true;
+    flushOutgoing();
+  }
+}
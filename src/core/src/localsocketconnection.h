@@ -0,0 +1,188 @@
+#ifndef LOCALSOCKETCONNECTION_H
+#define LOCALSOCKETCONNECTION_H
+
+#include "changenotifier.h"
+
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QWaitCondition>
+#include <deque>
+#include <functional>
+
+class DataLoader;
+class QLocalSocket;
+class RequestScheduler;
+class WorkerPool;
+
+/*
+ * Presents a complete request to the connection handler as if it was read
+ * from a socket and takes the response. The response is either collected
+ * whole or passed on in parts while it is being serialized.
+ */
+class RequestDevice : public QIODevice
+{
+public:
+  /* Takes a part of the response and a descriptor to pass with it or -1, returns false if the part cannot be sent */
+  typedef std::function<bool (const QByteArray &, const int)> PartSink;
+
+  explicit RequestDevice(const QByteArray &request, PartSink partSink = nullptr, const bool descriptorPassing = false);
+  virtual qint64 bytesAvailable() const override;
+  bool canPassDescriptors() const;
+  virtual bool isSequential() const override;
+  const QByteArray & response() const;
+  bool writeWithDescriptor(const QByteArray &bytes, const int fd);
+
+protected:
+  virtual qint64 readData(char *data, qint64 maxSize) override;
+  virtual qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+  const QByteArray m_request;
+  const PartSink m_partSink;
+  const bool m_descriptorPassing;
+  qint64 m_readPos;
+  QByteArray m_response;                /* Part of the response that has not been passed on yet */
+};
+
+/*
+ * Serves one local socket connection from the I/O thread of the server.
+ * Incoming data is collected without blocking until a whole request has
+ * arrived, only then is the request handed over to the worker pool.
+ * Responses are written out as the worker produces them. A worker waits
+ * only while the client leaves more than the send window of data unread,
+ * an idle connection costs no thread at all.
+ *
+ * Requests that the worker pool refuses are answered with
+ * EDII_RESPONSE_BUSY right away.
+ *
+ * A connection carries a single request unless the client negotiates
+ * EDII_IPCS_CAP_PERSISTENT. Persistent connections read requests wrapped
+ * in envelopes and may have several of them in flight. With
+ * EDII_IPCS_CAP_STREAMING, responses of a persistent connection are sent
+ * in parts too.
+ *
+ * Entries of a batch load are handed over to the worker pool as separate
+ * loads, no more of them at a time than there are decoding slots, and
+ * their results are written out in the order in which they finish.
+ *
+ * Persistent connections may also subscribe to changes of files. The
+ * subscriptions are kept by the connection itself and end with it. Changes
+ * are pushed as notifications, appended datapoints are read by the worker
+ * pool, one load per subscription at a time. Changes that come while the
+ * load runs are picked up by the next one.
+ */
+class LocalSocketConnection : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit LocalSocketConnection(const quintptr sockDesc, const DataLoader &loader, RequestScheduler &scheduler, WorkerPool &pool,
+                                 ChangeNotifier *notifier);
+  virtual ~LocalSocketConnection() override;
+
+public slots:
+  void abort();
+  void start();
+
+private:
+  class Outgoing {
+  public:
+    QByteArray bytes;
+    int fd;                             /* Passed with the first byte, -1 if none */
+  };
+
+  class Batch {
+  public:
+    QVector<QByteArray> requests;       /* Load request of each entry */
+    int next;                           /* Entry to be started next */
+    int running;
+    int done;
+    bool retryScheduled;
+    QByteArray collected;               /* Response of a persistent connection that does not stream */
+  };
+
+  class Subscription {
+  public:
+    int watchId;
+    QString tag;
+    QString path;
+    int32_t loadOption;
+    uint32_t loadFlags;
+    quint64 cursor;                     /* Appended datapoints are read from here */
+    bool withData;
+    bool running;                       /* Appended datapoints are being read */
+    bool pending;                       /* Another change came while they were being read */
+    ChangeNotifier::Change change;      /* The most recent change */
+  };
+
+  class InternalJob;
+  class RequestJob;
+
+  void closeWindow();
+  void deleteIfDone();
+  void dispatch();
+  void dispatchDirect();
+  void dispatchEnvelopes();
+  void dropBatches();
+  void dropSubscriptions();
+  void finish(const quint32 requestId, const bool ok, const QByteArray &response, const uint32_t capabilities);
+  void finishBatchEntry(const quint32 requestId, const quint32 entry, const bool ok, const QByteArray &response);
+  void finishNotification(const quint32 subscriptionId, const ChangeNotifier::Change &change, const bool ok,
+                          const QByteArray &response, const quint64 cursor);
+  void flushOutgoing();
+  void notify(const quint32 subscriptionId, const ChangeNotifier::Change &change);
+  void queue(const QByteArray &bytes, const int fd);
+  void refuse(const quint32 requestId);
+  void releaseWindow(const qint64 bytes);
+  void reserveWindow(const qint64 bytes);
+  void respondSubscription(const quint32 requestId, const uint8_t status, const quint32 subscriptionId, const QString &error);
+  bool sendPart(const quint32 requestId, const QByteArray &part, const int fd);
+  bool sendPiece(const quint32 requestId, const QByteArray &piece, const int fd);
+  void startBatch(const quint32 requestId, const QByteArray &request);
+  void startBatchEntries(const quint32 requestId);
+  void startJob(const quint32 requestId, const QByteArray &request);
+  void startNotificationJob(const quint32 subscriptionId);
+  void subscribe(const quint32 requestId, const QByteArray &request);
+  void unsubscribe(const quint32 requestId, const QByteArray &request);
+  bool waitForWindow(const qint64 bytes);
+  bool windowOpen();
+  void writeEnvelope(const uint8_t envelopeType, const uint8_t status, const quint32 requestId, const QByteArray &payload);
+  void writeBatchPart(const quint32 requestId, const QByteArray &bytes, const bool last);
+  void writeNotification(const quint32 subscriptionId, const ChangeNotifier::Change &change, const QByteArray &data);
+  void writeResponse(const quint32 requestId, const uint8_t status, const QByteArray &response);
+
+  const quintptr m_sockDesc;
+  const DataLoader &h_loader;
+  RequestScheduler &h_scheduler;
+  WorkerPool &h_pool;
+  ChangeNotifier *const m_notifier;     /* Null when subscriptions are disabled */
+  const qint64 m_sendWindow;
+
+  QLocalSocket *m_socket;
+  qint64 m_clientId;                    /* Requests of the same client share its limit in the worker pool */
+  bool m_persistent;
+  bool m_streaming;
+  int m_inFlight;
+  int m_notifying;                      /* Loads of appended datapoints in progress */
+  bool m_closed;                        /* Nothing more is read from or written to the socket */
+  bool m_closeWhenWritten;              /* The single request of a connection has been answered */
+  bool m_retryScheduled;
+  std::deque<Outgoing> m_outgoing;      /* Data that waits behind a descriptor that could not be passed yet */
+  QHash<quint32, Batch> m_batches;      /* Batch loads in progress by their request IDs */
+  QHash<quint32, Subscription> m_subscriptions;
+  quint32 m_nextSubscriptionId;
+
+  QMutex m_windowLock;
+  QWaitCondition m_windowFreed;
+  qint64 m_unsent;                      /* Bytes handed over to the socket that the client has not read yet */
+  bool m_windowClosed;
+
+private slots:
+  void onBytesWritten(const qint64 bytes);
+  void onDisconnected();
+};
+
+#endif // LOCALSOCKETCONNECTION_H
@@ -1,61 +1,40 @@
 #include "localsocketconnectionhandler.h"
+#include "compactvaluepacker.h"
 #include "dataloader.h"
-
+#include "datapointpacker.h"
+#include "localsocketconnection.h"
+#include "memoryaccount.h"
+#include "requestscheduler.h"
+#include "requesttracer.h"
+#include "serviceconfig.h"
+#include "servicestats.h"
+#include "sharedtracebuffer.h"
+
+#include <edii_ipc_codec.h>
 #include <edii_ipc_network.h>
-
-#define HANDLING_TIMEOUT 5000
-
-bool finalize(QLocalSocket *socket)
-{
-  do {
-    if (!socket->waitForBytesWritten(HANDLING_TIMEOUT))
-      return false;
-  } while (socket->bytesToWrite());
-  return true;
-}
-
-/*
-#ifdef Q_OS_WIN
-  #define FINALIZE(socket) \
-    do { \
-      socket->waitForBytesWritten(HANDLING_TIMEOUT) \
-    } (socket->bytesToWrite())
-    if (socket->bytesToWrite()) \
-      return socket->waitForBytesWritten(); \
-    return true;
-#else
-   #define FINALIZE(socket) \
-     return socket->waitForBytesWritten()
-#endif // Q_OS_WIN
-*/
+#include <QHash>
+#include <QJsonDocument>
+#include <climits>
 
 #define INIT_RESPONSE(packet, rtype, s) \
   packet.magic = EDII_IPCS_PACKET_MAGIC; \
   packet.responseType = rtype; \
   packet.status = s
 
-#define WAIT_FOR_DATA(socket) \
-  if (!socket->bytesAvailable()) { \
-    if (!socket->waitForReadyRead(1000)) { \
-      qWarning() << "Timed out while waiting for data block"; \
-      return false; \
-    } \
-  }
-
 #define WRITE_CHECKED(socket, payload) \
-  if (!writeSegmented(socket, payload.data(), payload.size())) { \
+  if (!writeAll(socket, payload.data(), payload.size())) { \
     qWarning() << "Failed to send payload:" << socket->errorString(); \
     return false; \
   }
 
 #define WRITE_CHECKED_RAW(socket, payload) \
-  if (!writeSegmented(socket, reinterpret_cast<const char*>(&payload), static_cast<qint64>(sizeof(payload)))) { \
+  if (!writeAll(socket, reinterpret_cast<const char*>(&payload), static_cast<qint64>(sizeof(payload)))) { \
     qWarning() << "Failed to send raw payload:" << socket->errorString(); \
     return false; \
   }
 
 #define WRITE_RAW(socket, payload) \
-  writeSegmented(socket, reinterpret_cast<const char*>(&payload), static_cast<qint64>(sizeof(payload)))
+  writeAll(socket, reinterpret_cast<const char*>(&payload), static_cast<qint64>(sizeof(payload)))
 
 template <typename P>
 bool checkSig(const P &packet)
@@ -69,34 +48,199 @@ bool checkSig(const P &packet, const R requestType)
   return checkSig(packet) && packet->requestType == requestType;
 }
 
+template <typename P>
+QByteArray rawBytes(const P &packet)
+{
+  return QByteArray{reinterpret_cast<const char *>(&packet), static_cast<qsizetype>(sizeof(packet))};
+}
+
+/* Responses are written to a RequestDevice, the connection takes care of the socket */
 static
-bool writeSegmented(QLocalSocket *socket, const char *payload, const qint64 bytesToWrite)
+bool writeAll(QIODevice *socket, const char *payload, const qint64 bytesToWrite)
 {
-#ifdef Q_OS_WIN
-  const qint64 MAX_SEGMENT_SIZE = 4095;
-  qint64 written = 0;
-
-  while (written < bytesToWrite) {
-    const qint64 writeMax = (bytesToWrite - written) > MAX_SEGMENT_SIZE ? MAX_SEGMENT_SIZE : (bytesToWrite - written);
-    const qint64 w = socket->write(payload + written, writeMax);
-    if (w < 1)
-      return false;
-    written += w;
+  if (bytesToWrite == 0)
+    return true;
+  return socket->write(payload, bytesToWrite) == bytesToWrite;
+}
+
+/* xValues is null when the X values were sent with an axis descriptor */
+static
+bool writeCompact(QIODevice *socket, const double *xValues, const double *yValues, const int count)
+{
+  const CompactValuePacker::Encoding enc = CompactValuePacker::choose(xValues, yValues, count);
+
+  EDII_IPCSockCompactValuesDescriptor desc;
+  INIT_RESPONSE(desc, EDII_RESPONSE_COMPACT_VALUES, EDII_IPCS_SUCCESS);
+  desc.xEncoding = enc.xEncoding;
+  desc.yEncoding = enc.yEncoding;
+  desc.reserved = 0;
+  desc.t0 = enc.t0;
+  desc.dt = enc.dt;
+  desc.yScale = enc.yScale;
+
+  WRITE_CHECKED_RAW(socket, desc);
+  return CompactValuePacker::write(enc, xValues, yValues, count,
+                                   [socket](const char *block, const qint64 size) {
+                                     return writeAll(socket, block, size);
+                                   });
+}
 
-    if (!socket->waitForBytesWritten())
+/* The descriptor announces the length of the encoded values in 32 bits */
+static
+bool fitsCompressed(const std::vector<Data> &data, const bool sharedAxes)
+{
+  for (const auto &item : data) {
+    const size_t bound = edii_codec_bound(item.yValues.size());
+
+    /* With shared axes the X values are a block of their own */
+    if (bound > UINT32_MAX || (!sharedAxes && 2 * bound > UINT32_MAX))
       return false;
   }
 
   return true;
-#else
-  if (bytesToWrite == 0)
-    return true;
-  return socket->write(payload, bytesToWrite) == bytesToWrite;
-#endif // Q_OS_WIN
+}
+
+/* Either array may be null, the values of each array are encoded as their own stream */
+static
+bool writeCompressed(QIODevice *socket, const double *xValues, const double *yValues, const int count)
+{
+  const size_t bound = edii_codec_bound(count);
+  QByteArray payload{static_cast<qsizetype>((xValues != nullptr ? bound : 0) + (yValues != nullptr ? bound : 0)), Qt::Uninitialized};
+  uint8_t *out = reinterpret_cast<uint8_t *>(payload.data());
+  size_t length = 0;
+
+  if (xValues != nullptr)
+    length += edii_codec_encode_dod(xValues, count, out);
+  if (yValues != nullptr)
+    length += edii_codec_encode_xor(yValues, count, out + length);
+
+  EDII_IPCSockCompressedValuesDescriptor desc;
+  INIT_RESPONSE(desc, EDII_RESPONSE_COMPRESSED_VALUES, EDII_IPCS_SUCCESS);
+  desc.codec = EDII_IPCS_CODEC_DOD_XOR;
+  if (length > UINT32_MAX)
+    return false;
+  desc.compressedLength = length;
+
+  WRITE_CHECKED_RAW(socket, desc);
+  return writeAll(socket, payload.constData(), length);
+}
+
+/* Pads the payload of a v2 frame so that the next frame is aligned to 8 bytes */
+static
+bool padFrame(QIODevice *socket, const quint64 length)
+{
+  static const char ZEROS[8] = {};
+
+  return writeAll(socket, ZEROS, (8 - length % 8) % 8);
+}
+
+static
+bool writeFrameHeader(QIODevice *socket, const EDII_IPCSockFrameType frameType, const uint16_t status, const quint64 length)
+{
+  EDII_IPCSockFrame frame;
+
+  frame.magic = EDII_IPCS_FRAME_MAGIC;
+  frame.frameType = frameType;
+  frame.status = status;
+  frame.reserved = 0;
+  frame.length = length;
+
+  return WRITE_RAW(socket, frame);
+}
+
+static
+bool writeFrame(QIODevice *socket, const EDII_IPCSockFrameType frameType, const uint16_t status, const QByteArray &payload)
+{
+  return writeFrameHeader(socket, frameType, status, payload.size()) &&
+         writeAll(socket, payload.constData(), payload.size()) &&
+         padFrame(socket, payload.size());
+}
+
+/* Values fill whole multiples of 8 bytes and need no padding */
+static
+bool writeValuesFrame(QIODevice *socket, const EDII_IPCSockFrameType frameType, const QVector<double> &values)
+{
+  const quint64 length = sizeof(double) * static_cast<quint64>(values.size());
+
+  return writeFrameHeader(socket, frameType, EDII_IPCS_SUCCESS, length) &&
+         writeAll(socket, reinterpret_cast<const char *>(values.constData()), length);
 }
 
 static
-bool reportError(QLocalSocket *socket, const EDII_IPCSockResponseType rtype, const QString &message)
+bool writeLoadDataV2(QIODevice *socket, const std::vector<Data> &data, const bool sharedAxes,
+                     const bool tail, const quint64 cursor, const bool reset)
+{
+  EDII_IPCSockLoadDataHeaderV2 header;
+  header.descriptorLength = sizeof(header);
+  header.reserved = 0;
+  header.items = data.size();
+
+  if (!writeFrame(socket, EDII_FRAME_LOAD_DATA_HEADER, EDII_IPCS_SUCCESS, rawBytes(header)))
+    return false;
+
+  if (tail) {
+    EDII_IPCSockTailCursorV2 cursorDesc;
+    cursorDesc.descriptorLength = sizeof(cursorDesc);
+    cursorDesc.flags = reset ? EDII_IPCS_TAIL_FLAG_RESET : 0;
+    cursorDesc.cursor = cursor;
+
+    if (!writeFrame(socket, EDII_FRAME_TAIL_CURSOR, EDII_IPCS_SUCCESS, rawBytes(cursorDesc)))
+      return false;
+  }
+
+  QHash<const double *, quint64> sentAxes;
+  for (const auto &item : data) {
+    quint64 axisId = EDII_IPCS_NO_AXIS;
+
+    if (sharedAxes) {
+      const auto it = sentAxes.constFind(item.xValues.constData());
+      if (it != sentAxes.cend()) {
+        axisId = *it;
+      } else {
+        axisId = sentAxes.size();
+        sentAxes.insert(item.xValues.constData(), axisId);
+
+        if (!writeValuesFrame(socket, EDII_FRAME_AXIS, item.xValues))
+          return false;
+      }
+    }
+
+    const QByteArray nameBytes = item.name.toUtf8();
+    const QByteArray dataIdBytes = item.dataId.toUtf8();
+    const QByteArray pathBytes = item.path.toUtf8();
+    const QByteArray xDescBytes = item.xDescription.toUtf8();
+    const QByteArray yDescBytes = item.yDescription.toUtf8();
+    const QByteArray xUnitBytes = item.xUnit.toUtf8();
+    const QByteArray yUnitBytes = item.yUnit.toUtf8();
+
+    EDII_IPCSockTraceDescriptorV2 desc;
+    desc.descriptorLength = sizeof(desc);
+    desc.reserved = 0;
+    desc.datapoints = item.yValues.size();
+    desc.axisId = axisId;
+    desc.nameLength = nameBytes.size();
+    desc.dataIdLength = dataIdBytes.size();
+    desc.pathLength = pathBytes.size();
+    desc.xDescriptionLength = xDescBytes.size();
+    desc.yDescriptionLength = yDescBytes.size();
+    desc.xUnitLength = xUnitBytes.size();
+    desc.yUnitLength = yUnitBytes.size();
+
+    const QByteArray payload = rawBytes(desc) + nameBytes + dataIdBytes + pathBytes + xDescBytes + yDescBytes + xUnitBytes + yUnitBytes;
+    if (!writeFrame(socket, EDII_FRAME_TRACE, EDII_IPCS_SUCCESS, payload))
+      return false;
+
+    if (axisId == EDII_IPCS_NO_AXIS && !writeValuesFrame(socket, EDII_FRAME_X_VALUES, item.xValues))
+      return false;
+    if (!writeValuesFrame(socket, EDII_FRAME_Y_VALUES, item.yValues))
+      return false;
+  }
+
+  return writeFrame(socket, EDII_FRAME_END, EDII_IPCS_SUCCESS, QByteArray{});
+}
+
+static
+bool reportError(QIODevice *socket, const EDII_IPCSockResponseType rtype, const QString &message)
 {
   EDII_IPCSockResponseHeader resp;
   QByteArray messageRaw(message.toUtf8());
@@ -106,23 +250,42 @@ bool reportError(QLocalSocket *socket, const EDII_IPCSockResponseType rtype, con
 
   WRITE_CHECKED_RAW(socket, resp);
   WRITE_CHECKED(socket, messageRaw);
-  return finalize(socket);
+  return true;
+}
+
+/* Whatever has not been passed on yet is held by the device until the connection writes it out */
+static
+void chargeUnsent(const RequestDevice *device)
+{
+  if (device != nullptr)
+    MemoryAccount::charge(device->response().size());
+}
+
+/* Clients that asked for v2 framing get errors in frames too */
+static
+bool reportLoadError(QIODevice *socket, const uint32_t flags, const QString &message)
+{
+  if (!(flags & EDII_IPCS_LOAD_FLAG_FRAMING_V2))
+    return reportError(socket, EDII_RESPONSE_LOAD_DATA_HEADER, message);
+
+  return writeFrame(socket, EDII_FRAME_ERROR, EDII_IPCS_FAILURE, message.toUtf8()) &&
+         writeFrame(socket, EDII_FRAME_END, EDII_IPCS_FAILURE, QByteArray{});
 }
 
 static
-bool readBlock(QLocalSocket *socket, QByteArray &buffer, qint64 size)
+bool readBlock(QIODevice *socket, QByteArray &buffer, qint64 size)
 {
   buffer.resize(size);
   qint64 read = 0;
   while (read < size) {
-    if (socket->state() != QLocalSocket::ConnectedState)
-      return false;
-
-    qint64 r = socket->read(buffer.data() + read, size);
+    qint64 r = socket->read(buffer.data() + read, size - read);
     if (r < 0) {
       qWarning() << "Unable to read block:"<< socket->errorString();
       return false;
     }
+    /* The connection passes only whole requests, a short read means a malformed one */
+    if (r == 0)
+      return false;
     read += r;
   }
 
@@ -130,7 +293,7 @@ bool readBlock(QLocalSocket *socket, QByteArray &buffer, qint64 size)
 }
 
 static
-bool readHeader(QLocalSocket *socket, EDII_IPCSockRequestType &reqType)
+bool readHeader(QIODevice *socket, EDII_IPCSockRequestType &reqType)
 {
   static const qint64 HEADER_SIZE = sizeof(EDII_IPCSockRequestHeader);
   QByteArray headerRaw;
@@ -150,39 +313,72 @@ bool readHeader(QLocalSocket *socket, EDII_IPCSockRequestType &reqType)
   return true;
 }
 
-LocalSocketConnectionHandler::LocalSocketConnectionHandler(const quintptr sockDesc, const DataLoader &loader) :
+static
+RequestScheduler::PriorityClass priorityClass(const uint32_t flags)
+{
+  switch ((flags & EDII_IPCS_LOAD_PRIORITY_MASK) >> EDII_IPCS_LOAD_PRIORITY_SHIFT) {
+  case EDII_IPCS_PRIORITY_BATCH:
+    return RequestScheduler::PriorityClass::BATCH;
+  case EDII_IPCS_PRIORITY_BACKGROUND:
+    return RequestScheduler::PriorityClass::BACKGROUND;
+  default:
+    return RequestScheduler::PriorityClass::INTERACTIVE;
+  }
+}
+
+LocalSocketConnectionHandler::LocalSocketConnectionHandler(const DataLoader &loader, RequestScheduler &scheduler, const qint64 queuedAt) :
   h_loader{loader},
-  m_sockDesc{sockDesc}
+  h_scheduler{scheduler},
+  m_requestId{RequestTracer::instance().newRequestId()},
+  m_queuedAt{queuedAt},
+  m_tailCursor{0}
 {
 }
 
-void LocalSocketConnectionHandler::handleConnection(QLocalSocket *socket)
+bool LocalSocketConnectionHandler::handle(QIODevice *device, uint32_t &capabilities)
 {
-  if (!socket->bytesAvailable()) {
-    if (!socket->waitForReadyRead(HANDLING_TIMEOUT))
-      return;
-  }
+  RequestTracer &tracer = RequestTracer::instance();
+  RequestTracer::RequestScope scope{m_requestId};
+
+  /* Time the request spent waiting for a free worker */
+  tracer.record("queued", "request", nullptr, m_queuedAt, tracer.now());
+
+  RequestTracer::Span span{"request"};
+  return handleRequest(device, capabilities);
+}
+
+bool LocalSocketConnectionHandler::handleRequest(QIODevice *socket, uint32_t &capabilities)
+{
+  RequestTracer::Span headerSpan{"readHeader"};
+
+  capabilities = 0;
 
   EDII_IPCSockRequestType reqType;
   if (!readHeader(socket, reqType))
-    return;
+    return false;
+  headerSpan.stop();
 
   switch (reqType) {
   case EDII_REQUEST_SUPPORTED_FORMATS:
-    respondSupportedFormats(socket);
-    break;
+    return respondSupportedFormats(socket);
   case EDII_REQUEST_LOAD_DATA:
-    respondLoadData(socket);
-    break;
+    return respondLoadData(socket);
   case EDII_REQUEST_ABI_VERSION:
-    respondABIVersion(socket);
-    break;
+    return respondABIVersion(socket);
+  case EDII_REQUEST_ABI_VERSION_EXT:
+    return respondABIVersionExt(socket, capabilities);
+  case EDII_REQUEST_STATS:
+    return respondStats(socket);
+  case EDII_REQUEST_FLUSH_TRACE:
+    return respondFlushTrace(socket);
+  case EDII_REQUEST_CATALOG_QUERY:
+    return respondCatalogQuery(socket);
   default:
-    return;
+    return false;
   }
 }
 
-bool LocalSocketConnectionHandler::respondABIVersion(QLocalSocket *socket)
+bool LocalSocketConnectionHandler::respondABIVersion(QIODevice *socket)
 {
   EDII_IPCSockResponseABIVersion resp;
 
@@ -193,17 +389,115 @@ bool LocalSocketConnectionHandler::respondABIVersion(QLocalSocket *socket)
 
   WRITE_CHECKED_RAW(socket, resp);
 
-  return finalize(socket);
+  return true;
+}
+
+bool LocalSocketConnectionHandler::respondABIVersionExt(QIODevice *socket, uint32_t &capabilities)
+{
+  static const qint64 REQ_DESC_SIZE = sizeof(EDII_IPCSockABIVersionRequestDescriptor);
+  static const uint32_t SUPPORTED_CAPABILITIES = EDII_IPCS_CAP_PERSISTENT | EDII_IPCS_CAP_STREAMING | EDII_IPCS_CAP_COMPRESSION |
+                                                 EDII_IPCS_CAP_SUBSCRIPTIONS;
+
+  QByteArray reqDescRaw;
+  if (!readBlock(socket, reqDescRaw, REQ_DESC_SIZE)) {
+    qWarning() << "Cannot read ABI version descriptor";
+    return false;
+  }
+  const auto reqDesc = reinterpret_cast<const EDII_IPCSockABIVersionRequestDescriptor *>(reqDescRaw.constData());
+  if (!checkSig(reqDesc, EDII_REQUEST_ABI_VERSION_DESCRIPTOR)) {
+    qWarning() << "Invalid ABI version descriptor signature";
+    return false;
+  }
+
+  EDII_IPCSockResponseABIVersionExt resp;
+
+  INIT_RESPONSE(resp, EDII_RESPONSE_ABI_VERSION_EXT, EDII_IPCS_SUCCESS);
+  resp.major = EDII_ABI_VERSION_MAJOR;
+  resp.minor = EDII_ABI_VERSION_MINOR;
+  resp.capabilities = reqDesc->capabilities & SUPPORTED_CAPABILITIES;
+  if (!ServiceConfig::instance().subscriptions.enabled)
+    resp.capabilities &= ~static_cast<uint32_t>(EDII_IPCS_CAP_SUBSCRIPTIONS);
+  /* Streaming and subscriptions apply only to persistent connections */
+  if (!(resp.capabilities & EDII_IPCS_CAP_PERSISTENT))
+    resp.capabilities &= ~static_cast<uint32_t>(EDII_IPCS_CAP_STREAMING | EDII_IPCS_CAP_SUBSCRIPTIONS);
+
+  WRITE_CHECKED_RAW(socket, resp);
+
+  capabilities = resp.capabilities;
+
+  return true;
 }
 
-bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
+bool LocalSocketConnectionHandler::respondCatalogQuery(QIODevice *socket)
+{
+  static const qint64 REQ_DESC_SIZE = sizeof(EDII_IPCSockCatalogQueryRequestDescriptor);
+
+  QByteArray reqDescRaw;
+  if (!readBlock(socket, reqDescRaw, REQ_DESC_SIZE)) {
+    qWarning() << "Cannot read catalog query descriptor";
+    return false;
+  }
+  const auto reqDesc = reinterpret_cast<const EDII_IPCSockCatalogQueryRequestDescriptor *>(reqDescRaw.constData());
+  if (!checkSig(reqDesc, EDII_REQUEST_CATALOG_QUERY_DESCRIPTOR)) {
+    qWarning() << "Invalid catalog query descriptor signature";
+    return false;
+  }
+
+  QByteArray queryRaw;
+  if (reqDesc->queryLength > 0) {
+    if (!readBlock(socket, queryRaw, reqDesc->queryLength)) {
+      qWarning() << "Cannot read catalog query";
+      return false;
+    }
+  }
+
+  const int maxResults = reqDesc->maxResults > INT_MAX ? INT_MAX : static_cast<int>(reqDesc->maxResults);
+  const auto result = h_loader.queryCatalog(QString::fromUtf8(queryRaw), maxResults);
+  const bool ok = std::get<1>(result);
+  const QByteArray payload = ok ? QJsonDocument{std::get<0>(result)}.toJson(QJsonDocument::Compact) : std::get<2>(result).toUtf8();
+
+  EDII_IPCSockCatalogQueryResponseDescriptor resp;
+  INIT_RESPONSE(resp, EDII_RESPONSE_CATALOG_QUERY, ok ? EDII_IPCS_SUCCESS : EDII_IPCS_FAILURE);
+  resp.matches = ok ? std::get<0>(result).size() : 0;
+  resp.resultLength = payload.size();
+
+  WRITE_CHECKED_RAW(socket, resp);
+  WRITE_CHECKED(socket, payload);
+
+  return true;
+}
+
+bool LocalSocketConnectionHandler::respondFlushTrace(QIODevice *socket)
+{
+  EDII_IPCSockFlushTraceResponseDescriptor resp;
+  QString error;
+
+  const qint64 written = RequestTracer::instance().flush(error);
+  const QByteArray message = written < 0 ? error.toUtf8() : RequestTracer::instance().outputPath().toUtf8();
+
+  INIT_RESPONSE(resp, EDII_RESPONSE_FLUSH_TRACE, written < 0 ? EDII_IPCS_FAILURE : EDII_IPCS_SUCCESS);
+  resp.eventsWritten = written < 0 ? 0 : written;
+  resp.messageLength = message.size();
+
+  WRITE_CHECKED_RAW(socket, resp);
+  WRITE_CHECKED(socket, message);
+
+  return true;
+}
+
+bool LocalSocketConnectionHandler::respondLoadData(QIODevice *socket)
 {
   static const qint64 REQ_DESC_SIZE = sizeof(EDII_IPCSockLoadDataRequestDescriptor);
+  static const qint64 REQ_DESC_EXT_SIZE = sizeof(EDII_IPCSockLoadDataRequestDescriptorExt);
+  static const qint64 REQ_DESC_TAIL_SIZE = sizeof(EDII_IPCSockLoadDataRequestDescriptorTail);
   QString formatTag;
   QString path;
+  uint32_t flags = 0;
+  bool tail = false;
+  quint64 cursor = 0;
+  RequestTracer::Span requestSpan{"readRequest"};
 
   /* Read request descriptor */
-  WAIT_FOR_DATA(socket);
   EDII_IPCSockLoadDataRequestDescriptor *reqDesc;
   QByteArray reqDescRaw;
   if (!readBlock(socket, reqDescRaw, REQ_DESC_SIZE)) {
@@ -211,18 +505,35 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
     return false;
   }
   reqDesc = reinterpret_cast<EDII_IPCSockLoadDataRequestDescriptor *>(reqDescRaw.data());
-  if (!checkSig(reqDesc, EDII_REQUEST_LOAD_DATA_DESCRIPTOR)) {
+  if (checkSig(reqDesc, EDII_REQUEST_LOAD_DATA_DESCRIPTOR_EXT) || checkSig(reqDesc, EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL)) {
+    tail = reqDesc->requestType == EDII_REQUEST_LOAD_DATA_DESCRIPTOR_TAIL;
+
+    /* Extended descriptors carry additional fields after the common part */
+    QByteArray extRaw;
+    if (!readBlock(socket, extRaw, (tail ? REQ_DESC_TAIL_SIZE : REQ_DESC_EXT_SIZE) - REQ_DESC_SIZE)) {
+      qWarning() << "Cannot read extended load data descriptor";
+      return false;
+    }
+    reqDescRaw.append(extRaw);
+    reqDesc = reinterpret_cast<EDII_IPCSockLoadDataRequestDescriptor *>(reqDescRaw.data());
+    flags = reinterpret_cast<const EDII_IPCSockLoadDataRequestDescriptorExt *>(reqDescRaw.constData())->flags;
+    if (tail)
+      cursor = reinterpret_cast<const EDII_IPCSockLoadDataRequestDescriptorTail *>(reqDescRaw.constData())->cursor;
+  } else if (!checkSig(reqDesc, EDII_REQUEST_LOAD_DATA_DESCRIPTOR)) {
     qWarning() << "Invalid load data descriptor signature";
     return false;
   }
   if (reqDesc->tagLength < 1) {
     qWarning() << "Invalid length of formatTag";
-    reportError(socket, EDII_RESPONSE_LOAD_DATA_HEADER, "Invalid length of formatTag");
+    reportLoadError(socket, flags, "Invalid length of formatTag");
+    return false;
+  }
+  if (tail && reqDesc->mode != EDII_IPCS_LOAD_FILE) {
+    reportLoadError(socket, flags, "Incremental loads need a file path");
     return false;
   }
 
   /* Read tag */
-  WAIT_FOR_DATA(socket)
   QByteArray tagRaw;
   if (!readBlock(socket, tagRaw, reqDesc->tagLength)) {
     qWarning() << "Cannot read format tag";
@@ -230,12 +541,16 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
   }
   formatTag = QString::fromUtf8(tagRaw);
 
+  MemoryAccount::RequestReport memoryReport{formatTag, m_requestId};
+
+  /* Stats are keyed by the same UTF-8 tag the plugins report with */
+  plugin::StageTimer totalTimer{UIPlugin::instance(), tagRaw.constData(), plugin::LoadStage::TOTAL};
+
   switch (reqDesc->mode) {
   case EDII_IPCS_LOAD_FILE:
   case EDII_IPCS_LOAD_HINT:
   {
     if (reqDesc->filePathLength > 0) {
-      WAIT_FOR_DATA(socket);
       QByteArray pathRaw;
       if (!readBlock(socket, pathRaw, reqDesc->filePathLength)) {
         qWarning() << "Cannot read file path";
@@ -244,7 +559,7 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
 
       path = QString::fromUtf8(pathRaw);
     } else {
-      reportError(socket, EDII_RESPONSE_LOAD_DATA_HEADER, "Invalid file path length");
+      reportLoadError(socket, flags, "Invalid file path length");
       return false;
     }
   }
@@ -252,11 +567,15 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
   case EDII_IPCS_LOAD_INTERACTIVE:
     break;
   default:
-    reportError(socket, EDII_RESPONSE_LOAD_DATA_HEADER, "Invalid load mode");
+    reportLoadError(socket, flags, "Invalid load mode");
     return false;
   }
 
+  requestSpan.stop();
+
+  RequestTracer::Span loadSpan{"load"};
   DataLoader::LoadedPack result;
+  bool reset = false;
   switch (reqDesc->mode) {
   case EDII_IPCS_LOAD_INTERACTIVE:
     result = h_loader.loadData(formatTag, reqDesc->loadOption);
@@ -265,9 +584,36 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
     result = h_loader.loadDataHint(formatTag, path, reqDesc->loadOption);
     break;
   case EDII_IPCS_LOAD_FILE:
-    result = h_loader.loadDataPath(formatTag, path, reqDesc->loadOption);
+  {
+    /* Interactive and hint loads wait for the user and are not scheduled */
+    RequestTracer::Span waitSpan{"schedulerWait"};
+    RequestScheduler::Slot slot{h_scheduler, priorityClass(flags)};
+    waitSpan.stop();
+
+    if (tail) {
+      result = h_loader.loadDataPathTail(formatTag, path, reqDesc->loadOption, cursor, reset);
+      m_tailCursor = cursor;
+    } else
+      result = h_loader.loadDataPath(formatTag, path, reqDesc->loadOption);
+  }
     break;
   }
+  loadSpan.stop();
+
+  if (flags & EDII_IPCS_LOAD_FLAG_FRAMING_V2) {
+    if (!std::get<1>(result))
+      return reportLoadError(socket, flags, std::get<2>(result));
+
+    plugin::StageTimer serializationTimer{UIPlugin::instance(), tagRaw.constData(), plugin::LoadStage::SERIALIZATION};
+    if (!writeLoadDataV2(socket, std::get<0>(result), flags & EDII_IPCS_LOAD_FLAG_SHARED_AXES, tail, cursor, reset)) {
+      qWarning() << "Failed to send load data frames:" << socket->errorString();
+      return false;
+    }
+    serializationTimer.stop();
+
+    chargeUnsent(dynamic_cast<RequestDevice *>(socket));
+    return true;
+  }
 
   /* We have the data (or a failure), report it back */
   EDII_IPCSockResponseHeader respHeader;
@@ -280,16 +626,99 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
     WRITE_RAW(socket, respHeader);
 
     socket->write(error);
-    return finalize(socket);
+    return true;
   }
 
   const std::vector<Data> &data = std::get<0>(result);
+  plugin::StageTimer serializationTimer{UIPlugin::instance(), tagRaw.constData(), plugin::LoadStage::SERIALIZATION};
+  QHash<const double *, uint32_t> sentAxes;
+
+  /* Descriptors cannot be passed with responses wrapped in envelopes */
+  RequestDevice *device = dynamic_cast<RequestDevice *>(socket);
+  SharedTraceBuffer sharedBuffer{};
+  bool sharedMemory = false;
+  if ((flags & EDII_IPCS_LOAD_FLAG_SHARED_MEMORY) && device != nullptr && device->canPassDescriptors() && SharedTraceBuffer::isSupported()) {
+    QString error;
+
+    sharedMemory = sharedBuffer.build(data, error);
+    if (!sharedMemory)
+      qWarning() << "Sending values through the socket instead:" << error;
+  }
+  const bool sharedAxes = (flags & EDII_IPCS_LOAD_FLAG_SHARED_AXES) && !sharedMemory;
+  const bool compressed = (flags & EDII_IPCS_LOAD_FLAG_COMPRESSED) && !sharedMemory;
+  const bool compact = (flags & EDII_IPCS_LOAD_FLAG_COMPACT) && !sharedMemory && !compressed;
+
+  /* The client cannot tell raw values from compressed ones, so the load fails before anything is sent */
+  if (compressed && !fitsCompressed(data, sharedAxes)) {
+    static const QByteArray error{"Trace is too large to be sent compressed"};
+
+    INIT_RESPONSE(respHeader, EDII_RESPONSE_LOAD_DATA_HEADER, EDII_IPCS_FAILURE);
+    respHeader.errorLength = error.size();
+
+    WRITE_RAW(socket, respHeader);
+
+    socket->write(error);
+    return true;
+  }
+
   INIT_RESPONSE(respHeader, EDII_RESPONSE_LOAD_DATA_HEADER, EDII_IPCS_SUCCESS);
   respHeader.items = data.size();
   respHeader.errorLength = 0;
-  WRITE_CHECKED_RAW(socket, respHeader);
 
-  for (const auto &item : data) {
+  if (sharedMemory) {
+    EDII_IPCSockSharedMemoryDescriptor shmDesc;
+    INIT_RESPONSE(shmDesc, EDII_RESPONSE_SHARED_MEMORY, EDII_IPCS_SUCCESS);
+    shmDesc.size = sharedBuffer.size();
+
+    QByteArray head{reinterpret_cast<const char *>(&respHeader), sizeof(respHeader)};
+    head.append(reinterpret_cast<const char *>(&shmDesc), sizeof(shmDesc));
+    if (!device->writeWithDescriptor(head, sharedBuffer.fd())) {
+      qWarning() << "Cannot pass shared memory file";
+      return false;
+    }
+  } else {
+    WRITE_CHECKED_RAW(socket, respHeader);
+  }
+
+  if (tail) {
+    EDII_IPCSockTailCursorDescriptor cursorDesc;
+    INIT_RESPONSE(cursorDesc, EDII_RESPONSE_TAIL_CURSOR, EDII_IPCS_SUCCESS);
+    cursorDesc.flags = reset ? EDII_IPCS_TAIL_FLAG_RESET : 0;
+    cursorDesc.cursor = cursor;
+
+    WRITE_CHECKED_RAW(socket, cursorDesc);
+  }
+
+  for (size_t idx = 0; idx < data.size(); idx++) {
+    const auto &item = data[idx];
+
+    if (sharedAxes) {
+      /* Traces that share the same X values share the data block too */
+      EDII_IPCSockAxisDescriptor axisDesc;
+      INIT_RESPONSE(axisDesc, EDII_RESPONSE_AXIS_DESCRIPTOR, EDII_IPCS_SUCCESS);
+
+      const auto it = sentAxes.constFind(item.xValues.constData());
+      if (it != sentAxes.cend()) {
+        axisDesc.axisId = *it;
+        axisDesc.valuesLength = 0;
+
+        WRITE_CHECKED_RAW(socket, axisDesc);
+      } else {
+        axisDesc.axisId = sentAxes.size();
+        axisDesc.valuesLength = item.xValues.size();
+        sentAxes.insert(item.xValues.constData(), axisDesc.axisId);
+
+        WRITE_CHECKED_RAW(socket, axisDesc);
+        const bool written = compressed ?
+                             writeCompressed(socket, item.xValues.constData(), nullptr, item.xValues.size()) :
+                             writeAll(socket, reinterpret_cast<const char *>(item.xValues.constData()), sizeof(double) * item.xValues.size());
+        if (!written) {
+          qWarning() << "Failed to send axis values:" << socket->errorString();
+          return false;
+        }
+      }
+    }
+
     EDII_IPCSockLoadDataResponseDescriptor respDesc;
     INIT_RESPONSE(respDesc, EDII_RESPONSE_LOAD_DATA_DESCRIPTOR, EDII_IPCS_SUCCESS);
 
@@ -308,7 +737,7 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
     respDesc.yDescriptionLength = yDescBytes.size();
     respDesc.xUnitLength = xUnitBytes.size();
     respDesc.yUnitLength = yUnitBytes.size();
-    respDesc.datapointsLength = item.datapoints.size();
+    respDesc.datapointsLength = item.yValues.size();
 
     WRITE_CHECKED_RAW(socket, respDesc);
     WRITE_CHECKED(socket, nameBytes);
@@ -319,19 +748,71 @@ bool LocalSocketConnectionHandler::respondLoadData(QLocalSocket *socket)
     WRITE_CHECKED(socket, xUnitBytes);
     WRITE_CHECKED(socket, yUnitBytes);
 
-   for (const auto &dp : item.datapoints) {
-      EDII_IPCSockDatapoint respDp;
+    if (sharedMemory) {
+      const auto &placement = sharedBuffer.placements()[idx];
+      EDII_IPCSockSharedMemoryTraceDescriptor traceDesc;
+      INIT_RESPONSE(traceDesc, EDII_RESPONSE_SHARED_MEMORY_TRACE, EDII_IPCS_SUCCESS);
+      traceDesc.xOffset = placement.xOffset;
+      traceDesc.yOffset = placement.yOffset;
+
+      WRITE_CHECKED_RAW(socket, traceDesc);
+      continue;
+    }
+
+    if (compact) {
+      if (!writeCompact(socket, sharedAxes ? nullptr : item.xValues.constData(), item.yValues.constData(), item.yValues.size())) {
+        qWarning() << "Failed to send datapoints:" << socket->errorString();
+        return false;
+      }
+      continue;
+    }
+
+    if (compressed) {
+      if (!writeCompressed(socket, sharedAxes ? nullptr : item.xValues.constData(), item.yValues.constData(), item.yValues.size())) {
+        qWarning() << "Failed to send datapoints:" << socket->errorString();
+        return false;
+      }
+      continue;
+    }
 
-      respDp.x = std::get<0>(dp);
-      respDp.y = std::get<1>(dp);
+    if (sharedAxes) {
+      if (!writeAll(socket, reinterpret_cast<const char *>(item.yValues.constData()), sizeof(double) * item.yValues.size())) {
+        qWarning() << "Failed to send datapoints:" << socket->errorString();
+        return false;
+      }
+      continue;
+    }
 
-      WRITE_CHECKED_RAW(socket, respDp);
+    const bool written = DatapointPacker::write(item.xValues.constData(), item.yValues.constData(), item.yValues.size(),
+                                                [socket](const char *block, const qint64 size) {
+                                                  return writeAll(socket, block, size);
+                                                });
+    if (!written) {
+      qWarning() << "Failed to send datapoints:" << socket->errorString();
+      return false;
     }
   }
-  return finalize(socket);
+  serializationTimer.stop();
+
+  chargeUnsent(device);
+  return true;
+}
+
+bool LocalSocketConnectionHandler::respondStats(QIODevice *socket)
+{
+  const QByteArray stats = ServiceStats::instance().toJson();
+  EDII_IPCSockStatsResponseDescriptor resp;
+
+  INIT_RESPONSE(resp, EDII_RESPONSE_STATS, EDII_IPCS_SUCCESS);
+  resp.statsLength = stats.size();
+
+  WRITE_CHECKED_RAW(socket, resp);
+  WRITE_CHECKED(socket, stats);
+
+  return true;
 }
 
-bool LocalSocketConnectionHandler::respondSupportedFormats(QLocalSocket *socket)
+bool LocalSocketConnectionHandler::respondSupportedFormats(QIODevice *socket)
 {
   const QVector<FileFormatInfo> ffiVec = h_loader.supportedFileFormats();
 
@@ -379,13 +860,11 @@ bool LocalSocketConnectionHandler::respondSupportedFormats(QLocalSocket *socket)
       }
     }
   }
-  return finalize(socket);
+  return true;
 }
 
-void LocalSocketConnectionHandler::run()
+/* Valid after an incremental load was handled */
+quint64 LocalSocketConnectionHandler::tailCursor() const
 {
-  QLocalSocket socket{};
-  socket.setSocketDescriptor(m_sockDesc);
-
-  handleConnection(&socket);
+  return m_tailCursor;
 }
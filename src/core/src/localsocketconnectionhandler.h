@@ -1,25 +1,33 @@
 #ifndef LOCALSOCKETCONNECTIONHANDLER_H
 #define LOCALSOCKETCONNECTIONHANDLER_H
 
-#include <QLocalSocket>
-#include <QRunnable>
+#include <QIODevice>
 
 class DataLoader;
+class RequestScheduler;
 
-class LocalSocketConnectionHandler : public QRunnable
+class LocalSocketConnectionHandler
 {
 public:
-  LocalSocketConnectionHandler(const quintptr sockDesc, const DataLoader &loader);
+  LocalSocketConnectionHandler(const DataLoader &loader, RequestScheduler &scheduler, const qint64 queuedAt);
+  bool handle(QIODevice *device, uint32_t &capabilities);
+  quint64 tailCursor() const;
 
 private:
-  void handleConnection(QLocalSocket *socket);
-  bool respondABIVersion(QLocalSocket *socket);
-  bool respondLoadData(QLocalSocket *socket);
-  bool respondSupportedFormats(QLocalSocket *socket);
-  virtual void run() override;
+  bool handleRequest(QIODevice *socket, uint32_t &capabilities);
+  bool respondABIVersion(QIODevice *socket);
+  bool respondABIVersionExt(QIODevice *socket, uint32_t &capabilities);
+  bool respondCatalogQuery(QIODevice *socket);
+  bool respondFlushTrace(QIODevice *socket);
+  bool respondLoadData(QIODevice *socket);
+  bool respondStats(QIODevice *socket);
+  bool respondSupportedFormats(QIODevice *socket);
 
   const DataLoader &h_loader;
-  const quintptr m_sockDesc;
+  RequestScheduler &h_scheduler;
+  const quint64 m_requestId;
+  const qint64 m_queuedAt;
+  quint64 m_tailCursor;                 /* Cursor returned by an incremental load */
 };
 
 #endif // LOCALSOCKETCONNECTIONHANDLER_H
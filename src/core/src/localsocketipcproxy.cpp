@@ -1,15 +1,82 @@
 #include "localsocketipcproxy.h"
-#include "localsocketconnectionhandler.h"
+#include "changenotifier.h"
+#include "localsocketconnection.h"
+#include "requestscheduler.h"
+#include "serviceconfig.h"
+#include "servicestats.h"
+#include "workerpool.h"
 
 #include <edii_ipc_network.h>
-#include <QThreadPool>
+#include <QJsonObject>
+#include <QThread>
+
+static
+QJsonObject waitStatsJson(const RequestScheduler::WaitStats &stats)
+{
+  return {
+    { "requests", static_cast<qint64>(stats.requests) },
+    { "totalWaitUs", static_cast<qint64>(stats.totalWaitUs) },
+    { "maxWaitUs", static_cast<qint64>(stats.maxWaitUs) }
+  };
+}
 
 IPCServer::IPCServer(const DataLoader &loader, QObject *parent) :
   QLocalServer{parent},
   h_loader{loader}
 {
-  m_threadPool = new QThreadPool{this};
-  m_threadPool->setMaxThreadCount(10);
+  const ServiceConfig::Scheduler &config = ServiceConfig::instance().scheduler;
+
+  m_scheduler = new RequestScheduler{config};
+
+  /* All connections are served by a single I/O thread that reads requests
+   * and writes responses without blocking. */
+  m_ioThread = new QThread{this};
+  m_ioThread->setObjectName("EDII local socket I/O");
+  m_ioContext = new QObject{};
+  m_ioContext->moveToThread(m_ioThread);
+  m_ioThread->start();
+
+  /* Workers only handle complete requests, decoding is limited by the
+   * scheduler. There must be enough threads to let queued interactive
+   * requests reach the scheduler while batch requests wait for a slot. */
+  m_workerPool = new WorkerPool{ServiceConfig::instance().workerPool, m_scheduler->slotCount() + 1};
+
+  /* Subscriptions are kept by the connections, their files are watched from the same thread */
+  m_changeNotifier = nullptr;
+  if (ServiceConfig::instance().subscriptions.enabled) {
+    m_changeNotifier = new ChangeNotifier{ServiceConfig::instance().subscriptions};
+    m_changeNotifier->moveToThread(m_ioThread);
+  }
+
+  m_statsProviderId = ServiceStats::instance().addProvider("localSocket", [this]() {
+    return QJsonObject{
+      { "workerPool", m_workerPool->statsJson() },
+      { "decodeSlotsBusy", m_scheduler->busySlots() },
+      { "decodeSlots", m_scheduler->slotCount() },
+      { "queueDepth", m_scheduler->queueDepth() },
+      { "waitTimes", QJsonObject{
+          { "interactive", waitStatsJson(m_scheduler->waitStats(RequestScheduler::PriorityClass::INTERACTIVE)) },
+          { "batch", waitStatsJson(m_scheduler->waitStats(RequestScheduler::PriorityClass::BATCH)) },
+          { "background", waitStatsJson(m_scheduler->waitStats(RequestScheduler::PriorityClass::BACKGROUND)) }
+        }
+      }
+    };
+  });
+}
+
+IPCServer::~IPCServer()
+{
+  ServiceStats::instance().removeProvider(m_statsProviderId);
+
+  /* Connections abort before the I/O thread stops, that releases workers waiting for the send window */
+  emit shuttingDown();
+  QMetaObject::invokeMethod(m_ioContext, [this]() { m_ioThread->quit(); }, Qt::QueuedConnection);
+  m_ioThread->wait();
+  delete m_ioContext;
+  delete m_changeNotifier;
+
+  delete m_workerPool;
+  delete m_scheduler;
 }
 
 void IPCServer::incomingConnection(quintptr sockDesc)
@@ -17,9 +84,11 @@ void IPCServer::incomingConnection(quintptr sockDesc)
   if (sockDesc == 0)
     return;
 
-  LocalSocketConnectionHandler *handler = new LocalSocketConnectionHandler{sockDesc, h_loader};
-  handler->setAutoDelete(true);
-  m_threadPool->start(handler);
+  LocalSocketConnection *conn = new LocalSocketConnection{sockDesc, h_loader, *m_scheduler, *m_workerPool, m_changeNotifier};
+  conn->moveToThread(m_ioThread);
+  connect(this, &IPCServer::shuttingDown, conn, &LocalSocketConnection::abort);
+
+  QMetaObject::invokeMethod(conn, &LocalSocketConnection::start, Qt::QueuedConnection);
 }
 
 LocalSocketIPCProxy::LocalSocketIPCProxy(DataLoader *loader, QObject *parent) :
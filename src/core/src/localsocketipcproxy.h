@@ -4,7 +4,10 @@
 #include "ipcproxy.h"
 #include <QLocalServer>
 
-class QThreadPool;
+class ChangeNotifier;
+class QThread;
+class RequestScheduler;
+class WorkerPool;
 
 class IPCServer : public QLocalServer
 {
@@ -12,11 +15,20 @@ class IPCServer : public QLocalServer
 
 public:
   explicit IPCServer(const DataLoader &loader, QObject *parent);
+  virtual ~IPCServer() override;
   virtual void incomingConnection(quintptr sockDesc) override;
 
 private:
   const DataLoader &h_loader;
-  QThreadPool *m_threadPool;
+  QThread *m_ioThread;
+  QObject *m_ioContext;                 /* Lives in the I/O thread */
+  WorkerPool *m_workerPool;
+  RequestScheduler *m_scheduler;
+  ChangeNotifier *m_changeNotifier;     /* Lives in the I/O thread, null when subscriptions are disabled */
+  int m_statsProviderId;
+
+signals:
+  void shuttingDown();
 };
 
 class LocalSocketIPCProxy : public IPCProxy
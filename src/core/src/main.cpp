@@ -6,6 +6,7 @@
 
 #include "dataloader.h"
 #include "ipcproxy.h"
+#include "requesttracer.h"
 
 #ifdef ECHMET_EDII_IPCINTERFACE_QTDBUS_ENABLED
   #include "dbusipcproxy.h"
@@ -156,6 +157,12 @@ int main(int argc, char *argv[])
 
     delete proxy;
 
+    if (RequestTracer::instance().enabled()) {
+      QString error;
+      if (RequestTracer::instance().flush(error) < 0)
+        std::cerr << "Cannot write trace: " << error.toStdString() << std::endl;
+    }
+
     return ret;
   } catch (std::runtime_error &ex) {
     QMessageBox msg{QMessageBox::Critical, QObject::tr("Cannot start EDII service"), ex.what(), QMessageBox::Ok};
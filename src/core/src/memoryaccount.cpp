@@ -0,0 +1,200 @@
+#include "memoryaccount.h"
+#include "servicestats.h"
+
+#include <QDebug>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static thread_local MemoryAccount *tl_account{nullptr};
+
+MemoryAccount::Scope::Scope(MemoryAccount &account) :
+  m_previous{tl_account}
+{
+  tl_account = &account;
+}
+
+MemoryAccount::Scope::~Scope()
+{
+  tl_account = m_previous;
+}
+
+MemoryAccount::RequestReport::RequestReport(const QString &formatTag, const quint64 requestId) :
+  m_formatTag{formatTag},
+  m_requestId{requestId},
+  m_account{enabled() ? new MemoryAccount{} : nullptr},
+  m_scope{enabled() ? new Scope{*m_account} : nullptr}
+{
+}
+
+MemoryAccount::RequestReport::~RequestReport()
+{
+  if (m_account == nullptr)
+    return;
+
+  delete m_scope;
+
+  ServiceStats::instance().recordMemory(m_formatTag, m_account->peakBytes(), m_account->allocations());
+  qInfo().nospace() << "Request " << m_requestId << " (" << m_formatTag << "): peak " << m_account->peakBytes()
+                    << " bytes, " << m_account->allocations() << " allocations of " << m_account->allocatedBytes() << " bytes";
+
+  delete m_account;
+}
+
+MemoryAccount::MemoryAccount() :
+  m_allocations{0},
+  m_allocatedBytes{0},
+  m_currentBytes{0},
+  m_peakBytes{0}
+{
+}
+
+void MemoryAccount::allocated(const qint64 bytes)
+{
+  m_allocations++;
+  m_allocatedBytes += bytes;
+  m_currentBytes += bytes;
+  if (m_currentBytes > m_peakBytes)
+    m_peakBytes = m_currentBytes;
+}
+
+qint64 MemoryAccount::allocations() const
+{
+  return m_allocations;
+}
+
+qint64 MemoryAccount::allocatedBytes() const
+{
+  return m_allocatedBytes;
+}
+
+/* Charges memory that is not allocated through operator new to the account active on the current thread */
+void MemoryAccount::charge(const qint64 bytes)
+{
+  if (!enabled() || tl_account == nullptr)
+    return;
+
+  tl_account->allocated(bytes);
+}
+
+qint64 MemoryAccount::peakBytes() const
+{
+  return m_peakBytes;
+}
+
+void MemoryAccount::released(const qint64 bytes)
+{
+  m_currentBytes -= bytes;
+}
+
+#ifdef ECHMET_EDII_MEMORY_ACCOUNTING_ENABLED
+
+/* Size of the block is stored in front of it, the header keeps the fundamental alignment */
+static const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+static
+void * accountedAlloc(std::size_t size) noexcept
+{
+  if (size == 0)
+    size = 1;
+
+  void *raw = std::malloc(size + HEADER_SIZE);
+  if (raw == nullptr)
+    return nullptr;
+
+  *static_cast<std::size_t *>(raw) = size;
+  if (tl_account != nullptr)
+    tl_account->allocated(size);
+
+  return static_cast<char *>(raw) + HEADER_SIZE;
+}
+
+static
+void accountedFree(void *ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+
+  void *raw = static_cast<char *>(ptr) - HEADER_SIZE;
+  if (tl_account != nullptr)
+    tl_account->released(*static_cast<std::size_t *>(raw));
+
+  std::free(raw);
+}
+
+static
+void * accountedNew(const std::size_t size)
+{
+  for (;;) {
+    void *ptr = accountedAlloc(size);
+    if (ptr != nullptr)
+      return ptr;
+
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr)
+      throw std::bad_alloc{};
+    handler();
+  }
+}
+
+static
+void * accountedNewNothrow(const std::size_t size) noexcept
+{
+  try {
+    return accountedNew(size);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void * operator new(std::size_t size)
+{
+  return accountedNew(size);
+}
+
+void * operator new[](std::size_t size)
+{
+  return accountedNew(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return accountedNewNothrow(size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return accountedNewNothrow(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  accountedFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  accountedFree(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  accountedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  accountedFree(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+  accountedFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+  accountedFree(ptr);
+}
+
+#endif // ECHMET_EDII_MEMORY_ACCOUNTING_ENABLED
@@ -0,0 +1,77 @@
+#ifndef MEMORYACCOUNT_H
+#define MEMORYACCOUNT_H
+
+#include <QString>
+
+/*
+ * Counts memory allocated by the thread that serves a request.
+ *
+ * When EDII is built with ECHMET_EDII_MEMORY_ACCOUNTING, global operator new
+ * and delete are replaced and every allocation made while an account is
+ * active on the thread is charged to it. That includes allocations made by
+ * plugins. Qt containers allocate with malloc() directly, components that
+ * create large Qt containers charge them explicitly with charge().
+ *
+ * Memory released on the thread lowers the current usage even if it was
+ * allocated before the account became active. The peak is the highest
+ * current usage seen while the account was active.
+ */
+class MemoryAccount {
+public:
+  /* Makes the account active on the current thread for the lifetime of the object */
+  class Scope {
+  public:
+    explicit Scope(MemoryAccount &account);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+  private:
+    MemoryAccount *const m_previous;
+  };
+
+  /* Owns an account that is active on the current thread and reports its summary when the request is done */
+  class RequestReport {
+  public:
+    explicit RequestReport(const QString &formatTag, const quint64 requestId);
+    ~RequestReport();
+
+    RequestReport(const RequestReport &) = delete;
+    RequestReport & operator=(const RequestReport &) = delete;
+
+  private:
+    const QString m_formatTag;
+    const quint64 m_requestId;
+    MemoryAccount *const m_account;
+    Scope *const m_scope;
+  };
+
+  explicit MemoryAccount();
+
+  void allocated(const qint64 bytes);
+  qint64 allocations() const;
+  qint64 allocatedBytes() const;
+  qint64 peakBytes() const;
+  void released(const qint64 bytes);
+
+  static void charge(const qint64 bytes);
+  static constexpr bool enabled();
+
+private:
+  qint64 m_allocations;
+  qint64 m_allocatedBytes;
+  qint64 m_currentBytes;
+  qint64 m_peakBytes;
+};
+
+constexpr bool MemoryAccount::enabled()
+{
+#ifdef ECHMET_EDII_MEMORY_ACCOUNTING_ENABLED
+  return true;
+#else
+  return false;
+#endif // ECHMET_EDII_MEMORY_ACCOUNTING_ENABLED
+}
+
+#endif // MEMORYACCOUNT_H
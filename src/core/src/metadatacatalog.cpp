@@ -0,0 +1,507 @@
+#include "metadatacatalog.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+
+#define FOREGROUND_POLL_INTERVAL 25
+#define INDEX_MAGIC 0x45444943
+#define INDEX_VERSION 1
+
+static
+QString defaultIndexPath()
+{
+  const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+
+  return QDir{cacheDir}.filePath("ECHMET/EDII-catalog.dat");
+}
+
+static
+int compareValues(const QString &a, const QString &b)
+{
+  bool aOk;
+  bool bOk;
+  const double aNum = a.toDouble(&aOk);
+  const double bNum = b.toDouble(&bOk);
+
+  if (aOk && bOk)
+    return aNum < bNum ? -1 : (aNum > bNum ? 1 : 0);
+  return QString::compare(a, b, Qt::CaseInsensitive);
+}
+
+/* Tells whether a scan of a folder with the name filters lists the file */
+static
+bool matchesFilters(const QStringList &nameFilters, const QString &path)
+{
+  return nameFilters.isEmpty() || QDir::match(nameFilters, QFileInfo{path}.fileName());
+}
+
+class MetadataCatalog::RefreshJob : public QRunnable
+{
+public:
+  RefreshJob(MetadataCatalog &catalog) :
+    h_catalog{catalog}
+  {}
+
+  virtual void run() override
+  {
+    h_catalog.m_refreshQueued = false;
+    h_catalog.refresh();
+  }
+
+private:
+  MetadataCatalog &h_catalog;
+};
+
+class MetadataCatalog::UpdateJob : public QRunnable
+{
+public:
+  UpdateJob(MetadataCatalog &catalog, const QString &formatTag, const QString &path) :
+    h_catalog{catalog},
+    m_formatTag{formatTag},
+    m_path{path}
+  {}
+
+  virtual void run() override
+  {
+    const QFileInfo fi{m_path};
+
+    if (fi.isFile() && h_catalog.waitForForeground()) {
+      Entry entry = h_catalog.readEntry(m_formatTag, fi);
+      {
+        QWriteLocker locker{&h_catalog.m_lock};
+        h_catalog.m_entries.insert(QDir::cleanPath(fi.absoluteFilePath()), std::move(entry));
+      }
+      h_catalog.m_unsaved = true;
+    }
+
+    /* Files often arrive in bursts, the index is written once all queued updates are done */
+    if (--h_catalog.m_pendingUpdates == 0)
+      h_catalog.saveChanges();
+  }
+
+private:
+  MetadataCatalog &h_catalog;
+  const QString m_formatTag;
+  const QString m_path;
+};
+
+bool MetadataCatalog::Term::matches(const QString &path, const Entry &entry) const
+{
+  auto test = [this](const QString &v) {
+    switch (op) {
+    case Op::ANY:
+    case Op::CONTAINS:
+      return v.contains(value, Qt::CaseInsensitive);
+    case Op::EQUALS:
+      return QString::compare(v, value, Qt::CaseInsensitive) == 0;
+    case Op::GREATER:
+      return compareValues(v, value) > 0;
+    case Op::LESS:
+      return compareValues(v, value) < 0;
+    }
+    return false;
+  };
+
+  if (op == Op::ANY) {
+    if (test(path))
+      return true;
+    for (const auto &item : entry.metadata) {
+      if (test(item.second))
+        return true;
+    }
+    return false;
+  }
+
+  if (key.compare("tag", Qt::CaseInsensitive) == 0)
+    return test(entry.tag);
+  if (key.compare("path", Qt::CaseInsensitive) == 0)
+    return test(path);
+  if (key.compare("name", Qt::CaseInsensitive) == 0)
+    return test(path.mid(path.lastIndexOf('/') + 1));
+
+  for (const auto &item : entry.metadata) {
+    if (item.first.compare(key, Qt::CaseInsensitive) == 0 && test(item.second))
+      return true;
+  }
+
+  return false;
+}
+
+MetadataCatalog::MetadataCatalog(const ServiceConfig::Catalog &config, Reader reader, const std::atomic<int> &foregroundLoads, QObject *parent) :
+  QObject{parent},
+  m_config{config},
+  m_reader{std::move(reader)},
+  h_foregroundLoads{foregroundLoads},
+  m_indexPath{config.indexPath.isEmpty() ? defaultIndexPath() : config.indexPath},
+  m_refreshQueued{false},
+  m_stopping{false},
+  m_unsaved{false},
+  m_pendingUpdates{0},
+  m_lastRefresh{0},
+  m_lastRefreshDuration{0},
+  m_filesRead{0},
+  m_queries{0}
+{
+  load();
+
+  m_pool = new QThreadPool{};
+  m_pool->setMaxThreadCount(1);
+  m_pool->setThreadPriority(QThread::IdlePriority);
+
+  m_refreshTimer = new QTimer{this};
+  connect(m_refreshTimer, &QTimer::timeout, this, &MetadataCatalog::scheduleRefresh);
+  if (m_config.refreshInterval > 0)
+    m_refreshTimer->start(m_config.refreshInterval * 1000);
+
+  scheduleRefresh();
+}
+
+MetadataCatalog::~MetadataCatalog()
+{
+  m_stopping = true;
+  m_refreshTimer->stop();
+  m_pool->clear();
+  m_pool->waitForDone();
+  delete m_pool;
+
+  /* Updates dropped from the queue did not get to write what was done before them */
+  saveChanges();
+}
+
+void MetadataCatalog::load()
+{
+  QFile file{m_indexPath};
+
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream stream{&file};
+  stream.setVersion(QDataStream::Qt_6_0);
+
+  quint32 magic;
+  quint32 version;
+  stream >> magic >> version;
+  if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+    qWarning() << "Ignoring catalog index" << m_indexPath << "of an unknown version";
+    return;
+  }
+
+  quint32 count;
+  stream >> count;
+
+  QHash<QString, Entry> entries;
+  entries.reserve(count);
+  for (quint32 idx = 0; idx < count; idx++) {
+    QString path;
+    Entry entry;
+
+    stream >> path >> entry.tag >> entry.size >> entry.modified >> entry.metadata;
+    if (stream.status() != QDataStream::Ok) {
+      qWarning() << "Catalog index" << m_indexPath << "is damaged, folders will be scanned again";
+      return;
+    }
+    entries.insert(path, std::move(entry));
+  }
+
+  QWriteLocker locker{&m_lock};
+  m_entries = std::move(entries);
+}
+
+/* Returns matches sorted from the most recently modified file */
+QJsonArray MetadataCatalog::query(const QString &query, const int maxResults, bool &ok, QString &error) const
+{
+  QVector<Term> terms;
+  QVector<QHash<QString, Entry>::const_iterator> matches;
+
+  m_queries++;
+
+  ok = parseQuery(query, terms, error);
+  if (!ok)
+    return {};
+
+  QReadLocker locker{&m_lock};
+
+  for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+    const bool matched = std::all_of(terms.cbegin(), terms.cend(), [&it](const Term &term) {
+      return term.matches(it.key(), it.value());
+    });
+    if (matched)
+      matches.append(it);
+  }
+
+  std::sort(matches.begin(), matches.end(), [](const auto &a, const auto &b) {
+    return a->modified > b->modified;
+  });
+  if (maxResults > 0 && matches.size() > maxResults)
+    matches.resize(maxResults);
+
+  QJsonArray results;
+  for (const auto &it : matches) {
+    QJsonObject metadata;
+    for (const auto &item : it->metadata)
+      metadata.insert(item.first, item.second);
+
+    results.append(QJsonObject{
+      { "path", it.key() },
+      { "tag", it->tag },
+      { "modified", QDateTime::fromMSecsSinceEpoch(it->modified).toString(Qt::ISODate) },
+      { "metadata", metadata }
+    });
+  }
+
+  return results;
+}
+
+bool MetadataCatalog::parseQuery(const QString &query, QVector<Term> &terms, QString &error)
+{
+  QStringList tokens;
+  QString token;
+  bool quoted = false;
+  bool pending = false;
+
+  for (const QChar ch : query) {
+    if (ch == '"') {
+      quoted = !quoted;
+      pending = true;
+    } else if (ch.isSpace() && !quoted) {
+      if (pending)
+        tokens.append(token);
+      token.clear();
+      pending = false;
+    } else {
+      token.append(ch);
+      pending = true;
+    }
+  }
+  if (quoted) {
+    error = "Unterminated quote in query";
+    return false;
+  }
+  if (pending)
+    tokens.append(token);
+
+  if (tokens.isEmpty()) {
+    error = "Query is empty";
+    return false;
+  }
+
+  for (const QString &tok : tokens) {
+    const int opPos = tok.indexOf(QRegularExpression{"[=~<>]"});
+
+    if (opPos <= 0) {
+      terms.append(Term{{}, Term::Op::ANY, tok});
+      continue;
+    }
+
+    Term::Op op;
+    switch (tok.at(opPos).toLatin1()) {
+    case '=':
+      op = Term::Op::EQUALS;
+      break;
+    case '~':
+      op = Term::Op::CONTAINS;
+      break;
+    case '>':
+      op = Term::Op::GREATER;
+      break;
+    default:
+      op = Term::Op::LESS;
+      break;
+    }
+
+    terms.append(Term{tok.left(opPos), op, tok.mid(opPos + 1)});
+  }
+
+  return true;
+}
+
+MetadataCatalog::Entry MetadataCatalog::readEntry(const QString &formatTag, const QFileInfo &fi) const
+{
+  Entry entry{formatTag, fi.size(), fi.lastModified().toMSecsSinceEpoch(), {}};
+
+  /* Files whose metadata cannot be read are still indexed so that they can be found by name */
+  if (!m_reader(formatTag, fi.absoluteFilePath(), entry.metadata))
+    entry.metadata.clear();
+  m_filesRead++;
+
+  return entry;
+}
+
+void MetadataCatalog::refresh()
+{
+  QElapsedTimer timer;
+  QSet<QString> seen;
+  QVector<QPair<QString, QStringList>> roots;   /* Prefixes of the scanned folders and their name filters */
+
+  timer.start();
+
+  for (const ServiceConfig::Folder &folder : m_config.folders) {
+    const QString root = QDir{folder.path}.absolutePath();
+
+    if (!QFileInfo{root}.isDir()) {
+      qWarning() << "Catalog folder" << root << "does not exist";
+      continue;
+    }
+    const QString prefix = QDir::cleanPath(root);
+    roots.append({ prefix.endsWith('/') ? prefix : prefix + '/', folder.nameFilters });
+
+    QDirIterator dirIt{root, folder.nameFilters, QDir::Files | QDir::Readable, QDirIterator::Subdirectories};
+    while (dirIt.hasNext()) {
+      /* Files read so far are kept so that the next start does not read them again */
+      if (m_stopping.load()) {
+        saveChanges();
+        return;
+      }
+
+      const QString path = QDir::cleanPath(dirIt.next());
+      const QFileInfo fi = dirIt.fileInfo();
+      seen.insert(path);
+
+      {
+        QReadLocker locker{&m_lock};
+        const auto it = m_entries.constFind(path);
+        if (it != m_entries.cend() && it->tag == folder.tag &&
+            it->size == fi.size() && it->modified == fi.lastModified().toMSecsSinceEpoch())
+          continue;
+      }
+
+      if (!waitForForeground()) {
+        saveChanges();
+        return;
+      }
+
+      Entry entry = readEntry(folder.tag, fi);
+      QWriteLocker locker{&m_lock};
+      m_entries.insert(path, std::move(entry));
+      m_unsaved = true;
+    }
+  }
+
+  /*
+   * Drop files that were removed. Files added by update() that the scan does not list,
+   * either outside of the scanned folders or not matching their name filters, are kept while they exist
+   */
+  {
+    QWriteLocker locker{&m_lock};
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+      const QString path = QDir::cleanPath(it.key());
+      if (seen.contains(path)) {
+        ++it;
+        continue;
+      }
+
+      const bool scanned = std::any_of(roots.cbegin(), roots.cend(), [&path](const QPair<QString, QStringList> &root) {
+        return path.startsWith(root.first) && matchesFilters(root.second, path);
+      });
+      if (scanned || !QFileInfo::exists(it.key())) {
+        it = m_entries.erase(it);
+        m_unsaved = true;
+      } else
+        ++it;
+    }
+  }
+
+  m_lastRefresh = QDateTime::currentMSecsSinceEpoch();
+  m_lastRefreshDuration = timer.elapsed();
+
+  saveChanges();
+}
+
+void MetadataCatalog::save() const
+{
+  QDir{}.mkpath(QFileInfo{m_indexPath}.absolutePath());
+
+  QSaveFile file{m_indexPath};
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Cannot write catalog index" << m_indexPath << ":" << file.errorString();
+    return;
+  }
+
+  QDataStream stream{&file};
+  stream.setVersion(QDataStream::Qt_6_0);
+
+  {
+    QReadLocker locker{&m_lock};
+
+    stream << quint32(INDEX_MAGIC) << quint32(INDEX_VERSION) << quint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+      stream << it.key() << it->tag << it->size << it->modified << it->metadata;
+  }
+
+  if (!file.commit())
+    qWarning() << "Cannot write catalog index" << m_indexPath << ":" << file.errorString();
+}
+
+void MetadataCatalog::saveChanges()
+{
+  if (m_unsaved.exchange(false))
+    save();
+}
+
+void MetadataCatalog::scheduleRefresh()
+{
+  bool expected = false;
+
+  /* A refresh that has not started yet covers this request too */
+  if (!m_refreshQueued.compare_exchange_strong(expected, true))
+    return;
+
+  RefreshJob *job = new RefreshJob{*this};
+  job->setAutoDelete(true);
+  m_pool->start(job);
+}
+
+QJsonObject MetadataCatalog::statsJson() const
+{
+  qint64 entries;
+  {
+    QReadLocker locker{&m_lock};
+    entries = m_entries.size();
+  }
+
+  const qint64 lastRefresh = m_lastRefresh.load();
+
+  return QJsonObject{
+    { "entries", entries },
+    { "folders", m_config.folders.size() },
+    { "filesRead", static_cast<qint64>(m_filesRead.load()) },
+    { "queries", static_cast<qint64>(m_queries.load()) },
+    { "lastRefresh", lastRefresh > 0 ? QDateTime::fromMSecsSinceEpoch(lastRefresh).toString(Qt::ISODate) : QString{} },
+    { "lastRefreshDuration", m_lastRefreshDuration.load() }
+  };
+}
+
+/* Indexes a single file, used for files that appear in watched folders between rescans */
+void MetadataCatalog::update(const QString &formatTag, const QString &path)
+{
+  UpdateJob *job = new UpdateJob{*this, formatTag, path};
+  m_pendingUpdates++;
+  job->setAutoDelete(true);
+  m_pool->start(job);
+}
+
+bool MetadataCatalog::waitForForeground() const
+{
+  while (h_foregroundLoads.load() > 0) {
+    if (m_stopping.load())
+      return false;
+    QThread::msleep(FOREGROUND_POLL_INTERVAL);
+  }
+
+  return !m_stopping.load();
+}
@@ -0,0 +1,110 @@
+#ifndef METADATACATALOG_H
+#define METADATACATALOG_H
+
+#include "serviceconfig.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+class QFileInfo;
+class QThreadPool;
+class QTimer;
+
+/*
+ * Keeps an index of metadata (sample, operator, method, acquisition time and so on)
+ * of data files in the configured folders so that clients can look files up without
+ * opening them. Folders are scanned recursively at startup and then periodically,
+ * only files that changed since the last scan are read again. Scanning is done by
+ * a single idle priority thread and pauses whenever a foreground load is in progress.
+ * The index is stored on disk and loaded back when EDII starts.
+ *
+ * Queries consist of whitespace separated terms that all must match. A term is either
+ * a bare word that matches a path or any metadata value containing it, or "key=value"
+ * (equals), "key~value" (contains), "key>value" or "key<value" (compares numerically
+ * if both sides are numbers, alphabetically otherwise; ISO 8601 timestamps compare
+ * correctly either way). Keys "tag", "path" and "name" refer to the format tag, path
+ * and file name. Values with whitespace can be enclosed in double quotes. All
+ * comparisons are case-insensitive.
+ */
+class MetadataCatalog : public QObject
+{
+  Q_OBJECT
+
+public:
+  typedef QVector<QPair<QString, QString>> Metadata;
+  /* Reads metadata of a file with the plugin identified by the format tag */
+  typedef std::function<bool (const QString &, const QString &, Metadata &)> Reader;
+
+  explicit MetadataCatalog(const ServiceConfig::Catalog &config, Reader reader, const std::atomic<int> &foregroundLoads, QObject *parent = nullptr);
+  ~MetadataCatalog();
+  QJsonArray query(const QString &query, const int maxResults, bool &ok, QString &error) const;
+  QJsonObject statsJson() const;
+  void update(const QString &formatTag, const QString &path);
+
+private:
+  class Entry {
+  public:
+    QString tag;
+    qint64 size;
+    qint64 modified;
+    Metadata metadata;                  /* Empty if the plugin cannot read metadata of the file */
+  };
+
+  class Term {
+  public:
+    enum class Op {
+      ANY,
+      EQUALS,
+      CONTAINS,
+      GREATER,
+      LESS
+    };
+
+    bool matches(const QString &path, const Entry &entry) const;
+
+    QString key;
+    Op op;
+    QString value;
+  };
+
+  class RefreshJob;
+  class UpdateJob;
+
+  Entry readEntry(const QString &formatTag, const QFileInfo &fi) const;
+  void load();
+  void refresh();
+  void save() const;
+  void saveChanges();
+  void scheduleRefresh();
+  bool waitForForeground() const;
+
+  static bool parseQuery(const QString &query, QVector<Term> &terms, QString &error);
+
+  const ServiceConfig::Catalog m_config;
+  const Reader m_reader;
+  const std::atomic<int> &h_foregroundLoads;
+  const QString m_indexPath;
+
+  QHash<QString, Entry> m_entries;
+  mutable QReadWriteLock m_lock;
+
+  QThreadPool *m_pool;
+  QTimer *m_refreshTimer;
+  std::atomic<bool> m_refreshQueued;
+  std::atomic<bool> m_stopping;
+  std::atomic<bool> m_unsaved;          /* Entries changed since the index was last written */
+  std::atomic<int> m_pendingUpdates;    /* Queued update jobs */
+  std::atomic<qint64> m_lastRefresh;
+  std::atomic<qint64> m_lastRefreshDuration;
+  mutable std::atomic<quint64> m_filesRead;
+  mutable std::atomic<quint64> m_queries;
+};
+
+#endif // METADATACATALOG_H
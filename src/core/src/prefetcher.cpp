@@ -0,0 +1,222 @@
+#include "prefetcher.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+#define READ_CHUNK_SIZE (256 * 1024)
+#define FOREGROUND_POLL_INTERVAL 25
+#define HINT_JOB_PRIORITY 1
+#define INGEST_JOB_PRIORITY 0
+
+static
+QFileInfoList collectFiles(const QString &hintPath, const int maxFiles)
+{
+  const QFileInfo hint{hintPath};
+  const QDir dir = hint.isDir() ? QDir{hint.absoluteFilePath()} : hint.absoluteDir();
+  QFileInfoList files;
+
+  if (!dir.exists() || !dir.isReadable())
+    return files;
+
+  /* Look one level deep so that per-run directories (such as ChemStation's *.D) are covered too */
+  for (const QFileInfo &fi : dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable)) {
+    if (fi.isDir())
+      files.append(QDir{fi.absoluteFilePath()}.entryInfoList(QDir::Files | QDir::Readable));
+    else
+      files.append(fi);
+  }
+
+  std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+    return a.lastModified() > b.lastModified();
+  });
+
+  if (files.size() > maxFiles)
+    files.erase(files.begin() + maxFiles, files.end());
+
+  return files;
+}
+
+class Prefetcher::Job : public QRunnable
+{
+public:
+  Job(const Prefetcher &prefetcher, const QString &hintPath, Decoder decoder, const quint64 session) :
+    h_prefetcher{prefetcher},
+    m_hintPath{hintPath},
+    m_decoder{std::move(decoder)},
+    m_session{session}
+  {}
+
+  virtual void run() override
+  {
+    const auto &config = h_prefetcher.m_config;
+    qint64 ioUsed = 0;
+    qint64 memoryUsed = 0;
+
+    if (h_prefetcher.isCancelled(m_session))
+      return;
+
+    const QFileInfoList files = collectFiles(m_hintPath, config.maxFiles);
+
+    for (const QFileInfo &fi : files) {
+      if (!h_prefetcher.waitForForeground(m_session))
+        return;
+
+      if (ioUsed + fi.size() > config.ioBudget)
+        continue;
+
+      const QString path = fi.absoluteFilePath();
+      if (!h_prefetcher.warm(path, m_session, ioUsed))
+        return;
+
+      if (m_decoder && memoryUsed < config.memoryBudget) {
+        if (!h_prefetcher.waitForForeground(m_session))
+          return;
+        memoryUsed += m_decoder(path);
+      }
+    }
+  }
+
+private:
+  const Prefetcher &h_prefetcher;
+  const QString m_hintPath;
+  const Decoder m_decoder;
+  const quint64 m_session;
+};
+
+class Prefetcher::IngestJob : public QRunnable
+{
+public:
+  IngestJob(const Prefetcher &prefetcher, const QString &path, Decoder decoder) :
+    h_prefetcher{prefetcher},
+    m_path{path},
+    m_decoder{std::move(decoder)}
+  {}
+
+  virtual void run() override
+  {
+    qint64 ioUsed = 0;
+
+    if (!h_prefetcher.waitForForeground(INGEST_SESSION))
+      return;
+    if (!h_prefetcher.warm(m_path, INGEST_SESSION, ioUsed))
+      return;
+
+    if (m_decoder) {
+      if (!h_prefetcher.waitForForeground(INGEST_SESSION))
+        return;
+      m_decoder(m_path);
+    }
+  }
+
+private:
+  const Prefetcher &h_prefetcher;
+  const QString m_path;
+  const Decoder m_decoder;
+};
+
+Prefetcher::Prefetcher(const ServiceConfig::Prefetch &config, const std::atomic<int> &foregroundLoads) :
+  m_config{config},
+  h_foregroundLoads{foregroundLoads},
+  m_session{0},
+  m_stopping{false}
+{
+  m_pool = new QThreadPool{};
+  m_pool->setMaxThreadCount(1);
+  m_pool->setThreadPriority(QThread::IdlePriority);
+}
+
+Prefetcher::~Prefetcher()
+{
+  m_stopping = true;
+  m_session++;
+  m_pool->clear();
+  m_pool->waitForDone();
+  delete m_pool;
+}
+
+void Prefetcher::ingest(const QString &path, Decoder decoder)
+{
+  IngestJob *job = new IngestJob{*this, path, std::move(decoder)};
+  job->setAutoDelete(true);
+  m_pool->start(job, INGEST_JOB_PRIORITY);
+}
+
+bool Prefetcher::isCancelled(const quint64 session) const
+{
+  if (m_stopping.load())
+    return true;
+  return session != INGEST_SESSION && m_session.load() != session;
+}
+
+quint64 Prefetcher::start(const QString &hintPath, Decoder decoder)
+{
+  /* Only the most recent hint is served, any previous job stops at its next checkpoint */
+  const quint64 session = ++m_session;
+
+  Job *job = new Job{*this, hintPath, std::move(decoder), session};
+  job->setAutoDelete(true);
+  m_pool->start(job, HINT_JOB_PRIORITY);
+
+  return session;
+}
+
+void Prefetcher::stop(const quint64 session)
+{
+  quint64 expected = session;
+
+  /* Leave jobs started by a later hint running */
+  m_session.compare_exchange_strong(expected, session + 1);
+}
+
+bool Prefetcher::waitForForeground(const quint64 session) const
+{
+  while (h_foregroundLoads.load() > 0) {
+    if (isCancelled(session))
+      return false;
+    QThread::msleep(FOREGROUND_POLL_INTERVAL);
+  }
+
+  return !isCancelled(session);
+}
+
+bool Prefetcher::warm(const QString &path, const quint64 session, qint64 &ioUsed) const
+{
+  QFile file{path};
+  QElapsedTimer timer;
+  qint64 read = 0;
+
+  if (!file.open(QIODevice::ReadOnly))
+    return true;
+
+  QByteArray buffer{READ_CHUNK_SIZE, Qt::Uninitialized};
+  timer.start();
+
+  while (true) {
+    if (!waitForForeground(session))
+      return false;
+
+    const qint64 r = file.read(buffer.data(), buffer.size());
+    if (r <= 0)
+      break;
+
+    read += r;
+    ioUsed += r;
+
+    /* Throttle reads to the configured rate */
+    if (m_config.ioRate > 0) {
+      const qint64 due = read * 1000 / m_config.ioRate;
+      const qint64 elapsed = timer.elapsed();
+      if (due > elapsed)
+        QThread::msleep(due - elapsed);
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include "serviceconfig.h"
+
+#include <QString>
+#include <atomic>
+#include <functional>
+
+class QThreadPool;
+
+/*
+ * Reads ahead files in a directory that the user is likely to load data from.
+ * Files are read into the OS page cache and, if a decoder is given, decoded
+ * into the decode cache. Work is done by a single idle priority thread and
+ * pauses whenever a foreground load is in progress.
+ *
+ * Individual files can be queued for ingestion too. These are not tied to
+ * any hint and yield to read-ahead of a hinted directory.
+ */
+class Prefetcher {
+public:
+  /* Decodes a file into the decode cache, returns the number of bytes stored */
+  typedef std::function<qint64 (const QString &)> Decoder;
+
+  explicit Prefetcher(const ServiceConfig::Prefetch &config, const std::atomic<int> &foregroundLoads);
+  ~Prefetcher();
+  void ingest(const QString &path, Decoder decoder);
+  quint64 start(const QString &hintPath, Decoder decoder);
+  void stop(const quint64 session);
+
+private:
+  class IngestJob;
+  class Job;
+
+  /* Ingestion jobs use this session, they stop only when the prefetcher is destroyed */
+  static const quint64 INGEST_SESSION = 0;
+
+  bool isCancelled(const quint64 session) const;
+  bool waitForForeground(const quint64 session) const;
+  bool warm(const QString &path, const quint64 session, qint64 &ioUsed) const;
+
+  const ServiceConfig::Prefetch m_config;
+  const std::atomic<int> &h_foregroundLoads;
+
+  QThreadPool *m_pool;
+  std::atomic<quint64> m_session;
+  std::atomic<bool> m_stopping;
+};
+
+#endif // PREFETCHER_H
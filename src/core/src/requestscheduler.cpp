@@ -0,0 +1,122 @@
+#include "requestscheduler.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+
+#define IDX(cls) static_cast<int>(cls)
+
+RequestScheduler::Slot::Slot(RequestScheduler &scheduler, const PriorityClass cls) :
+  h_scheduler{scheduler},
+  m_cls{cls}
+{
+  h_scheduler.acquire(m_cls);
+}
+
+RequestScheduler::Slot::~Slot()
+{
+  h_scheduler.release(m_cls);
+}
+
+RequestScheduler::RequestScheduler(const ServiceConfig::Scheduler &config) :
+  m_slots{std::max(1, config.decodeSlots)},
+  m_batchMinSlots{std::min(std::max(0, (config.decodeSlots * config.batchMinShare + 99) / 100), m_slots - 1)},
+  m_interactiveReservedSlots{std::min(std::max(0, config.interactiveReservedSlots), m_slots - 1 - m_batchMinSlots)},
+  m_running{0, 0, 0},
+  m_waitStats{},
+  m_nextTicket{0}
+{
+}
+
+void RequestScheduler::acquire(const PriorityClass cls)
+{
+  QElapsedTimer timer;
+  QMutexLocker locker{&m_lock};
+
+  timer.start();
+
+  const quint64 ticket = m_nextTicket++;
+  m_queues[IDX(cls)].push_back(ticket);
+
+  while (!canRun(cls, ticket))
+    m_slotFreed.wait(&m_lock);
+
+  m_queues[IDX(cls)].pop_front();
+  m_running[IDX(cls)]++;
+
+  const quint64 waitUs = timer.nsecsElapsed() / 1000;
+  WaitStats &ws = m_waitStats[IDX(cls)];
+  ws.requests++;
+  ws.totalWaitUs += waitUs;
+  ws.maxWaitUs = std::max(ws.maxWaitUs, waitUs);
+
+  /* Others may be able to run too if there are more free slots */
+  m_slotFreed.wakeAll();
+}
+
+int RequestScheduler::busySlots() const
+{
+  QMutexLocker locker{&m_lock};
+
+  return m_running[0] + m_running[1] + m_running[2];
+}
+
+/* Must be called with the lock held */
+bool RequestScheduler::canRun(const PriorityClass cls, const quint64 ticket) const
+{
+  const auto &queue = m_queues[IDX(cls)];
+  if (queue.front() != ticket)
+    return false;
+
+  const int busy = m_running[0] + m_running[1] + m_running[2];
+  const int free = m_slots - busy;
+  if (free < 1)
+    return false;
+
+  const bool interactiveWaiting = !m_queues[IDX(PriorityClass::INTERACTIVE)].empty();
+  const bool batchWaiting = !m_queues[IDX(PriorityClass::BATCH)].empty();
+
+  /* Slots that batch requests are entitled to and do not use yet */
+  const int batchOwed = batchWaiting ? std::max(0, m_batchMinSlots - m_running[IDX(PriorityClass::BATCH)]) : 0;
+  /* Slots kept for interactive requests that may arrive any moment */
+  const int interactiveKept = std::max(0, m_interactiveReservedSlots - m_running[IDX(PriorityClass::INTERACTIVE)]);
+
+  switch (cls) {
+  case PriorityClass::INTERACTIVE:
+    return free > batchOwed;
+  case PriorityClass::BATCH:
+    if (batchOwed > 0)
+      return true;
+    return !interactiveWaiting && free > interactiveKept;
+  case PriorityClass::BACKGROUND:
+    return !interactiveWaiting && !batchWaiting && free > interactiveKept;
+  }
+
+  return false;
+}
+
+int RequestScheduler::queueDepth() const
+{
+  QMutexLocker locker{&m_lock};
+
+  return m_queues[0].size() + m_queues[1].size() + m_queues[2].size();
+}
+
+void RequestScheduler::release(const PriorityClass cls)
+{
+  QMutexLocker locker{&m_lock};
+
+  m_running[IDX(cls)]--;
+  m_slotFreed.wakeAll();
+}
+
+int RequestScheduler::slotCount() const
+{
+  return m_slots;
+}
+
+RequestScheduler::WaitStats RequestScheduler::waitStats(const PriorityClass cls) const
+{
+  QMutexLocker locker{&m_lock};
+
+  return m_waitStats[IDX(cls)];
+}
@@ -0,0 +1,73 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include "serviceconfig.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <array>
+#include <deque>
+
+/*
+ * Limits the number of loads that are decoded concurrently and decides
+ * which waiting request gets a free decoding slot.
+ *
+ * Interactive requests are served ahead of anything else. Batch requests
+ * are guaranteed a minimum number of slots whenever they are waiting and
+ * a number of slots is kept free for interactive requests. Background
+ * requests run only when nobody else is waiting.
+ */
+class RequestScheduler {
+public:
+  enum class PriorityClass : int {
+    INTERACTIVE = 0,
+    BATCH = 1,
+    BACKGROUND = 2
+  };
+  static const int NUM_CLASSES = 3;
+
+  class WaitStats {
+  public:
+    quint64 requests;
+    quint64 totalWaitUs;
+    quint64 maxWaitUs;
+  };
+
+  /* Holds a decoding slot for the lifetime of the object */
+  class Slot {
+  public:
+    explicit Slot(RequestScheduler &scheduler, const PriorityClass cls);
+    ~Slot();
+
+    Slot(const Slot &) = delete;
+    Slot & operator=(const Slot &) = delete;
+
+  private:
+    RequestScheduler &h_scheduler;
+    const PriorityClass m_cls;
+  };
+
+  explicit RequestScheduler(const ServiceConfig::Scheduler &config);
+  int busySlots() const;
+  int queueDepth() const;
+  int slotCount() const;
+  WaitStats waitStats(const PriorityClass cls) const;
+
+private:
+  void acquire(const PriorityClass cls);
+  bool canRun(const PriorityClass cls, const quint64 ticket) const;
+  void release(const PriorityClass cls);
+
+  const int m_slots;
+  const int m_batchMinSlots;
+  const int m_interactiveReservedSlots;
+
+  mutable QMutex m_lock;
+  QWaitCondition m_slotFreed;
+  std::array<std::deque<quint64>, NUM_CLASSES> m_queues;
+  std::array<int, NUM_CLASSES> m_running;
+  std::array<WaitStats, NUM_CLASSES> m_waitStats;
+  quint64 m_nextTicket;
+};
+
+#endif // REQUESTSCHEDULER_H
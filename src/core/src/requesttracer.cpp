@@ -0,0 +1,197 @@
+#include "requesttracer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <cstring>
+
+static thread_local quint64 tl_requestId{0};
+
+RequestTracer::Span::Span(const char *name, const char *category) :
+  m_name{name},
+  m_category{category},
+  m_begin{-1}
+{
+  RequestTracer &tracer = RequestTracer::instance();
+
+  if (tracer.enabled())
+    m_begin = tracer.now();
+}
+
+RequestTracer::Span::~Span()
+{
+  stop();
+}
+
+void RequestTracer::Span::stop()
+{
+  if (m_begin < 0)
+    return;
+
+  RequestTracer &tracer = RequestTracer::instance();
+  tracer.record(m_name, m_category, nullptr, m_begin, tracer.now());
+  m_begin = -1;
+}
+
+RequestTracer::RequestScope::RequestScope(const quint64 requestId) :
+  m_previous{tl_requestId}
+{
+  tl_requestId = requestId;
+}
+
+RequestTracer::RequestScope::~RequestScope()
+{
+  tl_requestId = m_previous;
+}
+
+RequestTracer::RequestTracer(const ServiceConfig::Tracing &config) :
+  m_enabled{config.enabled && config.bufferEvents > 0},
+  m_capacity{static_cast<quint64>(m_enabled ? config.bufferEvents : 0)},
+  m_outputPath{config.outputPath.isEmpty() ?
+                 QDir{QDir::tempPath()}.filePath(QString{"edii-trace-%1.json"}.arg(QCoreApplication::applicationPid())) :
+                 config.outputPath},
+  m_epoch{std::chrono::steady_clock::now()},
+  m_next{0},
+  m_nextRequestId{1}
+{
+  if (!m_enabled)
+    return;
+
+  m_events = std::unique_ptr<Event[]>(new Event[m_capacity]);
+  for (quint64 idx = 0; idx < m_capacity; idx++)
+    m_events[idx].seq.store(0, std::memory_order_relaxed);
+}
+
+bool RequestTracer::enabled() const
+{
+  return m_enabled;
+}
+
+/*
+ * Writes the events that are currently in the buffer as a Chrome trace-event
+ * JSON file. Events that are being overwritten while the buffer is read are
+ * skipped. Returns the number of written events or -1 on error.
+ */
+qint64 RequestTracer::flush(QString &error)
+{
+  if (!m_enabled) {
+    error = "Tracing is disabled";
+    return -1;
+  }
+
+  QJsonArray events;
+  const qint64 pid = QCoreApplication::applicationPid();
+  const quint64 head = m_next.load(std::memory_order_acquire);
+  const quint64 first = head > m_capacity ? head - m_capacity : 0;
+
+  for (quint64 idx = first; idx < head; idx++) {
+    const Event &e = m_events[idx % m_capacity];
+
+    if (e.seq.load(std::memory_order_acquire) != idx + 1)
+      continue;
+    const char *name = e.name;
+    const char *category = e.category;
+    const qint64 begin = e.begin;
+    const qint64 duration = e.duration;
+    const quint64 requestId = e.requestId;
+    const int threadId = e.threadId;
+    char tag[sizeof(e.tag)];
+    std::memcpy(tag, e.tag, sizeof(tag));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (e.seq.load(std::memory_order_relaxed) != idx + 1)
+      continue;
+
+    QJsonObject args{ { "requestId", static_cast<qint64>(requestId) } };
+    if (tag[0] != '\0')
+      args.insert("tag", QString::fromUtf8(tag, qstrnlen(tag, sizeof(tag))));
+
+    /* Trace-event timestamps are in microseconds */
+    events.append(QJsonObject{
+      { "name", name },
+      { "cat", category },
+      { "ph", "X" },
+      { "ts", begin / 1000.0 },
+      { "dur", duration / 1000.0 },
+      { "pid", pid },
+      { "tid", threadId },
+      { "args", args }
+    });
+  }
+
+  const qint64 written = events.size();
+  const QByteArray json = QJsonDocument{QJsonObject{ { "traceEvents", events } }}.toJson(QJsonDocument::Compact);
+
+  QMutexLocker locker{&m_flushLock};
+
+  QSaveFile file{m_outputPath};
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = file.errorString();
+    return -1;
+  }
+  if (file.write(json) != json.size() || !file.commit()) {
+    error = file.errorString();
+    return -1;
+  }
+
+  return written;
+}
+
+RequestTracer & RequestTracer::instance()
+{
+  static RequestTracer tracer{ServiceConfig::instance().tracing};
+
+  return tracer;
+}
+
+quint64 RequestTracer::newRequestId()
+{
+  return m_nextRequestId.fetch_add(1, std::memory_order_relaxed);
+}
+
+qint64 RequestTracer::now() const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+const QString & RequestTracer::outputPath() const
+{
+  return m_outputPath;
+}
+
+void RequestTracer::record(const char *name, const char *category, const char *tag, const qint64 begin, const qint64 end)
+{
+  if (!m_enabled)
+    return;
+
+  const quint64 idx = m_next.fetch_add(1, std::memory_order_relaxed);
+  Event &e = m_events[idx % m_capacity];
+
+  /* Readers discard the event until its sequence number is published again */
+  e.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  e.name = name;
+  e.category = category;
+  if (tag != nullptr)
+    qstrncpy(e.tag, tag, sizeof(e.tag));
+  else
+    e.tag[0] = '\0';
+  e.begin = begin;
+  e.duration = end - begin;
+  e.requestId = tl_requestId;
+  e.threadId = threadId();
+
+  e.seq.store(idx + 1, std::memory_order_release);
+}
+
+/* Small sequential thread numbers are easier to read in trace viewers than native thread IDs */
+int RequestTracer::threadId()
+{
+  static std::atomic<int> nextId{1};
+  static thread_local const int id = nextId.fetch_add(1, std::memory_order_relaxed);
+
+  return id;
+}
@@ -0,0 +1,91 @@
+#ifndef REQUESTTRACER_H
+#define REQUESTTRACER_H
+
+#include "serviceconfig.h"
+
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/*
+ * Records begin and end of individual steps of request handling so that
+ * concurrent requests can be inspected in a trace viewer (chrome://tracing
+ * or Perfetto). Spans are written to a fixed-size ring buffer without
+ * locking; when the buffer is full the oldest spans are overwritten.
+ *
+ * Tracing is disabled unless enabled in the configuration. A disabled
+ * tracer costs one branch per span.
+ */
+class RequestTracer {
+public:
+  /* Measures a span and records it when it goes out of scope */
+  class Span {
+  public:
+    explicit Span(const char *name, const char *category = "request");
+    ~Span();
+
+    Span(const Span &) = delete;
+    Span & operator=(const Span &) = delete;
+
+    void stop();
+
+  private:
+    const char *const m_name;
+    const char *const m_category;
+    qint64 m_begin;
+  };
+
+  /* Marks spans recorded by the current thread as parts of a request */
+  class RequestScope {
+  public:
+    explicit RequestScope(const quint64 requestId);
+    ~RequestScope();
+
+    RequestScope(const RequestScope &) = delete;
+    RequestScope & operator=(const RequestScope &) = delete;
+
+  private:
+    const quint64 m_previous;
+  };
+
+  static RequestTracer & instance();
+
+  bool enabled() const;
+  qint64 flush(QString &error);
+  quint64 newRequestId();
+  qint64 now() const;
+  const QString & outputPath() const;
+  void record(const char *name, const char *category, const char *tag, const qint64 begin, const qint64 end);
+
+private:
+  class Event {
+  public:
+    /* Index of the event plus one once the event is complete, zero while it is being written */
+    std::atomic<quint64> seq;
+    const char *name;
+    const char *category;
+    char tag[16];
+    qint64 begin;
+    qint64 duration;
+    quint64 requestId;
+    int threadId;
+  };
+
+  explicit RequestTracer(const ServiceConfig::Tracing &config);
+
+  static int threadId();
+
+  const bool m_enabled;
+  const quint64 m_capacity;
+  const QString m_outputPath;
+  const std::chrono::steady_clock::time_point m_epoch;
+
+  std::unique_ptr<Event[]> m_events;
+  std::atomic<quint64> m_next;
+  std::atomic<quint64> m_nextRequestId;
+  QMutex m_flushLock;
+};
+
+#endif // REQUESTTRACER_H
@@ -0,0 +1,181 @@
+#include "serviceconfig.h"
+
+#include <QSettings>
+
+#define CONFIG_ORGANIZATION "ECHMET"
+#define CONFIG_APPLICATION "EDII"
+
+static
+ServiceConfig::Prefetch readPrefetch(QSettings &s)
+{
+  s.beginGroup("Prefetch");
+  ServiceConfig::Prefetch p{
+    s.value("Enabled", false).toBool(),
+    s.value("IOBudget", 256LL << 20).toLongLong(),
+    s.value("IORate", 64LL << 20).toLongLong(),
+    s.value("MemoryBudget", 64LL << 20).toLongLong(),
+    s.value("MaxFiles", 100).toInt()
+  };
+  s.endGroup();
+
+  return p;
+}
+
+static
+ServiceConfig::DecodeCache readDecodeCache(QSettings &s)
+{
+  s.beginGroup("DecodeCache");
+  ServiceConfig::DecodeCache c{
+    s.value("Capacity", 128LL << 20).toLongLong()
+  };
+  s.endGroup();
+
+  return c;
+}
+
+static
+ServiceConfig::Scheduler readScheduler(QSettings &s)
+{
+  s.beginGroup("Scheduler");
+  ServiceConfig::Scheduler sch{
+    s.value("DecodeSlots", 10).toInt(),
+    s.value("BatchMinShare", 20).toInt(),
+    s.value("InteractiveReservedSlots", 1).toInt(),
+    s.value("SendWindow", 4LL << 20).toLongLong()
+  };
+  s.endGroup();
+
+  return sch;
+}
+
+static
+ServiceConfig::WorkerPool readWorkerPool(QSettings &s)
+{
+  /* Older configurations set the size of the pool in the scheduler group */
+  const int legacyThreads = s.value("Scheduler/IOThreads", 0).toInt();
+
+  s.beginGroup("WorkerPool");
+  ServiceConfig::WorkerPool wp{
+    s.value("Threads", legacyThreads).toInt(),
+    s.value("MaxThreads", 0).toInt(),
+    s.value("Adaptive", false).toBool(),
+    s.value("QueueLimit", 256).toInt(),
+    s.value("MaxRequestsPerClient", 16).toInt()
+  };
+  s.endGroup();
+
+  return wp;
+}
+
+static
+ServiceConfig::Tracing readTracing(QSettings &s)
+{
+  s.beginGroup("Tracing");
+  ServiceConfig::Tracing t{
+    s.value("Enabled", false).toBool(),
+    s.value("BufferEvents", 1 << 16).toInt(),
+    s.value("OutputPath", QString{}).toString()
+  };
+  s.endGroup();
+
+  return t;
+}
+
+static
+ServiceConfig::TailFollow readTailFollow(QSettings &s)
+{
+  s.beginGroup("TailFollow");
+  ServiceConfig::TailFollow t{
+    s.value("MaxCheckpoints", 64).toInt()
+  };
+  s.endGroup();
+
+  return t;
+}
+
+static
+QVector<ServiceConfig::Folder> readFolders(QSettings &s)
+{
+  QVector<ServiceConfig::Folder> folders;
+
+  const int size = s.beginReadArray("Folders");
+  for (int idx = 0; idx < size; idx++) {
+    s.setArrayIndex(idx);
+    folders.append({
+      s.value("Path").toString(),
+      s.value("Tag").toString(),
+      s.value("Filter", "*").toString().split(';', Qt::SkipEmptyParts)
+    });
+  }
+  s.endArray();
+
+  return folders;
+}
+
+static
+ServiceConfig::WatchFolders readWatchFolders(QSettings &s)
+{
+  s.beginGroup("WatchFolders");
+  const bool enabled = s.value("Enabled", false).toBool();
+  const int settleTime = s.value("SettleTime", 10000).toInt();
+  const QVector<ServiceConfig::Folder> folders = readFolders(s);
+  s.endGroup();
+
+  return {enabled, settleTime, folders};
+}
+
+static
+ServiceConfig::Catalog readCatalog(QSettings &s)
+{
+  s.beginGroup("Catalog");
+  const bool enabled = s.value("Enabled", false).toBool();
+  const QString indexPath = s.value("IndexPath", QString{}).toString();
+  const int refreshInterval = s.value("RefreshInterval", 3600).toInt();
+  const QVector<ServiceConfig::Folder> folders = readFolders(s);
+  s.endGroup();
+
+  return {enabled, indexPath, refreshInterval, folders};
+}
+
+static
+ServiceConfig::Subscriptions readSubscriptions(QSettings &s)
+{
+  s.beginGroup("Subscriptions");
+  ServiceConfig::Subscriptions sub{
+    s.value("Enabled", true).toBool(),
+    s.value("CoalesceTime", 200).toInt(),
+    s.value("MaxDelay", 1000).toInt(),
+    s.value("MaxPerClient", 64).toInt()
+  };
+  s.endGroup();
+
+  return sub;
+}
+
+ServiceConfig::ServiceConfig(QSettings &settings) :
+  prefetch(readPrefetch(settings)),
+  decodeCache(readDecodeCache(settings)),
+  scheduler(readScheduler(settings)),
+  workerPool(readWorkerPool(settings)),
+  tracing(readTracing(settings)),
+  tailFollow(readTailFollow(settings)),
+  watchFolders(readWatchFolders(settings)),
+  catalog(readCatalog(settings)),
+  subscriptions(readSubscriptions(settings))
+{
+}
+
+/*
+ * Configuration is read from the INI file in the user's configuration
+ * directory (e.g. ~/.config/ECHMET/EDII.ini) once, when it is first needed.
+ */
+const ServiceConfig & ServiceConfig::instance()
+{
+  static const ServiceConfig config = []() {
+    QSettings settings{QSettings::IniFormat, QSettings::UserScope, CONFIG_ORGANIZATION, CONFIG_APPLICATION};
+
+    return ServiceConfig{settings};
+  }();
+
+  return config;
+}
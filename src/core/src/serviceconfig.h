@@ -0,0 +1,101 @@
+#ifndef SERVICECONFIG_H
+#define SERVICECONFIG_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QSettings;
+
+class ServiceConfig {
+public:
+  class Prefetch {
+  public:
+    const bool enabled;
+    const qint64 ioBudget;        /* Maximum number of bytes read ahead per hint */
+    const qint64 ioRate;          /* Maximum read-ahead throughput in bytes per second */
+    const qint64 memoryBudget;    /* Maximum size of decoded data stored in the decode cache per hint */
+    const int maxFiles;
+  };
+
+  class DecodeCache {
+  public:
+    const qint64 capacity;        /* Size of the decode cache in bytes, zero disables the cache */
+  };
+
+  class Scheduler {
+  public:
+    const int decodeSlots;              /* Maximum number of loads decoded at the same time */
+    const int batchMinShare;            /* Percentage of decode slots guaranteed to batch requests */
+    const int interactiveReservedSlots; /* Decode slots that only interactive requests may use */
+    const qint64 sendWindow;            /* Bytes of a response that may wait for the client to read them */
+  };
+
+  class WorkerPool {
+  public:
+    const int threads;                  /* Number of threads that handle local socket requests, zero derives it from the number of cores */
+    const int maxThreads;               /* Upper bound of adaptive sizing, zero derives it from the number of cores */
+    const bool adaptive;                /* Resize the pool according to the share of time workers spend on CPU */
+    const int queueLimit;               /* Requests that may wait for a thread, zero does not limit them */
+    const int perClientLimit;           /* Requests of one client that may be queued or handled, zero does not limit them */
+  };
+
+  class Tracing {
+  public:
+    const bool enabled;
+    const int bufferEvents;             /* Number of most recent spans kept in memory */
+    const QString outputPath;           /* Trace file, empty selects a file in the temporary directory */
+  };
+
+  class TailFollow {
+  public:
+    const int maxCheckpoints;           /* Number of most recently used checkpoints of growing files that are kept */
+  };
+
+  class Folder {
+  public:
+    QString path;
+    QString tag;                        /* Plugin that decodes files from this folder */
+    QStringList nameFilters;            /* Files that do not match any of the filters are ignored */
+  };
+
+  class WatchFolders {
+  public:
+    const bool enabled;
+    const int settleTime;               /* Milliseconds a file must stay unchanged before it is ingested */
+    const QVector<Folder> folders;
+  };
+
+  class Catalog {
+  public:
+    const bool enabled;
+    const QString indexPath;            /* Index file, empty selects a file in the user's cache directory */
+    const int refreshInterval;          /* Seconds between rescans of the folders, zero scans only at startup */
+    const QVector<Folder> folders;      /* Folders are scanned recursively */
+  };
+
+  class Subscriptions {
+  public:
+    const bool enabled;
+    const int coalesceTime;             /* Milliseconds a file must stay quiet before its change is reported */
+    const int maxDelay;                 /* Milliseconds after which a change is reported even if the file keeps changing */
+    const int maxPerClient;             /* Subscriptions of one connection or D-Bus client, zero does not limit them */
+  };
+
+  static const ServiceConfig & instance();
+
+  const Prefetch prefetch;
+  const DecodeCache decodeCache;
+  const Scheduler scheduler;
+  const WorkerPool workerPool;
+  const Tracing tracing;
+  const TailFollow tailFollow;
+  const WatchFolders watchFolders;
+  const Catalog catalog;
+  const Subscriptions subscriptions;
+
+private:
+  explicit ServiceConfig(QSettings &settings);
+};
+
+#endif // SERVICECONFIG_H
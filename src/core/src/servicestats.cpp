@@ -0,0 +1,233 @@
+#include "servicestats.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <cstring>
+
+static const char * STAGE_NAMES[plugin::NUM_LOAD_STAGES] = {
+  "fileIO",
+  "textDecoding",
+  "parsing",
+  "packaging",
+  "serialization",
+  "socketWrite",
+  "total"
+};
+
+static
+int histogramBucket(const qint64 nsecs)
+{
+  quint64 usecs = nsecs / 1000;
+  int bucket = 0;
+
+  while (usecs > 0 && bucket < ServiceStats::HISTOGRAM_BUCKETS - 1) {
+    usecs >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+ServiceStats::StageStats::StageStats() :
+  count{0},
+  totalNs{0},
+  maxNs{0}
+{
+  for (auto &b : histogram)
+    b.store(0);
+}
+
+void ServiceStats::StageStats::record(const qint64 nsecs)
+{
+  const quint64 ns = nsecs > 0 ? nsecs : 0;
+
+  count.fetch_add(1, std::memory_order_relaxed);
+  totalNs.fetch_add(ns, std::memory_order_relaxed);
+  histogram[histogramBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+
+  quint64 max = maxNs.load(std::memory_order_relaxed);
+  while (ns > max && !maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed));
+}
+
+QJsonObject ServiceStats::StageStats::toJson() const
+{
+  QJsonArray hist;
+  int last = HISTOGRAM_BUCKETS - 1;
+
+  /* Trailing empty buckets are not worth sending */
+  while (last >= 0 && histogram[last].load(std::memory_order_relaxed) == 0)
+    last--;
+  for (int idx = 0; idx <= last; idx++)
+    hist.append(static_cast<qint64>(histogram[idx].load(std::memory_order_relaxed)));
+
+  return QJsonObject{
+    { "count", static_cast<qint64>(count.load(std::memory_order_relaxed)) },
+    { "totalNs", static_cast<qint64>(totalNs.load(std::memory_order_relaxed)) },
+    { "maxNs", static_cast<qint64>(maxNs.load(std::memory_order_relaxed)) },
+    { "histogramLog2Us", hist }
+  };
+}
+
+ServiceStats::MemoryStats::MemoryStats() :
+  requests{0},
+  maxPeakBytes{0}
+{
+  recentPeakBytes.fill(0);
+  recentAllocations.fill(0);
+}
+
+void ServiceStats::MemoryStats::record(const qint64 peakBytes, const qint64 allocations)
+{
+  QMutexLocker locker{&lock};
+
+  const int idx = requests % WINDOW;
+  recentPeakBytes[idx] = peakBytes;
+  recentAllocations[idx] = allocations;
+  maxPeakBytes = std::max(maxPeakBytes, peakBytes);
+  requests++;
+}
+
+QJsonObject ServiceStats::MemoryStats::toJson() const
+{
+  QMutexLocker locker{&lock};
+
+  const int n = static_cast<int>(std::min<quint64>(requests, WINDOW));
+  std::vector<qint64> peaks(recentPeakBytes.cbegin(), recentPeakBytes.cbegin() + n);
+  qint64 allocations = 0;
+  for (int idx = 0; idx < n; idx++)
+    allocations += recentAllocations[idx];
+  std::sort(peaks.begin(), peaks.end());
+
+  auto percentile = [&peaks](const int p) -> qint64 {
+    if (peaks.empty())
+      return 0;
+    return peaks[(peaks.size() - 1) * p / 100];
+  };
+
+  return QJsonObject{
+    { "requests", static_cast<qint64>(requests) },
+    { "peakBytesMax", maxPeakBytes },
+    { "recentRequests", n },
+    { "recentPeakBytesP50", percentile(50) },
+    { "recentPeakBytesP95", percentile(95) },
+    { "recentPeakBytesMax", peaks.empty() ? 0 : peaks.back() },
+    { "recentAllocationsMean", n > 0 ? allocations / n : 0 }
+  };
+}
+
+ServiceStats::ServiceStats() :
+  m_bytesServed{0},
+  m_startedAt{QDateTime::currentMSecsSinceEpoch()},
+  m_nextProviderId{0}
+{
+}
+
+void ServiceStats::addBytesServed(const qint64 bytes)
+{
+  m_bytesServed.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+int ServiceStats::addProvider(const QString &name, Provider provider)
+{
+  QMutexLocker locker{&m_providersLock};
+
+  const int id = m_nextProviderId++;
+  m_providers.insert(id, {name, std::move(provider)});
+
+  return id;
+}
+
+ServiceStats & ServiceStats::instance()
+{
+  static ServiceStats stats{};
+
+  return stats;
+}
+
+void ServiceStats::recordMemory(const QString &tag, const qint64 peakBytes, const qint64 allocations)
+{
+  const std::string stdTag = tag.toStdString();
+
+  for (auto &ts : m_tags) {
+    if (ts->tag == stdTag) {
+      ts->memory.record(peakBytes, allocations);
+      return;
+    }
+  }
+}
+
+void ServiceStats::recordStage(const char *tag, const int stage, const qint64 nsecs)
+{
+  if (tag == nullptr || stage < 0 || stage >= plugin::NUM_LOAD_STAGES)
+    return;
+
+  for (auto &ts : m_tags) {
+    if (std::strcmp(ts->tag.c_str(), tag) == 0) {
+      ts->stages[stage].record(nsecs);
+      return;
+    }
+  }
+}
+
+void ServiceStats::registerTag(const QString &tag)
+{
+  const std::string stdTag = tag.toStdString();
+
+  for (const auto &ts : m_tags) {
+    if (ts->tag == stdTag)
+      return;
+  }
+
+  auto ts = std::make_unique<TagStats>();
+  ts->tag = stdTag;
+  m_tags.emplace_back(std::move(ts));
+}
+
+void ServiceStats::removeProvider(const int id)
+{
+  QMutexLocker locker{&m_providersLock};
+
+  m_providers.remove(id);
+}
+
+const char * ServiceStats::stageName(const int stage)
+{
+  if (stage < 0 || stage >= plugin::NUM_LOAD_STAGES)
+    return "unknown";
+
+  return STAGE_NAMES[stage];
+}
+
+QByteArray ServiceStats::toJson() const
+{
+  QJsonObject root;
+  QJsonObject stages;
+  QJsonObject memory;
+
+  for (const auto &ts : m_tags) {
+    QJsonObject tagObj;
+
+    for (int idx = 0; idx < plugin::NUM_LOAD_STAGES; idx++) {
+      if (ts->stages[idx].count.load(std::memory_order_relaxed) > 0)
+        tagObj.insert(STAGE_NAMES[idx], ts->stages[idx].toJson());
+    }
+    stages.insert(QString::fromStdString(ts->tag), tagObj);
+
+    const QJsonObject memObj = ts->memory.toJson();
+    if (memObj.value("requests").toInteger() > 0)
+      memory.insert(QString::fromStdString(ts->tag), memObj);
+  }
+
+  root.insert("uptimeMs", QDateTime::currentMSecsSinceEpoch() - m_startedAt);
+  root.insert("bytesServed", static_cast<qint64>(m_bytesServed.load(std::memory_order_relaxed)));
+  root.insert("stages", stages);
+  root.insert("memory", memory);
+
+  QMutexLocker locker{&m_providersLock};
+  for (const auto &p : m_providers)
+    root.insert(p.first, p.second());
+
+  return QJsonDocument{root}.toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,90 @@
+#ifndef SERVICESTATS_H
+#define SERVICESTATS_H
+
+#include <plugins/stagetimer.h>
+
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Collects timing of individual stages of data loads and other counters
+ * of the service. Recording is lock-free so that it can be done from any
+ * thread without slowing the loads down.
+ */
+class ServiceStats {
+public:
+  /* Bucket N counts durations shorter than 2^N microseconds that do not fit in bucket N - 1 */
+  static const int HISTOGRAM_BUCKETS = 32;
+
+  class StageStats {
+  public:
+    StageStats();
+    void record(const qint64 nsecs);
+    QJsonObject toJson() const;
+
+    std::atomic<quint64> count;
+    std::atomic<quint64> totalNs;
+    std::atomic<quint64> maxNs;
+    std::array<std::atomic<quint64>, HISTOGRAM_BUCKETS> histogram;
+  };
+
+  /* Summary of memory used by recent requests, see MemoryAccount */
+  class MemoryStats {
+  public:
+    static const int WINDOW = 128;
+
+    MemoryStats();
+    void record(const qint64 peakBytes, const qint64 allocations);
+    QJsonObject toJson() const;
+
+    mutable QMutex lock;
+    quint64 requests;
+    qint64 maxPeakBytes;
+    std::array<qint64, WINDOW> recentPeakBytes;
+    std::array<qint64, WINDOW> recentAllocations;
+  };
+
+  /* Returns current values of counters owned by other components */
+  typedef std::function<QJsonObject ()> Provider;
+
+  static ServiceStats & instance();
+
+  void addBytesServed(const qint64 bytes);
+  int addProvider(const QString &name, Provider provider);
+  void recordMemory(const QString &tag, const qint64 peakBytes, const qint64 allocations);
+  void recordStage(const char *tag, const int stage, const qint64 nsecs);
+  void registerTag(const QString &tag);
+  void removeProvider(const int id);
+  QByteArray toJson() const;
+
+  static const char * stageName(const int stage);
+
+private:
+  class TagStats {
+  public:
+    std::string tag;
+    std::array<StageStats, plugin::NUM_LOAD_STAGES> stages;
+    MemoryStats memory;
+  };
+
+  explicit ServiceStats();
+
+  /* Tags are registered when plugins are loaded and never change afterwards */
+  std::vector<std::unique_ptr<TagStats>> m_tags;
+  std::atomic<quint64> m_bytesServed;
+  const qint64 m_startedAt;
+
+  mutable QMutex m_providersLock;
+  QMap<int, std::pair<QString, Provider>> m_providers;
+  int m_nextProviderId;
+};
+
+#endif // SERVICESTATS_H
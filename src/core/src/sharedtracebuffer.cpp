@@ -0,0 +1,137 @@
+#include "sharedtracebuffer.h"
+#include "dataloader.h"
+
+#include <QHash>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif // Q_OS_LINUX
+
+/* Arrays start at offsets aligned for any vector load of the client */
+#define ARRAY_ALIGNMENT 64
+
+static
+quint64 align(const quint64 offset)
+{
+  return (offset + ARRAY_ALIGNMENT - 1) & ~static_cast<quint64>(ARRAY_ALIGNMENT - 1);
+}
+
+SharedTraceBuffer::SharedTraceBuffer() :
+  m_fd{-1},
+  m_size{0}
+{
+}
+
+SharedTraceBuffer::~SharedTraceBuffer()
+{
+#ifdef Q_OS_LINUX
+  if (m_fd >= 0)
+    ::close(m_fd);
+#endif // Q_OS_LINUX
+}
+
+bool SharedTraceBuffer::build(const std::vector<Data> &data, QString &error)
+{
+#ifdef Q_OS_LINUX
+  QHash<const double *, quint64> axes;
+  quint64 size = 0;
+
+  m_placements.clear();
+  m_placements.reserve(data.size());
+
+  for (const auto &item : data) {
+    Placement p;
+
+    const auto it = axes.constFind(item.xValues.constData());
+    if (it != axes.cend()) {
+      p.xOffset = *it;
+    } else {
+      p.xOffset = size;
+      axes.insert(item.xValues.constData(), p.xOffset);
+      size = align(size + sizeof(double) * item.xValues.size());
+    }
+    p.yOffset = size;
+    size = align(size + sizeof(double) * item.yValues.size());
+
+    m_placements.push_back(p);
+  }
+
+  const int fd = ::memfd_create("edii-traces", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    error = QString{"Cannot create shared memory file: %1"}.arg(std::strerror(errno));
+    return false;
+  }
+
+  if (size > 0) {
+    if (::ftruncate(fd, size) < 0) {
+      error = QString{"Cannot resize shared memory file: %1"}.arg(std::strerror(errno));
+      ::close(fd);
+      return false;
+    }
+
+    char *mem = static_cast<char *>(::mmap(nullptr, size, PROT_WRITE, MAP_SHARED, fd, 0));
+    if (mem == MAP_FAILED) {
+      error = QString{"Cannot map shared memory file: %1"}.arg(std::strerror(errno));
+      ::close(fd);
+      return false;
+    }
+
+    for (size_t idx = 0; idx < data.size(); idx++) {
+      const auto &item = data[idx];
+      const auto &p = m_placements[idx];
+
+      std::memcpy(mem + p.xOffset, item.xValues.constData(), sizeof(double) * item.xValues.size());
+      std::memcpy(mem + p.yOffset, item.yValues.constData(), sizeof(double) * item.yValues.size());
+    }
+
+    ::munmap(mem, size);
+  }
+
+  /* The client gets a snapshot that neither side can change afterwards */
+  if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+    error = QString{"Cannot seal shared memory file: %1"}.arg(std::strerror(errno));
+    ::close(fd);
+    return false;
+  }
+
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = fd;
+  m_size = size;
+
+  return true;
+#else
+  Q_UNUSED(data);
+
+  error = "Shared memory transfers are not supported on this platform";
+  return false;
+#endif // Q_OS_LINUX
+}
+
+int SharedTraceBuffer::fd() const
+{
+  return m_fd;
+}
+
+bool SharedTraceBuffer::isSupported()
+{
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif // Q_OS_LINUX
+}
+
+const std::vector<SharedTraceBuffer::Placement> & SharedTraceBuffer::placements() const
+{
+  return m_placements;
+}
+
+quint64 SharedTraceBuffer::size() const
+{
+  return m_size;
+}
@@ -0,0 +1,44 @@
+#ifndef SHAREDTRACEBUFFER_H
+#define SHAREDTRACEBUFFER_H
+
+#include <QString>
+#include <vector>
+
+class Data;
+
+/*
+ * Places the X and Y values of a loaded pack into an anonymous sealed
+ * memory file that can be handed over to a local client as a file
+ * descriptor. The client maps the file and reads the values in place
+ * instead of receiving them through the socket. Traces that share
+ * their X values share the X array in the file too.
+ *
+ * Only Linux provides sealed memory files, build() fails elsewhere.
+ */
+class SharedTraceBuffer {
+public:
+  class Placement {
+  public:
+    quint64 xOffset;
+    quint64 yOffset;
+  };
+
+  explicit SharedTraceBuffer();
+  SharedTraceBuffer(const SharedTraceBuffer &other) = delete;
+  ~SharedTraceBuffer();
+  bool build(const std::vector<Data> &data, QString &error);
+  int fd() const;
+  const std::vector<Placement> & placements() const;
+  quint64 size() const;
+
+  SharedTraceBuffer & operator=(const SharedTraceBuffer &other) = delete;
+
+  static bool isSupported();
+
+private:
+  int m_fd;
+  quint64 m_size;
+  std::vector<Placement> m_placements;
+};
+
+#endif // SHAREDTRACEBUFFER_H
@@ -0,0 +1,70 @@
+#include "tailcheckpointstore.h"
+
+#include <QFileInfo>
+#include <QRandomGenerator>
+
+TailCheckpointStore::TailCheckpointStore(const int capacity) :
+  m_capacity{capacity > 0 ? capacity : 1},
+  m_resumed{0},
+  m_unknown{0}
+{
+  /* Cursors handed out before a restart of EDII must not match any new checkpoint */
+  m_nextCursor = QRandomGenerator::global()->generate64() >> 1;
+  if (m_nextCursor == 0)
+    m_nextCursor = 1;
+}
+
+/* Returns nullptr if the cursor is unknown, was evicted or belongs to a different file */
+TailCheckpointStore::Checkpoint TailCheckpointStore::get(const quint64 cursor, const QString &formatTag, const QString &path, const int mode)
+{
+  const QString key = makeKey(formatTag, path, mode);
+  QMutexLocker locker{&m_lock};
+
+  const auto it = m_entries.find(cursor);
+  if (it == m_entries.end() || it->key != key) {
+    m_unknown++;
+    return nullptr;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, it->lruPos);
+  m_resumed++;
+
+  return it->checkpoint;
+}
+
+quint64 TailCheckpointStore::insert(const QString &formatTag, const QString &path, const int mode, Checkpoint checkpoint)
+{
+  const QString key = makeKey(formatTag, path, mode);
+  QMutexLocker locker{&m_lock};
+
+  const quint64 cursor = m_nextCursor++;
+  if (m_nextCursor == 0)
+    m_nextCursor = 1;
+
+  m_lru.push_front(cursor);
+  m_entries.insert(cursor, Entry{key, std::move(checkpoint), m_lru.begin()});
+
+  while (m_entries.size() > m_capacity) {
+    m_entries.remove(m_lru.back());
+    m_lru.pop_back();
+  }
+
+  return cursor;
+}
+
+QString TailCheckpointStore::makeKey(const QString &formatTag, const QString &path, const int mode)
+{
+  return QString{"%1|%2|%3"}.arg(formatTag).arg(mode).arg(QFileInfo{path}.absoluteFilePath());
+}
+
+QJsonObject TailCheckpointStore::statsJson()
+{
+  QMutexLocker locker{&m_lock};
+
+  return QJsonObject{
+    { "capacity", m_capacity },
+    { "checkpoints", m_entries.size() },
+    { "resumed", static_cast<qint64>(m_resumed.load()) },
+    { "unknownCursors", static_cast<qint64>(m_unknown.load()) }
+  };
+}
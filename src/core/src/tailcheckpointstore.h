@@ -0,0 +1,48 @@
+#ifndef TAILCHECKPOINTSTORE_H
+#define TAILCHECKPOINTSTORE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <plugins/plugininterface.h>
+
+/*
+ * Keeps checkpoints of files that clients read incrementally while they grow.
+ * Each checkpoint is identified by a cursor that is handed to the client and
+ * passed back with the next request. Checkpoints are immutable so a client
+ * may repeat a request with the same cursor. Least recently used checkpoints
+ * are discarded once there are more than the configured maximum.
+ */
+class TailCheckpointStore {
+public:
+  typedef std::shared_ptr<const plugin::TailCheckpoint> Checkpoint;
+
+  explicit TailCheckpointStore(const int capacity);
+  Checkpoint get(const quint64 cursor, const QString &formatTag, const QString &path, const int mode);
+  quint64 insert(const QString &formatTag, const QString &path, const int mode, Checkpoint checkpoint);
+  QJsonObject statsJson();
+
+private:
+  class Entry {
+  public:
+    QString key;
+    Checkpoint checkpoint;
+    std::list<quint64>::iterator lruPos;
+  };
+
+  static QString makeKey(const QString &formatTag, const QString &path, const int mode);
+
+  const int m_capacity;
+  quint64 m_nextCursor;
+  std::atomic<quint64> m_resumed;
+  std::atomic<quint64> m_unknown;
+
+  QHash<quint64, Entry> m_entries;
+  std::list<quint64> m_lru;
+  QMutex m_lock;
+};
+
+#endif // TAILCHECKPOINTSTORE_H
@@ -0,0 +1,145 @@
+#include "tracecache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSet>
+
+TraceCache::FileStamp TraceCache::FileStamp::of(const QString &path)
+{
+  const QFileInfo fi{path};
+
+  if (!fi.exists() || !fi.isFile())
+    return { 0, 0, false };
+
+  return { fi.size(), fi.lastModified().toMSecsSinceEpoch(), true };
+}
+
+bool TraceCache::FileStamp::operator==(const FileStamp &other) const
+{
+  return valid && other.valid &&
+         size == other.size &&
+         modified == other.modified;
+}
+
+TraceCache::TraceCache(const qint64 capacity) :
+  m_capacity{capacity},
+  m_size{0},
+  m_hits{0},
+  m_misses{0}
+{
+}
+
+bool TraceCache::contains(const QString &formatTag, const QString &path, const int mode, const FileStamp &stamp)
+{
+  QMutexLocker locker{&m_lock};
+
+  const auto it = m_entries.constFind(makeKey(formatTag, path, mode));
+  if (it == m_entries.cend())
+    return false;
+
+  return it->stamp == stamp;
+}
+
+qint64 TraceCache::dataSize(const std::vector<Data> &data)
+{
+  /* Shared X axes are accounted for only once */
+  QSet<const double *> axes;
+  qint64 size = 0;
+
+  for (const auto &d : data) {
+    if (!axes.contains(d.xValues.constData())) {
+      axes.insert(d.xValues.constData());
+      size += d.xValues.size() * sizeof(double);
+    }
+    size += d.yValues.size() * sizeof(double);
+  }
+
+  return size;
+}
+
+bool TraceCache::enabled() const
+{
+  return m_capacity > 0;
+}
+
+void TraceCache::evict()
+{
+  while (m_size > m_capacity && !m_lru.empty()) {
+    const auto it = m_entries.find(m_lru.back());
+
+    m_size -= it->size;
+    m_entries.erase(it);
+    m_lru.pop_back();
+  }
+}
+
+std::shared_ptr<const std::vector<Data>> TraceCache::get(const QString &formatTag, const QString &path, const int mode)
+{
+  const FileStamp stamp = FileStamp::of(path);
+  QMutexLocker locker{&m_lock};
+
+  const auto it = m_entries.find(makeKey(formatTag, path, mode));
+  if (it == m_entries.end()) {
+    m_misses++;
+    return nullptr;
+  }
+
+  if (!(it->stamp == stamp)) {
+    m_size -= it->size;
+    m_lru.erase(it->lruPos);
+    m_entries.erase(it);
+    m_misses++;
+    return nullptr;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, it->lruPos);
+  m_hits++;
+
+  return it->data;
+}
+
+qint64 TraceCache::insert(const QString &formatTag, const QString &path, const int mode, const FileStamp &stamp, const std::vector<Data> &data)
+{
+  if (!enabled() || !stamp.valid)
+    return 0;
+
+  const qint64 size = dataSize(data);
+  if (size > m_capacity)
+    return 0;
+
+  const QString key = makeKey(formatTag, path, mode);
+  QMutexLocker locker{&m_lock};
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    m_size -= it->size;
+    m_lru.erase(it->lruPos);
+    m_entries.erase(it);
+  }
+
+  m_lru.push_front(key);
+  m_entries.insert(key, Entry{stamp, std::make_shared<const std::vector<Data>>(data), size, m_lru.begin()});
+  m_size += size;
+
+  evict();
+
+  return size;
+}
+
+QJsonObject TraceCache::statsJson()
+{
+  QMutexLocker locker{&m_lock};
+
+  return QJsonObject{
+    { "capacity", m_capacity },
+    { "size", m_size },
+    { "entries", m_entries.size() },
+    { "hits", static_cast<qint64>(m_hits.load()) },
+    { "misses", static_cast<qint64>(m_misses.load()) }
+  };
+}
+
+QString TraceCache::makeKey(const QString &formatTag, const QString &path, const int mode)
+{
+  return QString{"%1|%2|%3"}.arg(formatTag).arg(mode).arg(QFileInfo{path}.absoluteFilePath());
+}
@@ -0,0 +1,63 @@
+#ifndef TRACECACHE_H
+#define TRACECACHE_H
+
+#include "dataloader.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <atomic>
+#include <list>
+#include <memory>
+
+/*
+ * Keeps decoded data of recently loaded files. An entry is valid only
+ * while size and modification time of the source file stay the same.
+ * Least recently used entries are discarded once the total size of
+ * cached data exceeds the capacity.
+ */
+class TraceCache {
+public:
+  class FileStamp {
+  public:
+    static FileStamp of(const QString &path);
+
+    bool operator==(const FileStamp &other) const;
+
+    qint64 size;
+    qint64 modified;
+    bool valid;
+  };
+
+  explicit TraceCache(const qint64 capacity);
+  bool contains(const QString &formatTag, const QString &path, const int mode, const FileStamp &stamp);
+  bool enabled() const;
+  std::shared_ptr<const std::vector<Data>> get(const QString &formatTag, const QString &path, const int mode);
+  qint64 insert(const QString &formatTag, const QString &path, const int mode, const FileStamp &stamp, const std::vector<Data> &data);
+  QJsonObject statsJson();
+
+  static qint64 dataSize(const std::vector<Data> &data);
+
+private:
+  class Entry {
+  public:
+    FileStamp stamp;
+    std::shared_ptr<const std::vector<Data>> data;
+    qint64 size;
+    std::list<QString>::iterator lruPos;
+  };
+
+  void evict();
+  static QString makeKey(const QString &formatTag, const QString &path, const int mode);
+
+  const qint64 m_capacity;
+  qint64 m_size;
+  std::atomic<quint64> m_hits;
+  std::atomic<quint64> m_misses;
+
+  QHash<QString, Entry> m_entries;
+  std::list<QString> m_lru;
+  QMutex m_lock;
+};
+
+#endif // TRACECACHE_H
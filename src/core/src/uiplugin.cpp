@@ -1,5 +1,7 @@
 #include <plugins/uiplugin.h>
 #include <plugins/threadeddialog.h>
+#include "requesttracer.h"
+#include "servicestats.h"
 
 UIPlugin *UIPlugin::s_me{nullptr};
 
@@ -31,3 +33,16 @@ void UIPlugin::display(ThreadedDialogBase *disp)
   disp->process();
   disp->m_barrier.wakeAll();
 }
+
+void UIPlugin::reportStageTime(const char *tag, const int stage, const qint64 nsecs)
+{
+  ServiceStats::instance().recordStage(tag, stage, nsecs);
+
+  RequestTracer &tracer = RequestTracer::instance();
+  if (tracer.enabled()) {
+    /* Stages are reported when they end */
+    const qint64 end = tracer.now();
+    tracer.record(ServiceStats::stageName(stage), stage <= static_cast<int>(plugin::LoadStage::PARSING) ? "plugin" : "core",
+                  tag, end - nsecs, end);
+  }
+}
@@ -0,0 +1,193 @@
+#include "workerpool.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+
+#if defined(Q_OS_UNIX) || defined(Q_OS_LINUX)
+  #include <time.h>
+#elif defined Q_OS_WIN
+  #include <windows.h>
+#endif // Q_OS_
+
+/* Interval between resizes of an adaptive pool */
+#define ADAPT_INTERVAL_MS 1000
+/* Workers that hardly use CPU do not get more than this many threads per core */
+#define MIN_CPU_SHARE 0.02
+/* Weight of the last request in the moving average of request durations */
+#define TASK_TIME_WEIGHT (1.0 / 16.0)
+#define MIN_RETRY_AFTER_MS 10
+#define MAX_RETRY_AFTER_MS 10000
+
+/* Returns CPU time consumed by the calling thread in nanoseconds or -1 if it cannot be measured */
+static
+qint64 threadCpuTime()
+{
+#if defined(Q_OS_UNIX) || defined(Q_OS_LINUX)
+  struct timespec ts;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return -1;
+  return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#elif defined Q_OS_WIN
+  FILETIME creation, exit, kernel, user;
+
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+    return -1;
+
+  const auto ticks = [](const FILETIME &ft) {
+    return (static_cast<qint64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+  };
+  return (ticks(kernel) + ticks(user)) * 100;
+#else
+  return -1;
+#endif // Q_OS_
+}
+
+WorkerPool::WorkerPool(const ServiceConfig::WorkerPool &config, const int minThreads) :
+  m_cores{std::max(1, QThread::idealThreadCount())},
+  m_minThreads{std::max(1, minThreads)},
+  m_maxThreads{std::max({m_minThreads, config.threads, config.maxThreads > 0 ? config.maxThreads : 8 * m_cores})},
+  m_adaptive{config.adaptive},
+  m_queueLimit{std::max(0, config.queueLimit)},
+  m_perClientLimit{std::max(0, config.perClientLimit)},
+  m_queued{0},
+  m_refused{0},
+  m_meanTaskUs{0.0},
+  m_cpuShare{1.0},
+  m_windowWallNs{0},
+  m_windowCpuNs{0}
+{
+  const int threads = config.threads > 0 ? config.threads : 2 * m_cores;
+
+  m_pool = new QThreadPool{};
+  m_pool->setMaxThreadCount(std::min(std::max(threads, m_minThreads), m_maxThreads));
+
+  m_sinceAdapt.start();
+}
+
+WorkerPool::~WorkerPool()
+{
+  m_pool->waitForDone();
+  delete m_pool;
+}
+
+/*
+ * Keeping all cores busy takes cores / share of time spent on CPU threads.
+ * The pool grows only while requests wait for a thread and it moves halfway
+ * towards the target each time so that a single unusual interval does not
+ * swing it.
+ */
+void WorkerPool::adapt()
+{
+  m_cpuShare = std::clamp(static_cast<double>(m_windowCpuNs) / m_windowWallNs, MIN_CPU_SHARE, 1.0);
+  m_windowWallNs = 0;
+  m_windowCpuNs = 0;
+  m_sinceAdapt.restart();
+
+  const int current = m_pool->maxThreadCount();
+  int target = std::clamp(static_cast<int>(std::ceil(m_cores / m_cpuShare)), m_minThreads, m_maxThreads);
+
+  if (target > current && m_queued == 0)
+    return;
+
+  if (target != current) {
+    const int step = (target - current) / 2;
+    target = current + (step != 0 ? step : (target > current ? 1 : -1));
+    m_pool->setMaxThreadCount(target);
+  }
+}
+
+/* Estimate of milliseconds after which the requests that wait now have got a thread */
+int WorkerPool::retryAfter() const
+{
+  QMutexLocker locker{&m_lock};
+
+  const double threads = std::max(1, m_pool->maxThreadCount());
+  const double ms = m_meanTaskUs * (m_queued / threads + 1.0) / 1000.0;
+
+  return std::clamp(static_cast<int>(std::ceil(ms)), MIN_RETRY_AFTER_MS, MAX_RETRY_AFTER_MS);
+}
+
+void WorkerPool::run(const qint64 clientId, QRunnable *runnable)
+{
+  {
+    QMutexLocker locker{&m_lock};
+    m_queued--;
+  }
+
+  QElapsedTimer wallTimer;
+  wallTimer.start();
+  const qint64 cpuStart = threadCpuTime();
+
+  runnable->run();
+  delete runnable;
+
+  const qint64 cpuEnd = threadCpuTime();
+  const qint64 wallNs = wallTimer.nsecsElapsed();
+
+  QMutexLocker locker{&m_lock};
+
+  auto it = m_clientRequests.find(clientId);
+  if (it != m_clientRequests.end() && --it.value() <= 0)
+    m_clientRequests.erase(it);
+
+  m_meanTaskUs += (wallNs / 1000.0 - m_meanTaskUs) * TASK_TIME_WEIGHT;
+
+  if (cpuStart >= 0 && cpuEnd >= 0) {
+    m_windowWallNs += wallNs;
+    m_windowCpuNs += cpuEnd - cpuStart;
+  }
+
+  if (m_adaptive && m_windowWallNs > 0 && m_sinceAdapt.elapsed() >= ADAPT_INTERVAL_MS)
+    adapt();
+}
+
+QJsonObject WorkerPool::statsJson() const
+{
+  QMutexLocker locker{&m_lock};
+
+  QJsonObject stats{
+    { "threadsActive", m_pool->activeThreadCount() },
+    { "threadsMax", m_pool->maxThreadCount() },
+    { "queued", m_queued },
+    { "queueLimit", m_queueLimit },
+    { "perClientLimit", m_perClientLimit },
+    { "refused", static_cast<qint64>(m_refused) },
+    { "meanRequestUs", static_cast<qint64>(m_meanTaskUs) }
+  };
+
+  if (m_adaptive)
+    stats.insert("cpuShare", m_cpuShare);
+
+  return stats;
+}
+
+/* Takes ownership of the runnable, returns false and deletes it if the request is refused */
+bool WorkerPool::tryStart(const qint64 clientId, QRunnable *runnable)
+{
+  {
+    QMutexLocker locker{&m_lock};
+
+    const int clientRequests = m_clientRequests.value(clientId, 0);
+    if ((m_queueLimit > 0 && m_queued >= m_queueLimit) ||
+        (m_perClientLimit > 0 && clientRequests >= m_perClientLimit)) {
+      m_refused++;
+      delete runnable;
+      return false;
+    }
+
+    m_clientRequests.insert(clientId, clientRequests + 1);
+    m_queued++;
+  }
+
+  m_pool->start([this, clientId, runnable]() { run(clientId, runnable); });
+  return true;
+}
+
+void WorkerPool::waitForDone()
+{
+  m_pool->waitForDone();
+}
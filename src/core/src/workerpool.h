@@ -0,0 +1,58 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "serviceconfig.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+
+class QRunnable;
+class QThreadPool;
+
+/*
+ * Runs requests of local socket clients on a pool of threads. The number of
+ * requests that wait for a thread and the number of requests of a single
+ * client that are waiting or being handled are limited. A request over
+ * either limit is refused and the client is told when to try again.
+ *
+ * With adaptive sizing the pool is resized so that the workers keep the
+ * cores busy. Workers that spend most of their time waiting for the disk,
+ * for a decoding slot or for a slow client leave room for more threads,
+ * CPU bound workers need no more threads than there are cores.
+ */
+class WorkerPool {
+public:
+  explicit WorkerPool(const ServiceConfig::WorkerPool &config, const int minThreads);
+  ~WorkerPool();
+  int retryAfter() const;
+  QJsonObject statsJson() const;
+  bool tryStart(const qint64 clientId, QRunnable *runnable);
+  void waitForDone();
+
+private:
+  void adapt();
+  void run(const qint64 clientId, QRunnable *runnable);
+
+  const int m_cores;
+  const int m_minThreads;
+  const int m_maxThreads;
+  const bool m_adaptive;
+  const int m_queueLimit;
+  const int m_perClientLimit;
+
+  QThreadPool *m_pool;
+
+  mutable QMutex m_lock;
+  QHash<qint64, int> m_clientRequests;  /* Requests of each client that are queued or handled */
+  int m_queued;                         /* Requests that wait for a thread */
+  quint64 m_refused;
+  double m_meanTaskUs;                  /* Moving average of the time a request occupies a thread */
+  double m_cpuShare;                    /* Share of time the workers spent on CPU when the pool was last resized */
+  qint64 m_windowWallNs;                /* Time measured since the pool was last resized */
+  qint64 m_windowCpuNs;
+  QElapsedTimer m_sinceAdapt;
+};
+
+#endif // WORKERPOOL_H
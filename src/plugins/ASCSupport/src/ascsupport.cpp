@@ -5,6 +5,7 @@
 #include "ui/pickdecimalpointdialog.h"
 
 #include <plugins/pluginhelpers_p.h>
+#include <plugins/stagetimer.h>
 #include <plugins/threadeddialog.h>
 #include <QFileDialog>
 #include <QString>
@@ -851,18 +852,25 @@ std::vector<Data> ASCSupport::loadInternal(const std::string &path, AvailableCha
 
   std::list<std::string> lines{};
   std::istringstream inStream{};
+  const char *tag = s_identifier.tag.c_str();
 
   try {
+    StageTimer timer{m_uiPlugin, tag, LoadStage::FILE_IO};
+
     inStream = readFile(path, encoding);
   } catch (const ASCFormatException &ex) {
     reportError(m_uiPlugin, QString{"Cannot read file %1\n%2"}.arg(path.c_str(), ex.what()));
     return data;
   }
 
-  while (inStream.good()) {
-    std::string line = readLine(inStream);
-    if (line.length() > 0)
-      lines.emplace_back(std::move(line));
+  {
+    StageTimer timer{m_uiPlugin, tag, LoadStage::TEXT_DECODING};
+
+    while (inStream.good()) {
+      std::string line = readLine(inStream);
+      if (line.length() > 0)
+        lines.emplace_back(std::move(line));
+    }
   }
 
   if (!inStream.eof()) {
@@ -901,6 +909,7 @@ std::vector<Data> ASCSupport::loadInternal(const std::string &path, AvailableCha
       }
     }
 
+    StageTimer timer{m_uiPlugin, tag, LoadStage::PARSING};
     parseTraces(m_uiPlugin, data, ctx, traces, selChans);
   } catch (ASCFormatException &ex) {
     reportError(m_uiPlugin, QString{"Cannot read file %1\n%2"}.arg(path.c_str(), ex.what()));
@@ -6,11 +6,13 @@
 #include <QApplication>
 #include <QByteArray>
 #include <QClipboard>
+#include <QFile>
 #include <QFileInfo>
 #include <QLocale>
 #include <QMessageBox>
 #include <QtGlobal>
 #include <QStringConverter>
+#include <plugins/stagetimer.h>
 #include <plugins/threadeddialog.h>
 
 #include <cstring>
@@ -32,6 +34,10 @@
 #endif
 
 #define MAX_LINE_BYTES 4096
+#define TAIL_HEAD_BYTES 64
+
+/* Must match the tag in CSVSupport's identifier */
+static const char STATS_TAG[] = "CSV";
 
 class InvalidCodePointError : public std::runtime_error {
 public:
@@ -340,6 +346,52 @@ QStringList streamToLines(std::istream &stream, const CsvFileLoader::Encoding &e
   return lines;
 }
 
+static
+int codeUnitSize(const CsvFileLoader::EncodingType type)
+{
+  switch (type) {
+  case CsvFileLoader::EncodingType::UTF16LE:
+  case CsvFileLoader::EncodingType::UTF16BE:
+    return 2;
+  case CsvFileLoader::EncodingType::UTF32LE:
+  case CsvFileLoader::EncodingType::UTF32BE:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+/* Returns the length of the leading part of the block that ends with a line terminator */
+static
+qint64 completeLinesLength(const QByteArray &block, const CsvFileLoader::Encoding &encoding)
+{
+  const int unit = codeUnitSize(encoding.type);
+  const bool bigEndian = encoding.type == CsvFileLoader::EncodingType::UTF16BE ||
+                         encoding.type == CsvFileLoader::EncodingType::UTF32BE;
+  const int charIdx = bigEndian ? unit - 1 : 0;
+
+  for (qint64 pos = block.size() - (block.size() % unit) - unit; pos >= 0; pos -= unit) {
+    const char *codeUnit = block.constData() + pos;
+
+    if (codeUnit[charIdx] != LF<false, char>::value && codeUnit[charIdx] != CR<false, char>::value)
+      continue;
+
+    /* CR and LF are the only byte of the code unit that is not zero */
+    bool isTerminator = true;
+    for (int idx = 0; idx < unit; idx++) {
+      if (idx != charIdx && codeUnit[idx] != 0) {
+        isTerminator = false;
+        break;
+      }
+    }
+
+    if (isTerminator)
+      return pos + unit;
+  }
+
+  return 0;
+}
+
 const QMap<QString, CsvFileLoader::Encoding> CsvFileLoader::SUPPORTED_ENCODINGS = { { "ISO-8859-1", CsvFileLoader::Encoding("ISO-8859-1", QByteArray(), "ISO-8859-1 (Latin 1)", CsvFileLoader::EncodingType::SingleByte) },
                                                                                     { "ISO-8859-2", CsvFileLoader::Encoding("ISO-8859-2", QByteArray(), "ISO-8859-2 (Latin 2)", CsvFileLoader::EncodingType::SingleByte) },
                                                                                     { "windows-1250", CsvFileLoader::Encoding("windows-1250", QByteArray(), "Windows-1250 (cp1250)", CsvFileLoader::EncodingType::SingleByte) },
@@ -442,6 +494,14 @@ CsvFileLoader::Parameters & CsvFileLoader::Parameters::operator=(const Parameter
   return *this;
 }
 
+CsvFileLoader::TailState::TailState() :
+  offset(0),
+  linesRead(0),
+  columns(0),
+  headerRead(false)
+{
+}
+
   static
 double readValue(const QString &s)
 {
@@ -634,6 +694,143 @@ CsvFileLoader::DataPack CsvFileLoader::readFile(UIPlugin *uiPlugin, const QStrin
 
 }
 
+/*
+ * Parses lines that were appended to a file since the position stored in the state.
+ * Trailing incomplete line is left for the next call. Returned pack contains only
+ * the new values and the state is updated to point past them.
+ */
+CsvFileLoader::DataPack CsvFileLoader::readFileTail(UIPlugin *uiPlugin, const QString &path, TailState &state)
+{
+  std::ifstream stream{};
+  try  {
+    stream = tryOpenStream(path);
+  } catch (const std::runtime_error &ex) {
+    ThreadedDialog<QMessageBox>::displayWarning(uiPlugin, QObject::tr("Cannot open file"), ex.what());
+    return{};
+  }
+
+  if (!stream.is_open()) {
+    ThreadedDialog<QMessageBox>::displayWarning(uiPlugin, QObject::tr("Cannot open file"), QString(QObject::tr("Cannot open the specified file for reading")));
+    return {};
+  }
+
+  const Parameters &params = state.params;
+  assert(SUPPORTED_ENCODINGS.contains(params.encodingId));
+  const auto &encoding = SUPPORTED_ENCODINGS[params.encodingId];
+
+  QByteArray block;
+  {
+    plugin::StageTimer timer{uiPlugin, STATS_TAG, plugin::LoadStage::FILE_IO};
+
+    if (state.offset == 0) {
+      state.head.resize(TAIL_HEAD_BYTES);
+      stream.read(state.head.data(), TAIL_HEAD_BYTES);
+      state.head.resize(stream.gcount());
+      stream.clear();
+      stream.seekg(0, stream.beg);
+
+      skipBom(stream, encoding);
+      state.offset = stream.tellg();
+    }
+
+    stream.seekg(0, stream.end);
+    const qint64 end = stream.tellg();
+    stream.seekg(state.offset, stream.beg);
+
+    if (end > state.offset) {
+      block.resize(end - state.offset);
+      stream.read(block.data(), block.size());
+      block.resize(stream.gcount());
+    }
+    block.truncate(completeLinesLength(block, encoding));
+  }
+
+  QStringList lines;
+  try {
+    plugin::StageTimer timer{uiPlugin, STATS_TAG, plugin::LoadStage::TEXT_DECODING};
+    std::istringstream blockStream{block.toStdString()};
+
+    lines = streamToLines(blockStream, encoding);
+  } catch (const std::runtime_error &ex) {
+    ThreadedDialog<QMessageBox>::displayWarning(uiPlugin, QObject::tr("Cannot read input"), ex.what());
+    return {};
+  }
+
+  plugin::StageTimer parsingTimer{uiPlugin, STATS_TAG, plugin::LoadStage::PARSING};
+
+  const QString fileName = QFileInfo(path).fileName();
+  const int highColumn = (params.yColumn > params.xColumn) ? params.yColumn : params.xColumn;
+  int linesRead = 0;
+  int emptyLines = 0;
+
+  if (!state.headerRead) {
+    /* Remove leading blank lines */
+    while (!lines.empty()) {
+      if (lines.constFirst().trimmed().isEmpty()) {
+        lines.pop_front();
+        emptyLines++;
+      } else
+        break;
+    }
+
+    /* Wait until the skipped lines and the line with the header have been written */
+    if (lines.size() < params.linesToSkip + 1)
+      return DataPack({}, {}, QString{}, {});
+
+    linesRead = params.linesToSkip;
+
+    try {
+      if (params.multipleYcols) {
+        auto header = readHeaderMulti(lines, params.delimiter, params.hasHeader, linesRead);
+        state.columns = std::get<0>(header);
+        state.xType = std::get<1>(header);
+        state.yTypes = std::get<2>(header);
+      } else {
+        auto header = readHeaderSingle(lines, params.delimiter, params.xColumn, params.yColumn, params.hasHeader, highColumn, linesRead);
+        state.xType = std::get<0>(header);
+        state.yTypes = { std::get<1>(header) };
+      }
+    } catch (const InvalidHeaderError &ex) {
+      showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::POSSIBLY_INCORRECT_SETTINGS, linesRead, fileName, ex.line);
+
+      return {};
+    }
+  } else {
+    /* A CR LF pair may have been split between two reads */
+    for (auto it = lines.begin(); it != lines.end();) {
+      if (it->trimmed().isEmpty()) {
+        it = lines.erase(it);
+        emptyLines++;
+      } else
+        ++it;
+    }
+  }
+
+  const size_t dataLines = lines.size() - linesRead;
+  const int parsedLines = lines.size() + emptyLines;
+  ValueVec xValues;
+  ValueVecVec yValuesVec;
+
+  if (params.multipleYcols) {
+    yValuesVec = readStreamMulti(uiPlugin, std::move(lines), params.delimiter, params.decimalSeparator, state.columns,
+                                 state.linesRead + emptyLines, linesRead, fileName, xValues);
+  } else {
+    yValuesVec = readStreamSingle(uiPlugin, std::move(lines), params.delimiter, params.decimalSeparator,
+                                  params.xColumn, params.yColumn, highColumn,
+                                  state.linesRead + emptyLines, linesRead, fileName, xValues);
+  }
+
+  /* Malformed line has been reported already */
+  if (xValues.size() != dataLines)
+    return {};
+
+  state.offset += block.size();
+  state.linesRead += parsedLines;
+  state.headerRead = true;
+
+  return DataPack(std::move(xValues), std::move(yValuesVec), QString{state.xType}, std::vector<QString>{state.yTypes});
+}
+
 CsvFileLoader::DataPack CsvFileLoader::readStream(UIPlugin *uiPlugin,
                                                   std::istream &stream, const Encoding &encoding,
                                                   const QChar &delimiter, const QChar &decimalSeparator,
@@ -642,7 +839,8 @@ CsvFileLoader::DataPack CsvFileLoader::readStream(UIPlugin *uiPlugin,
                                                   const bool hasHeader, const int linesToSkip,
                                                   const QString &fileName)
 {
-  PointVecVec ptsVecVec;
+  ValueVec xValues;
+  ValueVecVec yValuesVec;
   QString xType;
   std::vector<QString> yTypes;
   QStringList lines;
@@ -651,12 +849,16 @@ CsvFileLoader::DataPack CsvFileLoader::readStream(UIPlugin *uiPlugin,
   int emptyLines = 0;
 
   try {
+    plugin::StageTimer timer{uiPlugin, STATS_TAG, plugin::LoadStage::TEXT_DECODING};
+
     lines = streamToLines(stream, encoding);
   } catch (const std::runtime_error &ex) {
     ThreadedDialog<QMessageBox>::displayWarning(uiPlugin, QObject::tr("Cannot read input"), ex.what());
     return {};
   }
 
+  plugin::StageTimer parsingTimer{uiPlugin, STATS_TAG, plugin::LoadStage::PARSING};
+
   /* Remove leading blank lines */
   while (!lines.empty()) {
     if (lines.constFirst().trimmed().isEmpty()) {
@@ -685,7 +887,7 @@ CsvFileLoader::DataPack CsvFileLoader::readStream(UIPlugin *uiPlugin,
       xType = std::get<1>(header);
       yTypes = std::get<2>(header);
 
-      ptsVecVec = readStreamMulti(uiPlugin, std::move(lines), delimiter, decimalSeparator, columns, emptyLines, linesRead, fileName);
+      yValuesVec = readStreamMulti(uiPlugin, std::move(lines), delimiter, decimalSeparator, columns, emptyLines, linesRead, fileName, xValues);
     } catch (const InvalidHeaderError &ex) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::POSSIBLY_INCORRECT_SETTINGS, linesRead, fileName, ex.line);
 
@@ -702,11 +904,23 @@ CsvFileLoader::DataPack CsvFileLoader::readStream(UIPlugin *uiPlugin,
       return {};
     }
 
-    ptsVecVec = readStreamSingle(uiPlugin, std::move(lines), delimiter, decimalSeparator,
-                                 xColumn, yColumn, highColumn, emptyLines, linesRead, fileName);
+    yValuesVec = readStreamSingle(uiPlugin, std::move(lines), delimiter, decimalSeparator,
+                                  xColumn, yColumn, highColumn, emptyLines, linesRead, fileName, xValues);
   }
 
-  return DataPack(std::move(ptsVecVec), std::move(xType), std::move(yTypes));
+  return DataPack(std::move(xValues), std::move(yValuesVec), std::move(xType), std::move(yTypes));
+}
+
+bool CsvFileLoader::tailResumable(const QString &path, const TailState &state)
+{
+  QFile file{path};
+
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  if (file.size() < state.offset)
+    return false;
+
+  return file.read(state.head.size()) == state.head;
 }
 
 std::tuple<int, QString, std::vector<QString>> CsvFileLoader::readHeaderMulti(const QStringList &lines, const QChar &delimiter,
@@ -758,19 +972,24 @@ std::tuple<QString, QString> CsvFileLoader::readHeaderSingle(const QStringList &
   }
 }
 
-CsvFileLoader::PointVecVec CsvFileLoader::readStreamMulti(UIPlugin *uiPlugin,
+CsvFileLoader::ValueVecVec CsvFileLoader::readStreamMulti(UIPlugin *uiPlugin,
                                                           QStringList &&lines, const QChar &delimiter, const QChar &decimalSeparator,
-                                                          const int columns, const int emptyLines, int linesRead, const QString &fileName)
+                                                          const int columns, const int emptyLines, int linesRead, const QString &fileName,
+                                                          ValueVec &xValues)
 {
   assert(columns > 1);
 
-  PointVecVec ptsVecVec;
+  ValueVecVec yValuesVec;
 
   std::vector<double> yVals;
 
-  ptsVecVec.resize(columns - 1);
+  yValuesVec.resize(columns - 1);
   yVals.resize(columns - 1);
 
+  xValues.reserve(lines.size() - linesRead);
+  for (auto &yValues : yValuesVec)
+    yValues.reserve(lines.size() - linesRead);
+
   for (int idx = linesRead; idx < lines.size(); idx++) {
     QStringList values;
     double x;
@@ -779,7 +998,7 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamMulti(UIPlugin *uiPlugin,
     values = line.split(delimiter);
     if (values.size() != columns) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_DELIMITER, linesRead + emptyLines + 1, fileName, line);
-      return ptsVecVec;
+      return yValuesVec;
     }
 
     for (auto &v : values) {
@@ -788,7 +1007,7 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamMulti(UIPlugin *uiPlugin,
       } catch (const InvalidSeparatorError &) {
         showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_DELIMITER, linesRead + emptyLines + 1, fileName, line);
 
-	return ptsVecVec;
+	return yValuesVec;
       }
     }
 
@@ -800,24 +1019,29 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamMulti(UIPlugin *uiPlugin,
     } catch (const NonnumericValueError &) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_VALUE_DATA, linesRead + emptyLines + 1, fileName, line);
 
-      return ptsVecVec;
+      return yValuesVec;
     }
 
+    xValues.emplace_back(x);
     for (int jdx = 0; jdx < columns - 1; jdx++)
-      ptsVecVec.at(jdx).emplace_back(std::make_tuple(x, yVals.at(jdx)));
+      yValuesVec.at(jdx).emplace_back(yVals.at(jdx));
 
     linesRead++;
   }
 
-  return ptsVecVec;
+  return yValuesVec;
 }
 
-CsvFileLoader::PointVecVec CsvFileLoader::readStreamSingle(UIPlugin *uiPlugin,
+CsvFileLoader::ValueVecVec CsvFileLoader::readStreamSingle(UIPlugin *uiPlugin,
                                                            QStringList &&lines, const QChar &delimiter, const QChar &decimalSeparator,
                                                            const int xColumn, const int yColumn, const int highColumn,
-                                                           const int emptyLines, int linesRead, const QString &fileName)
+                                                           const int emptyLines, int linesRead, const QString &fileName,
+                                                           ValueVec &xValues)
 {
-  PointVec points;
+  ValueVec yValues;
+
+  xValues.reserve(lines.size() - linesRead);
+  yValues.reserve(lines.size() - linesRead);
 
   for (int idx = linesRead; idx < lines.size(); idx++) {
     QStringList values;
@@ -827,7 +1051,7 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamSingle(UIPlugin *uiPlugin,
     values = line.split(delimiter);
     if (values.size() < highColumn) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_DELIMITER, linesRead + emptyLines + 1, fileName, line);
-      return { points };
+      return { yValues };
     }
 
     QString &sx = values[xColumn - 1];
@@ -838,7 +1062,7 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamSingle(UIPlugin *uiPlugin,
       sanitizeDecSep(sy, decimalSeparator);
     } catch (const InvalidSeparatorError &) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_DELIMITER, linesRead + emptyLines + 1, fileName, line);
-      return { points };
+      return { yValues };
     }
 
     try {
@@ -846,14 +1070,15 @@ CsvFileLoader::PointVecVec CsvFileLoader::readStreamSingle(UIPlugin *uiPlugin,
       y = readValue(sy);
     } catch (const NonnumericValueError &) {
       showMalformedFileError(uiPlugin, MalformedCsvFileDialog::Error::BAD_VALUE_DATA, linesRead + emptyLines + 1, fileName, line);
-      return { points };
+      return { yValues };
     }
 
-    points.emplace_back(std::make_tuple(x, y));
+    xValues.emplace_back(x);
+    yValues.emplace_back(y);
     linesRead++;
   }
 
-  return { points };
+  return { yValues };
 }
 
 } // namespace backend
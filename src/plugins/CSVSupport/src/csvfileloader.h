@@ -5,6 +5,8 @@
 #include <QMap>
 #include <QVector>
 #include <cassert>
+#include <memory>
+#include <vector>
 
 class QTextStream;
 class UIPlugin;
@@ -47,31 +49,36 @@ public:
     {}
 
     DataPack(const DataPack &other) :
-      dataVec(other.dataVec),
+      xValues(other.xValues),
+      yValuesVec(other.yValuesVec),
       xType(other.xType),
       yTypes(other.yTypes),
       valid(other.valid)
     {}
 
     DataPack(DataPack &&other) noexcept :
-      dataVec(std::move(other.dataVec)),
+      xValues(std::move(other.xValues)),
+      yValuesVec(std::move(other.yValuesVec)),
       xType(other.xType),
       yTypes(std::move(other.yTypes)),
       valid(other.valid)
     {}
 
-    DataPack(std::vector<std::vector<std::tuple<double, double>>> &&dataVec, QString &&xType, std::vector<QString> &&yTypes) noexcept :
-      dataVec(std::move(dataVec)),
-      xType(std::move(xType)),
-      yTypes(std::move(yTypes)),
+    DataPack(std::vector<double> &&_xValues, std::vector<std::vector<double>> &&_yValuesVec, QString &&_xType, std::vector<QString> &&_yTypes) :
+      xValues(std::make_shared<const std::vector<double>>(std::move(_xValues))),
+      yValuesVec(std::move(_yValuesVec)),
+      xType(std::move(_xType)),
+      yTypes(std::move(_yTypes)),
       valid(true)
     {
-      assert(dataVec.size() == yTypes.size());
+      for (const auto &yValues : yValuesVec)
+        assert(yValues.size() == xValues->size());
     }
 
     DataPack & operator=(const DataPack &other)
     {
-      dataVec = other.dataVec;
+      xValues = other.xValues;
+      yValuesVec = other.yValuesVec;
       const_cast<QString&>(xType) = other.xType;
       const_cast<std::vector<QString>&>(yTypes) = other.yTypes;
       const_cast<bool&>(valid) = other.valid;
@@ -81,7 +88,8 @@ public:
 
     DataPack & operator=(DataPack &&other) noexcept
     {
-      dataVec = std::move(other.dataVec);
+      xValues = std::move(other.xValues);
+      yValuesVec = std::move(other.yValuesVec);
       const_cast<QString&>(xType) = std::move(other.xType);
       const_cast<std::vector<QString>&>(yTypes) = std::move(other.yTypes);
       const_cast<bool&>(valid) = other.valid;
@@ -89,7 +97,8 @@ public:
       return *this;
     }
 
-    std::vector<std::vector<std::tuple<double, double>>> dataVec;
+    std::shared_ptr<const std::vector<double>> xValues; /* Common X values of all loaded columns */
+    std::vector<std::vector<double>> yValuesVec;
     const QString xType;
     const std::vector<QString> yTypes;
     const bool valid;
@@ -117,18 +126,35 @@ public:
     const bool isValid;
   };
 
+  /* Describes how far a file that is still being written has been read */
+  class TailState {
+  public:
+    TailState();
+
+    Parameters params;
+    QByteArray head;              /* First bytes of the file, tell whether the file was replaced */
+    qint64 offset;                /* Offset of the first byte that has not been parsed yet */
+    int linesRead;                /* Lines parsed so far including blank, skipped and header lines */
+    int columns;                  /* Number of columns when multiple Y columns are read */
+    bool headerRead;
+    QString xType;
+    std::vector<QString> yTypes;
+  };
+
   CsvFileLoader() = delete;
 
   static std::pair<QString, QString> previewClipboard(const QString &encodingId, const int maxLines);
   static std::pair<QString, QString> previewFile(const QString &path, const QString &encodingId, const int maxLines);
   static DataPack readClipboard(UIPlugin *uiPlugin, const Parameters &params);
   static DataPack readFile(UIPlugin *uiPlugin, const QString &path, const Parameters &params);
+  static DataPack readFileTail(UIPlugin *uiPlugin, const QString &path, TailState &state);
+  static bool tailResumable(const QString &path, const TailState &state);
 
   static const QMap<QString, Encoding> SUPPORTED_ENCODINGS;
 
 private:
-  typedef std::vector<std::tuple<double, double>> PointVec;
-  typedef std::vector<PointVec> PointVecVec;
+  typedef std::vector<double> ValueVec;
+  typedef std::vector<ValueVec> ValueVecVec;
 
   static std::tuple<int, QString, std::vector<QString>> readHeaderMulti(const QStringList &lines, const QChar &delimiter,
                                                                         const bool hasHeader, int &linesRead);
@@ -145,16 +171,16 @@ private:
                              const bool hasHeader, const int linesToSkip,
                              const QString &fileName);
 
-  static PointVecVec readStreamMulti(UIPlugin *uiPlugin,
+  static ValueVecVec readStreamMulti(UIPlugin *uiPlugin,
                                      QStringList &&lines, const QChar &delimiter, const QChar &decimalSeparator,
                                      const int columns, const int emptyLines, int linesRead,
-                                     const QString &fileName);
+                                     const QString &fileName, ValueVec &xValues);
 
-  static PointVecVec readStreamSingle(UIPlugin *uiPlugin,
+  static ValueVecVec readStreamSingle(UIPlugin *uiPlugin,
                                       QStringList &&lines, const QChar &delimiter, const QChar &decimalSeparator,
                                       const int xColumn, const int yColumn, const int highColumn,
                                       const int emptyLines, int linesRead,
-                                      const QString &fileName);
+                                      const QString &fileName, ValueVec &xValues);
 };
 
 } // namespace plugin
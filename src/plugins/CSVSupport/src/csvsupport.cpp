@@ -59,13 +59,26 @@ private:
   const QString m_source;
 };
 
+class CsvTailCheckpoint : public TailCheckpoint
+{
+public:
+  CsvTailCheckpoint(const CsvFileLoader::TailState &state, const LoadCsvFileDialog::Parameters &dialogParams) :
+    state{state},
+    dialogParams{dialogParams}
+  {
+  }
+
+  const CsvFileLoader::TailState state;
+  const LoadCsvFileDialog::Parameters dialogParams;   /* Descriptions and units of the loaded columns */
+};
+
 CSVSupport *CSVSupport::s_me{nullptr};
 const Identifier CSVSupport::s_identifier{"Comma separated file format support", "CSV", "CSV", {"file", "clipboard"}};
 
 static
 void appendCsvData(std::vector<Data> &data, CsvFileLoader::DataPack &csvData, const QString &file, const LoadCsvFileDialog::Parameters &p)
 {
-  const size_t N = csvData.dataVec.size();
+  const size_t N = csvData.yValuesVec.size();
   const std::string path = file.toStdString();
   std::string xType;
   std::vector<std::string> yTypes;
@@ -124,7 +137,8 @@ void appendCsvData(std::vector<Data> &data, CsvFileLoader::DataPack &csvData, co
            yTypes.at(idx),
            xUnit,
            yUnit,
-           std::move(csvData.dataVec[idx])
+           csvData.xValues,
+           std::move(csvData.yValuesVec[idx])
           };
 
     data.emplace_back(std::move(d));
@@ -289,6 +303,60 @@ std::vector<Data> CSVSupport::loadPath(const std::string &path, const int option
   }
 }
 
+/*
+ * The first call asks for loading parameters just like loadPath() does.
+ * Following calls reuse them and parse only the lines appended since the last call.
+ */
+std::vector<Data> CSVSupport::loadPathTail(const std::string &path, const int option,
+                                           std::shared_ptr<const TailCheckpoint> &checkpoint, bool &restarted)
+{
+  const QString qPath = QString::fromUtf8(path.c_str());
+  const auto previous = std::dynamic_pointer_cast<const CsvTailCheckpoint>(checkpoint);
+  CsvFileLoader::TailState state;
+  LoadCsvFileDialog::Parameters dialogParams;
+
+  checkpoint = nullptr;
+  restarted = false;
+
+  if (option != 0)
+    return std::vector<Data>{};
+
+  if (previous != nullptr) {
+    dialogParams = previous->dialogParams;
+
+    if (CsvFileLoader::tailResumable(qPath, previous->state)) {
+      state = previous->state;
+    } else {
+      /* File was truncated or replaced, read the new content with the same parameters */
+      state.params = previous->state.params;
+      restarted = true;
+    }
+  } else {
+    state.params = makeCsvLoaderParameters(qPath, m_uiPlugin, m_paramsDlg);
+    if (!state.params.isValid)
+      return std::vector<Data>{};
+
+    dialogParams = m_paramsDlg->dialog()->parameters();
+  }
+
+  CsvFileLoader::DataPack csvData = CsvFileLoader::readFileTail(m_uiPlugin, qPath, state);
+  if (!csvData.valid)
+    return std::vector<Data>{};
+
+  checkpoint = std::make_shared<const CsvTailCheckpoint>(state, dialogParams);
+
+  std::vector<Data> retData;
+  if (!csvData.xValues->empty())
+    appendCsvData(retData, csvData, qPath, dialogParams);
+
+  return retData;
+}
+
+bool CSVSupport::tailLoadSupported() const
+{
+  return true;
+}
+
 EDIIPlugin * initialize(UIPlugin *plugin)
 {
   return CSVSupport::instance(plugin);
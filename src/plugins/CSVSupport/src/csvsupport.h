@@ -15,6 +15,9 @@ public:
   virtual std::vector<Data> load(const int option) override;
   virtual std::vector<Data> loadHint(const std::string &hintPath, const int option) override;
   virtual std::vector<Data> loadPath(const std::string &path, const int option) override;
+  virtual bool tailLoadSupported() const override;
+  virtual std::vector<Data> loadPathTail(const std::string &path, const int option,
+                                         std::shared_ptr<const TailCheckpoint> &checkpoint, bool &restarted) override;
 
   static CSVSupport *instance(UIPlugin *plugin);
 
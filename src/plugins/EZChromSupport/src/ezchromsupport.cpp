@@ -4,6 +4,7 @@
 #include "ui/selectchannelsdialog.h"
 #include <ezfish.h>
 
+#include <plugins/stagetimer.h>
 #include <plugins/threadeddialog.h>
 
 #include <QDir>
@@ -203,10 +204,16 @@ std::vector<Data> EZChromSupport::loadSingleFile(const QString &path, std::set<s
     if (fileName.isEmpty())
         throw std::runtime_error{"Cannot determine file name"};
 
+    const char *tag = s_identifier.tag.c_str();
+
+    StageTimer ioTimer{m_uiPlugin, tag, LoadStage::FILE_IO};
     const auto bytes = readFile(path);
+    ioTimer.stop();
 
     auto ezfTraces = ezf_empty_traces();
+    StageTimer parsingTimer{m_uiPlugin, tag, LoadStage::PARSING};
     auto tRet = ezf_read(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(), &ezfTraces);
+    parsingTimer.stop();
     if (tRet != EzfResult::Success)
         throw std::runtime_error{ezf_error_to_string(tRet)};
 
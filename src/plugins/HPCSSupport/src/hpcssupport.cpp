@@ -1,10 +1,12 @@
 #include "hpcssupport.h"
 #include "loadchemstationdatadialog.h"
 
+#include <QDateTime>
 #include <QFile>
 #include <QFileSystemModel>
 #include <QMessageBox>
 #include <plugins/pluginhelpers_p.h>
+#include <plugins/stagetimer.h>
 #include <plugins/threadeddialog.h>
 
 namespace plugin {
@@ -222,9 +224,27 @@ std::vector<Data> HPCSSupport::loadPath(const std::string &path, const int optio
   return {loadChemStationFileSingle(QString::fromStdString(path))};
 }
 
+std::vector<Data> HPCSSupport::loadPathUnattended(const std::string &path, const int option)
+{
+  Q_UNUSED(option);
+
+  const QString qPath = QString::fromStdString(path);
+  StageTimer ioTimer{m_uiPlugin, s_identifier.tag.c_str(), LoadStage::FILE_IO};
+  ChemStationFileLoader::Data chData = ChemStationFileLoader::loadFile(m_uiPlugin, qPath, false);
+  ioTimer.stop();
+
+  if (!chData.isValid())
+    return {};
+
+  StageTimer parsingTimer{m_uiPlugin, s_identifier.tag.c_str(), LoadStage::PARSING};
+  return {makeData(qPath, chData)};
+}
+
 Data HPCSSupport::loadChemStationFileSingle(const QString &path)
 {
+  StageTimer ioTimer{m_uiPlugin, s_identifier.tag.c_str(), LoadStage::FILE_IO};
   ChemStationFileLoader::Data chData = ChemStationFileLoader::loadFile(m_uiPlugin, path, true);
+  ioTimer.stop();
 
   if (!chData.isValid())
     return Data{};
@@ -233,6 +253,12 @@ Data HPCSSupport::loadChemStationFileSingle(const QString &path)
   dir.cdUp();
   m_lastChemStationPath = dir.path();
 
+  StageTimer parsingTimer{m_uiPlugin, s_identifier.tag.c_str(), LoadStage::PARSING};
+  return makeData(path, chData);
+}
+
+Data HPCSSupport::makeData(const QString &path, const ChemStationFileLoader::Data &chData)
+{
   std::vector<std::tuple<double, double>> datapoints;
   for (const auto &datapoint : chData.data)
     datapoints.emplace_back(std::make_tuple(datapoint.x(), datapoint.y()));
@@ -255,6 +281,42 @@ Data HPCSSupport::loadChemStationFileSingle(const QString &path)
   return data;
 }
 
+bool HPCSSupport::metadataSupported() const
+{
+  return true;
+}
+
+bool HPCSSupport::readMetadata(const std::string &path, Metadata &metadata)
+{
+  const ChemStationFileLoader::Data chData = ChemStationFileLoader::loadHeader(m_uiPlugin, QString::fromStdString(path), false);
+
+  if (!chData.isValid())
+    return false;
+
+  metadata.emplace_back("description", chData.fileDescription.toStdString());
+  metadata.emplace_back("sample", chData.sampleInfo.toStdString());
+  metadata.emplace_back("operator", chData.operatorName.toStdString());
+  metadata.emplace_back("method", chData.methodName.toStdString());
+  metadata.emplace_back("acquired", QDateTime{chData.date, chData.time}.toString(Qt::ISODate).toStdString());
+  metadata.emplace_back("signal", chemStationTypeToString(chData.type));
+  metadata.emplace_back("units", chData.yUnits.toStdString());
+  metadata.emplace_back("instrument", QString{"ChemStation %1 %2"}.arg(chData.chemstationVersion, chData.chemstationRevision).trimmed().toStdString());
+
+  if (chData.type == ChemStationFileLoader::Type::CE_DAD) {
+    metadata.emplace_back("wavelength", std::to_string(chData.wavelengthMeasured.wavelength));
+    metadata.emplace_back("bandwidth", std::to_string(chData.wavelengthMeasured.interval));
+    metadata.emplace_back("referenceWavelength", std::to_string(chData.wavelengthReference.wavelength));
+    metadata.emplace_back("referenceBandwidth", std::to_string(chData.wavelengthReference.interval));
+  }
+
+  return true;
+}
+
+bool HPCSSupport::unattendedLoadSupported() const
+{
+  return true;
+}
+
 void HPCSSupport::loadChemStationFileMultipleDirectories(std::vector<Data> &dataVec, const QStringList &dirPaths, const ChemStationBatchLoader::Filter &filter)
 {
   QStringList files = ChemStationBatchLoader::getFilesList(m_uiPlugin, dirPaths, filter);
@@ -23,6 +23,10 @@ public:
   virtual std::vector<Data> load(const int option) override;
   virtual std::vector<Data> loadHint(const std::string &hintPath, const int option) override;
   virtual std::vector<Data> loadPath(const std::string &path, const int option) override;
+  virtual bool unattendedLoadSupported() const override;
+  virtual std::vector<Data> loadPathUnattended(const std::string &path, const int option) override;
+  virtual bool metadataSupported() const override;
+  virtual bool readMetadata(const std::string &path, Metadata &metadata) override;
 
   static HPCSSupport * instance(UIPlugin *plugin);
 
@@ -33,6 +37,7 @@ private:
   QString defaultPath() const;
   bool isDirectoryUsable(const QString &path) const;
   Data loadChemStationFileSingle(const QString &path);
+  Data makeData(const QString &path, const ChemStationFileLoader::Data &chData);
   void loadChemStationFileMultipleDirectories(std::vector<Data> &dataVec, const QStringList &dirPaths, const ChemStationBatchLoader::Filter &filter);
   void loadChemStationFileWholeDirectory(std::vector<Data> &dataVec, const QString &path, const ChemStationBatchLoader::Filter &filter);
   std::vector<Data> loadInteractive(LoadChemStationDataThreadedDialog *dlg);
@@ -2,6 +2,7 @@
 
 #include <netcdf.h>
 #include <exception>
+#include <QDateTime>
 #include <QString>
 
 #ifdef WIN32
@@ -22,6 +23,18 @@ static const char *retention_unit_name = "retention_unit";
 static const char *ordinate_values_var = "ordinate_values";
 static const char *point_number_dim = "point_number";
 
+/* Global attributes of the ANDI/AIA chromatography template and the metadata keys they are reported under */
+static const std::pair<const char *, const char *> metadata_attributes[] = {
+  { "experiment_title", "description" },
+  { "sample_name", "sample" },
+  { "sample_id", "sampleId" },
+  { "operator_name", "operator" },
+  { "detection_method_name", "method" },
+  { "injection_date_time_stamp", "acquired" },
+  { "detector_name", "instrument" },
+  { "detector_unit", "units" }
+};
+
 #ifdef WIN32
 static
 std::unique_ptr<char[]> toNativeCodepage(const char *utf8_str)
@@ -71,6 +84,60 @@ std::string attributeToString(const int ncid, const int varid, const char *attrN
   return sStr;
 }
 
+/* Date and time stamps are stored as YYYYMMDDhhmmss followed by the time zone offset */
+static
+std::string timeStampToISO(const std::string &stamp)
+{
+  const QDateTime dt = QDateTime::fromString(QString::fromStdString(stamp).left(14), "yyyyMMddHHmmss");
+
+  if (!dt.isValid())
+    return stamp;
+  return dt.toString(Qt::ISODate).toStdString();
+}
+
+Metadata NetCDFFileLoader::loadMetadata(const QString &path)
+{
+  int ret;
+  int ncid;
+  Metadata metadata{};
+
+#ifdef WIN32
+  auto natPath = toNativeCodepage(path.toUtf8().data());
+  ret = nc_open(natPath.get(), NC_NOWRITE, &ncid);
+#else
+  ret = nc_open(path.toUtf8().data(), NC_NOWRITE, &ncid);
+#endif // WIN32
+  if (ret)
+    throw std::runtime_error{"Cannot open datafile"};
+
+  /* All attributes are optional */
+  for (const auto &attr : metadata_attributes) {
+    nc_type attrType;
+    size_t attrLen;
+
+    ret = nc_inq_att(ncid, NC_GLOBAL, attr.first, &attrType, &attrLen);
+    if (ret || attrType != NC_CHAR)
+      continue;
+
+    std::string value;
+    try {
+      value = attributeToString(ncid, NC_GLOBAL, attr.first, attrLen);
+    } catch (std::runtime_error &) {
+      continue;
+    }
+    if (value.empty())
+      continue;
+
+    if (std::string{attr.second} == "acquired")
+      value = timeStampToISO(value);
+    metadata.emplace_back(attr.second, std::move(value));
+  }
+
+  nc_close(ncid);
+
+  return metadata;
+}
+
 NetCDFFileLoader::Data NetCDFFileLoader::load(const QString &path)
 {
   int ret;
@@ -1,6 +1,7 @@
 #ifndef NETCDFFILELOADER_H
 #define NETCDFFILELOADER_H
 
+#include <plugins/plugininterface.h>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -34,6 +35,7 @@ public:
   NetCDFFileLoader() = delete;
 
   static Data load(const QString &path);
+  static Metadata loadMetadata(const QString &path);
 };
 
 } // namespace plugin
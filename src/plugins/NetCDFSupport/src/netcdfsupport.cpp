@@ -3,6 +3,7 @@
 
 #include <QFileDialog>
 #include <plugins/pluginhelpers_p.h>
+#include <plugins/stagetimer.h>
 #include <plugins/threadeddialog.h>
 
 namespace plugin {
@@ -96,6 +97,37 @@ std::vector<Data> NetCDFSupport::loadPath(const std::string &path, const int opt
   }
 }
 
+std::vector<Data> NetCDFSupport::loadPathUnattended(const std::string &path, const int option)
+{
+  (void)option;
+
+  try {
+    return std::vector<Data>{loadOneFile(QString::fromStdString(path))};
+  } catch (std::runtime_error &) {
+    return std::vector<Data>{};
+  }
+}
+
+bool NetCDFSupport::metadataSupported() const
+{
+  return true;
+}
+
+bool NetCDFSupport::readMetadata(const std::string &path, Metadata &metadata)
+{
+  try {
+    metadata = NetCDFFileLoader::loadMetadata(QString::fromStdString(path));
+    return true;
+  } catch (std::runtime_error &) {
+    return false;
+  }
+}
+
+bool NetCDFSupport::unattendedLoadSupported() const
+{
+  return true;
+}
+
 std::vector<Data> NetCDFSupport::loadInternal(const QString &path)
 {
   OpenFileThreadedDialog dlgWrap{m_uiPlugin, path};
@@ -124,7 +156,10 @@ std::vector<Data> NetCDFSupport::loadInternal(const QString &path)
 
 Data NetCDFSupport::loadOneFile(const QString &filePath)
 {
+  StageTimer ioTimer{m_uiPlugin, s_identifier.tag.c_str(), LoadStage::FILE_IO};
   NetCDFFileLoader::Data data = NetCDFFileLoader::load(filePath);
+  ioTimer.stop();
+
   QString fileName = QFileInfo{filePath}.fileName();
 
   return Data{fileName.toStdString(), "", filePath.toStdString(),
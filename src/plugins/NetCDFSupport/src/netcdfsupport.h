@@ -14,6 +14,10 @@ public:
   virtual std::vector<Data> load(const int option) override;
   virtual std::vector<Data> loadHint(const std::string &hintPath, const int option) override;
   virtual std::vector<Data> loadPath(const std::string &path, const int option) override;
+  virtual bool unattendedLoadSupported() const override;
+  virtual std::vector<Data> loadPathUnattended(const std::string &path, const int option) override;
+  virtual bool metadataSupported() const override;
+  virtual bool readMetadata(const std::string &path, Metadata &metadata) override;
 
   static NetCDFSupport *initialize(UIPlugin *backend);
   static NetCDFSupport *instance();